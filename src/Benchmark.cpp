@@ -0,0 +1,348 @@
+// **************************************************************************************************
+// biLouvain: A C++ library for bipartite graph community detection
+// Paola Gabriela Pesantez-Cabrera, Ananth Kalyanaraman  
+//	(p.pesantezcabrera@wsu.edu, ananth@eecs.wsu.edu)
+// Washington State University
+//
+// For citation, please cite the following paper:
+// Pesantez, Paola and Kalyanaraman, Ananth, "Detecting Communities in Biological 
+// Bipartite Networks," Proc. ACM Conference on Bioinformatics, Computational Biology, 
+// and Health Informatics (ACM-BCB), Seattle, WA, October 2-5, 2016, In press, 
+// DOI: http://dx.doi.org/10.1145/2975167.2975177.
+//
+// **************************************************************************************************
+// Copyright (c) 2016. Washington State University ("WSU"). All Rights Reserved. 
+// Permission to use, copy, modify, and distribute this software and its documentation 
+// for educational, research, and not-for-profit purposes, without fee, is hereby 
+// granted, provided that the above copyright notice, this paragraph and the following 
+// two paragraphs appear in all copies, modifications, and distributions. For 
+// commercial licensing opportunities, please contact The Office of Commercialization, 
+// WSU, 280/286 Lighty, PB Box 641060, Pullman, WA 99164, (509) 335-5526, 
+// commercialization@wsu.edu<mailto:commercialization@wsu.edu>, https://commercialization.wsu.edu/
+
+// IN NO EVENT SHALL WSU BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT, SPECIAL, INCIDENTAL, 
+// OR CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF 
+// THIS SOFTWARE AND ITS DOCUMENTATION, EVEN IF WSU HAS BEEN ADVISED OF THE 
+// POSSIBILITY OF SUCH DAMAGE.
+
+// WSU SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. THE SOFTWARE AND 
+// ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS PROVIDED "AS IS". WSU HAS NO 
+// OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+// **************************************************************************************************
+
+/*
+# Benchmark.cpp
+# Benchmark harness (make bench): generates bipartite graphs with planted co-clusters (SyntheticGraphs.h), runs them
+# through the same steps as the biLouvain executable and reports the time of load, fuse, every phase and output,
+# the peak resident memory, the final modularity and the NMI of the communities against the planted blocks.
+# Every run is done in its own process so the peak memory belongs to it alone.
+*/
+
+#include "Header.h"
+#include "PreProcessInputBipartiteGraph.h"
+#include "Graph.h"
+#include "LoadGraph.h"
+#include "FuseMethod.h"
+#include "biLouvainMethod.h"
+#include "biLouvainMethodMurataPN.h"
+#include "SyntheticGraphs.h"
+#include "Timer.h"
+#include <sys/wait.h>
+
+static std::string models = "all";
+static std::string directory = "bench";
+static std::string resultsFileName = "bench_results.csv";
+static int size = 300;
+static int numberBlocks = 5;
+static double degree = 8.0;
+static double mixing = 0.1;
+static double exponent = 2.5;
+static int numberThreads = 1;
+static int fuse = 1;
+static int optionOrder = 3;
+static int repeat = 1;
+static unsigned long long seed = 1;
+static int flag;
+static void parseCommandLine(const int argc, char * const argv[]);
+
+static struct option longopts[] = {
+   { "model",		required_argument,&flag,1},
+   { "size",		required_argument,&flag,2},
+   { "blocks",		required_argument,&flag,3},
+   { "degree",		required_argument,&flag,4},
+   { "mixing",		required_argument,&flag,5},
+   { "gamma",		required_argument,&flag,6},
+   { "threads",		required_argument,&flag,7},
+   { "fuse",		required_argument,&flag,8},
+   { "order",		required_argument,&flag,9},
+   { "repeat",		required_argument,&flag,10},
+   { "seed",		required_argument,&flag,11},
+   { "dir",		required_argument,&flag,12},
+   { "output",		required_argument,0,'o'},
+   { 0, 0, 0, 0 }
+};
+
+//Normalized mutual information, 2I(X;Y)/(H(X)+H(Y)), between the communities in the results file and the planted blocks.
+//Labels are U<i> (V1) and V<j> (V2); the blocks of V1 and V2 are different classes.
+static double normalizedMutualInformation(const std::string &communitiesFileName,int blocks)
+{
+	std::ifstream infile(communitiesFileName.c_str());
+	if(!infile.is_open())
+		return -1.0;
+	std::map<std::pair<int,int>,long long> joint;
+	std::map<int,long long> predicted,planted;
+	long long n = 0;
+	std::string line;
+	int community = 0;
+	while(std::getline(infile,line))
+	{
+		size_t colon = line.find(": ");
+		if(line.compare(0,10,"Community ") != 0 || colon == std::string::npos)
+			continue;
+		std::stringstream members(line.substr(colon+2));
+		std::string label;
+		while(std::getline(members,label,','))
+		{
+			if(label.size() < 2)
+				continue;
+			int block = SyntheticGraphs::blockOf(atoi(label.c_str()+1),blocks) + ((label[0] == 'V') ? blocks : 0);
+			joint[std::make_pair(community,block)]++;
+			predicted[community]++;
+			planted[block]++;
+			n++;
+		}
+		community++;
+	}
+	if(n == 0)
+		return -1.0;
+	double mutualInformation = 0.0, entropyPredicted = 0.0, entropyPlanted = 0.0;
+	for(std::map<std::pair<int,int>,long long>::iterator it=joint.begin();it!=joint.end();++it)
+	{
+		double pxy = (double)it->second/n;
+		mutualInformation += pxy*log(pxy/(((double)predicted[it->first.first]/n)*((double)planted[it->first.second]/n)));
+	}
+	for(std::map<int,long long>::iterator it=predicted.begin();it!=predicted.end();++it)
+		entropyPredicted -= ((double)it->second/n)*log((double)it->second/n);
+	for(std::map<int,long long>::iterator it=planted.begin();it!=planted.end();++it)
+		entropyPlanted -= ((double)it->second/n)*log((double)it->second/n);
+	if(entropyPredicted + entropyPlanted == 0.0)
+		return 1.0;
+	return 2.0*mutualInformation/(entropyPredicted + entropyPlanted);
+}
+
+static double finalModularity(const std::string &modularityFileName)
+{
+	std::ifstream infile(modularityFileName.c_str());
+	std::string line;
+	const std::string key = "Final Murata+ Modularity: ";
+	double modularity = 0.0;
+	while(std::getline(infile,line))
+	{
+		size_t position = line.find(key);
+		if(position != std::string::npos)
+			modularity = atof(line.c_str()+position+key.size());
+	}
+	return modularity;
+}
+
+//One run, done in a child process. Returns the CSV line of the results, empty if it failed
+static std::string runBenchmark(const std::string &model,unsigned long long runSeed)
+{
+	RandomGenerator random(runSeed);
+	syntheticGraph synthetic;
+	if(model == "powerlaw")
+		synthetic = SyntheticGraphs::generatePowerLaw(size,size,numberBlocks,degree,mixing,exponent,random);
+	else
+		synthetic = SyntheticGraphs::generateBlockModel(model,size,size,numberBlocks,degree,mixing,random);
+	std::stringstream name;
+	name << directory << "/" << model << "_" << size << "_" << numberBlocks << "_s" << runSeed;
+	std::string inputFileName = name.str() + ".txt";
+	if(SyntheticGraphs::writeGraph(synthetic,inputFileName) != 0)
+	{
+		fprintf(stderr,"\n ::: Benchmark graph %s could not be written :::\n",inputFileName.c_str());
+		return "";
+	}
+
+	//The same steps as Main: preprocessing and load, fuse, biLouvain
+	double start = mytimer();
+	BipartiteEdges edges;
+	std::tr1::unordered_map<int,std::string> bipartiteOriginalEntities = PreProcessInputBipartiteGraph::preProcessingGraphData(inputFileName,"\t",&edges);
+	std::string bipartiteFileName = name.str() + "_bipartite.txt";
+	Graph* graph;
+	if(LoadGraph::loadBipartiteGraphFromEdges(graph,edges.sources,edges.targets,edges.weights,edges.maximumId,edges.lastIdPartitionV1) != 0)
+		return "";
+	double loadTime = mytimer() - start;
+
+	double alpha = 1.0;
+	FuseMethod f;
+	f.setNumberThreads(numberThreads);
+	start = mytimer();
+	if(fuse == 1)
+		f.fuseMethodFile(*graph,bipartiteFileName,alpha,1.0);
+	double fuseTime = mytimer() - start;
+
+	biLouvainMethodMurataPN biLouvain;
+	biLouvain.setNumberThreads(numberThreads);
+	biLouvain.setSeed(runSeed);
+	start = mytimer();
+	biLouvain.biLouvainMethodAlgorithm(*graph,0.01,0.0,optionOrder,bipartiteOriginalEntities,bipartiteFileName,inputFileName,alpha);
+	double algorithmTime = mytimer() - start;
+
+	//Phase and output times come from the profile steps (empty when built without BILOUVAIN_PROFILE)
+	Profiler &profiler = biLouvain.getProfiler();
+	double rate = profiler.ticksPerSecond();
+	std::vector<double> phaseTimes;
+	double outputTime = 0.0;
+	for(int i=0;i<profiler.getNumberSteps();i++)
+	{
+		const profileStep &step = profiler.getStep(i);
+		if(step.step == "output")
+			outputTime += step.wallTicks/rate;
+		else
+		{
+			if((int)phaseTimes.size() < step.phase)
+				phaseTimes.resize(step.phase,0.0);
+			phaseTimes[step.phase-1] += step.wallTicks/rate;
+		}
+	}
+	graph->destroyGraph();
+
+	struct rusage usage;
+	getrusage(RUSAGE_SELF,&usage);
+	std::stringstream result;
+	result.precision(6);
+	result << std::fixed << model << "," << synthetic.numberNodesV1 << "," << synthetic.numberNodesV2 << "," << synthetic.sources.size() << "," << numberBlocks << "," << numberThreads << "," << runSeed << "," << loadTime << "," << fuseTime << "," << algorithmTime << ",";
+	for(unsigned int p=0;p<phaseTimes.size();p++)
+		result << (p > 0 ? ";" : "") << phaseTimes[p];
+	result << "," << outputTime << "," << usage.ru_maxrss << ",";
+	result.precision(12);
+	result << finalModularity(name.str() + "_ResultsModularity.txt") << "," << normalizedMutualInformation(name.str() + "_ResultsCommunities.txt",numberBlocks);
+	return result.str();
+}
+
+int main(int argc, char *argv[])
+{
+	parseCommandLine(argc, argv);
+	std::vector<std::string> modelList;
+	if(models == "all")
+	{
+		modelList.push_back("sbm");
+		modelList.push_back("powerlaw");
+		modelList.push_back("ring");
+		modelList.push_back("chain");
+	}
+	else
+		modelList.push_back(models);
+	mkdir(directory.c_str(),0755);
+	FILE* results = fopen(resultsFileName.c_str(),"a");
+	if(results == NULL)
+	{
+		printf("\n ::: Results file %s could not be opened :::\n",resultsFileName.c_str());
+		exit(EXIT_FAILURE);
+	}
+	const char* header = "model,nodesV1,nodesV2,edges,blocks,threads,seed,loadSeconds,fuseSeconds,biLouvainSeconds,phaseSeconds,outputSeconds,peakRSSKB,modularity,nmi";
+	fseek(results,0,SEEK_END);
+	if(ftell(results) == 0)
+		fprintf(results,"%s\n",header);
+	printf("%s\n",header);
+	fflush(stdout);
+	for(unsigned int m=0;m<modelList.size();m++)
+	{
+		for(int r=0;r<repeat;r++)
+		{
+			int channel[2];
+			if(pipe(channel) != 0)
+			{
+				printf("\n ::: Benchmark process could not be created :::\n");
+				exit(EXIT_FAILURE);
+			}
+			fflush(NULL);
+			pid_t child = fork();
+			if(child == 0)
+			{
+				close(channel[0]);
+				//The algorithm reports every move on stdout
+				if(freopen("/dev/null","w",stdout) == NULL)
+					_exit(EXIT_FAILURE);
+				std::string line = runBenchmark(modelList[m],seed+r);
+				if(write(channel[1],line.c_str(),line.size()) < 0)
+					_exit(EXIT_FAILURE);
+				close(channel[1]);
+				_exit(line.empty() ? EXIT_FAILURE : EXIT_SUCCESS);
+			}
+			close(channel[1]);
+			std::string line;
+			char buffer[4096];
+			ssize_t bytes;
+			while((bytes = read(channel[0],buffer,sizeof(buffer))) > 0)
+				line.append(buffer,bytes);
+			close(channel[0]);
+			int status = 0;
+			waitpid(child,&status,0);
+			if((child < 0)||!WIFEXITED(status)||(WEXITSTATUS(status) != EXIT_SUCCESS)||line.empty())
+			{
+				printf(" ::: Benchmark %s (seed %llu) failed :::\n",modelList[m].c_str(),seed+r);
+				continue;
+			}
+			printf("%s\n",line.c_str());
+			fflush(stdout);
+			fprintf(results,"%s\n",line.c_str());
+			fflush(results);
+		}
+	}
+	fclose(results);
+	return 0;
+}
+
+void printUsage()
+{
+	 printf("Usage: [-model {sbm, powerlaw, ring, chain, all(default=all)} -size {vertices in V1 and in V2(default=300)} -blocks {planted co-clusters(default=5)} -degree {average degree of V1(default=8)} -mixing {fraction of edges outside the planted co-clusters(default=0.1)} -gamma {power-law exponent(default=2.5)} -threads {number of threads(default=1)} -fuse {0/1 flag(default=1)} -order {processing order, see biLouvain(default=3)} -repeat {runs of every model with consecutive seeds(default=1)} -seed {first seed(default=1)} -dir {directory of the generated graphs and results(default=bench)} -o {results CSV, appended(default=bench_results.csv)}]\n");
+	 exit(EXIT_FAILURE);
+}
+
+void parseCommandLine(const int argc, char * const argv[])
+{
+	int ch, indexPtr = 0;
+	while ((ch = getopt_long_only(argc, argv, "o:", longopts, &indexPtr)) != -1)
+	{
+		switch (ch)
+		{
+		    case 'o':
+			resultsFileName = optarg;
+			break;
+		    case 0:
+			if(optarg == NULL)
+				break;
+			if(*(longopts[indexPtr].flag)==1)
+				models = optarg;
+			else if(*(longopts[indexPtr].flag)==2)
+				size = atoi(optarg);
+			else if(*(longopts[indexPtr].flag)==3)
+				numberBlocks = atoi(optarg);
+			else if(*(longopts[indexPtr].flag)==4)
+				degree = atof(optarg);
+			else if(*(longopts[indexPtr].flag)==5)
+				mixing = atof(optarg);
+			else if(*(longopts[indexPtr].flag)==6)
+				exponent = atof(optarg);
+			else if(*(longopts[indexPtr].flag)==7)
+				numberThreads = atoi(optarg);
+			else if(*(longopts[indexPtr].flag)==8)
+				fuse = atoi(optarg);
+			else if(*(longopts[indexPtr].flag)==9)
+				optionOrder = atoi(optarg);
+			else if(*(longopts[indexPtr].flag)==10)
+				repeat = atoi(optarg);
+			else if(*(longopts[indexPtr].flag)==11)
+				seed = strtoull(optarg,NULL,10);
+			else if(*(longopts[indexPtr].flag)==12)
+				directory = optarg;
+			break;
+		    default:
+			printUsage();
+		}
+	}
+	if((size <= 0)||(numberBlocks <= 0)||(numberBlocks > size)||(degree <= 0.0)||(mixing < 0.0)||(mixing > 1.0)||(exponent <= 1.0)||(repeat <= 0))
+		printUsage();
+}
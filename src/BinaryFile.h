@@ -0,0 +1,172 @@
+// **************************************************************************************************
+// biLouvain: A C++ library for bipartite graph community detection
+// Paola Gabriela Pesantez-Cabrera, Ananth Kalyanaraman
+//      (p.pesantezcabrera@wsu.edu, ananth@eecs.wsu.edu)
+// Washington State University
+//
+// For citation, please cite the following paper:
+// Pesantez, Paola and Kalyanaraman, Ananth, "Detecting Communities in Biological
+// Bipartite Networks," Proc. ACM Conference on Bioinformatics, Computational Biology,
+// and Health Informatics (ACM-BCB), Seattle, WA, October 2-5, 2016, In press,
+// DOI: http://dx.doi.org/10.1145/2975167.2975177.
+//
+// **************************************************************************************************
+// Copyright (c) 2016. Washington State University ("WSU"). All Rights Reserved.
+// Permission to use, copy, modify, and distribute this software and its documentation
+// for educational, research, and not-for-profit purposes, without fee, is hereby
+// granted, provided that the above copyright notice, this paragraph and the following
+// two paragraphs appear in all copies, modifications, and distributions. For
+// commercial licensing opportunities, please contact The Office of Commercialization,
+// WSU, 280/286 Lighty, PB Box 641060, Pullman, WA 99164, (509) 335-5526,
+// commercialization@wsu.edu<mailto:commercialization@wsu.edu>, https://commercialization.wsu.edu/
+
+// IN NO EVENT SHALL WSU BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT, SPECIAL, INCIDENTAL,
+// OR CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF
+// THIS SOFTWARE AND ITS DOCUMENTATION, EVEN IF WSU HAS BEEN ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// WSU SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. THE SOFTWARE AND
+// ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS PROVIDED "AS IS". WSU HAS NO
+// OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+// **************************************************************************************************
+
+
+/*
+# BinaryFile.h
+# Helpers shared by the binary files (graph snapshots, phase checkpoints, binary results). Every array in these files
+# starts at a multiple of 8 bytes from the beginning of the file, so it can be used in place from a mapping.
+# The self-describing files (_Results.bin, _ResultsDendrogram.bin) start with a header whose first fields are a
+# SectionFileHeader, followed by a table with the name, type, count and offset of every array (section).
+*/
+
+#ifndef BINARYFILE_H_
+#define BINARYFILE_H_
+#include "Header.h"
+
+class BinaryFile
+{
+  public:
+	enum elementType {INT8 = 1, INT32 = 2, FLOAT64 = 3, INT64 = 4};
+
+	//First fields of the header of a self-describing file
+	struct SectionFileHeader
+	{
+		char magic[8];
+		int version;
+		int numberSections;
+	};
+
+	//Entry of the section table, right after the header
+	struct Section
+	{
+		char name[16];
+		long long offset;	//from the beginning of the file
+		long long count;
+		int elementSize;
+		int type;
+	};
+
+	//An array to be written as a section
+	struct SectionArray
+	{
+		const char* name;
+		const void* data;
+		long long count;
+		int elementSize;
+		int type;
+	};
+
+	static size_t alignedSize(size_t size)
+	{
+		return (size + 7) & ~(size_t)7;
+	}
+
+	//Writes size bytes followed by the padding up to the next multiple of 8
+	static void writeArray(std::ofstream &outputFile,const void* data,size_t size)
+	{
+		static const char padding[8] = {0};
+		if(size > 0)
+			outputFile.write((const char*)data,size);
+		outputFile.write(padding,alignedSize(size)-size);
+	}
+
+	//Writes the header (headerSize bytes, starting with a SectionFileHeader), the section table and the arrays
+	static int writeSectionFile(const std::string &fileName,const void* header,size_t headerSize,const std::vector<SectionArray> &arrays)
+	{
+		std::ofstream outputFile(fileName.c_str(),std::ios::out|std::ios::binary|std::ios::trunc);
+		if(outputFile.is_open() == false)
+			return -1;
+		std::vector<Section> sections(arrays.size());
+		long long offset = alignedSize(headerSize) + alignedSize(sections.size()*sizeof(Section));
+		for(unsigned int i=0;i<arrays.size();i++)
+		{
+			memset(&sections[i],0,sizeof(Section));
+			strncpy(sections[i].name,arrays[i].name,sizeof(sections[i].name)-1);
+			sections[i].offset = offset;
+			sections[i].count = arrays[i].count;
+			sections[i].elementSize = arrays[i].elementSize;
+			sections[i].type = arrays[i].type;
+			offset += alignedSize(arrays[i].count*arrays[i].elementSize);
+		}
+		writeArray(outputFile,header,headerSize);
+		writeArray(outputFile,sections.data(),sections.size()*sizeof(Section));
+		for(unsigned int i=0;i<arrays.size();i++)
+			writeArray(outputFile,arrays[i].data,arrays[i].count*arrays[i].elementSize);
+		outputFile.close();
+		return outputFile.fail() ? -1 : 0;
+	}
+
+	//Maps a self-describing file read-only after checking its magic, its version and that its section table fits.
+	//Returns NULL when the file is missing or is not valid.
+	static const char* mapSectionFile(const std::string &fileName,const char* magic,int version,size_t headerSize,size_t &mappingSize,const char* description)
+	{
+		mappingSize = 0;
+		int file = open(fileName.c_str(),O_RDONLY);
+		if(file < 0)
+			return NULL;
+		struct stat fileStat;
+		if((fstat(file,&fileStat) != 0)||((size_t)fileStat.st_size < alignedSize(headerSize)))
+		{
+			close(file);
+			return NULL;
+		}
+		size_t size = fileStat.st_size;
+		void* mapping = mmap(NULL,size,PROT_READ,MAP_PRIVATE,file,0);
+		close(file);
+		if(mapping == MAP_FAILED)
+			return NULL;
+		const SectionFileHeader* header = (const SectionFileHeader*)mapping;
+		if((memcmp(header->magic,magic,8) != 0)||(header->version != version)||(header->numberSections < 0)||(alignedSize(headerSize) + header->numberSections*sizeof(Section) > size))
+		{
+			rejectSectionFile((const char*)mapping,size,fileName,description);
+			return NULL;
+		}
+		mappingSize = size;
+		return (const char*)mapping;
+	}
+
+	static void rejectSectionFile(const char* data,size_t mappingSize,const std::string &fileName,const char* description)
+	{
+		printf("\n ::: %s is not a valid %s :::",fileName.c_str(),description);
+		munmap((void*)data,mappingSize);
+	}
+
+	//Start of the section called name when it has the expected type and count and fits in the mapping, NULL otherwise
+	static const char* findSection(const char* data,size_t mappingSize,size_t headerSize,const char* name,int type,long long count)
+	{
+		const SectionFileHeader* header = (const SectionFileHeader*)data;
+		const Section* sections = (const Section*)(data + alignedSize(headerSize));
+		for(int s=0;s<header->numberSections;s++)
+		{
+			if(strncmp(sections[s].name,name,sizeof(sections[s].name)) != 0)
+				continue;
+			if((sections[s].type != type)||(sections[s].count != count)||(sections[s].offset < 0)||((size_t)(sections[s].offset + count*sections[s].elementSize) > mappingSize))
+				return NULL;
+			return data + sections[s].offset;
+		}
+		return NULL;
+	}
+};
+
+#endif /* BINARYFILE_H_ */
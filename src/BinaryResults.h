@@ -0,0 +1,155 @@
+// **************************************************************************************************
+// biLouvain: A C++ library for bipartite graph community detection
+// Paola Gabriela Pesantez-Cabrera, Ananth Kalyanaraman
+//      (p.pesantezcabrera@wsu.edu, ananth@eecs.wsu.edu)
+// Washington State University
+//
+// For citation, please cite the following paper:
+// Pesantez, Paola and Kalyanaraman, Ananth, "Detecting Communities in Biological
+// Bipartite Networks," Proc. ACM Conference on Bioinformatics, Computational Biology,
+// and Health Informatics (ACM-BCB), Seattle, WA, October 2-5, 2016, In press,
+// DOI: http://dx.doi.org/10.1145/2975167.2975177.
+//
+// **************************************************************************************************
+// Copyright (c) 2016. Washington State University ("WSU"). All Rights Reserved.
+// Permission to use, copy, modify, and distribute this software and its documentation
+// for educational, research, and not-for-profit purposes, without fee, is hereby
+// granted, provided that the above copyright notice, this paragraph and the following
+// two paragraphs appear in all copies, modifications, and distributions. For
+// commercial licensing opportunities, please contact The Office of Commercialization,
+// WSU, 280/286 Lighty, PB Box 641060, Pullman, WA 99164, (509) 335-5526,
+// commercialization@wsu.edu<mailto:commercialization@wsu.edu>, https://commercialization.wsu.edu/
+
+// IN NO EVENT SHALL WSU BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT, SPECIAL, INCIDENTAL,
+// OR CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF
+// THIS SOFTWARE AND ITS DOCUMENTATION, EVEN IF WSU HAS BEEN ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// WSU SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. THE SOFTWARE AND
+// ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS PROVIDED "AS IS". WSU HAS NO
+// OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+// **************************************************************************************************
+
+
+/*
+# BinaryResults.h
+# Binary copy of the results (_Results.bin) for tools that would otherwise parse _ResultsCommunities.txt and
+# _ResultsCoClusterCommunities.txt. The header is followed by a table of named sections (type, size and offset of
+# every array), so the file describes itself and every array starts at a multiple of 8 bytes and can be used straight
+# from a read-only mapping (mapBinaryResults).
+# Communities are numbered as the "Community N" lines of _ResultsCommunities.txt:
+#   membership		int32[numberInputNodes]	community of every input id (-1 for ids not in the graph)
+#   partition		int8[numberCommunities]	0 for V1, 1 for V2
+#   communityId		int32[numberCommunities]	id used in _ResultsCoClusterCommunities.txt
+#   mateOffsets		int32[numberCommunities+1]	co-cluster mates of community c are mates[mateOffsets[c],mateOffsets[c+1])
+#   mates		int32[numberMates]
+#   contribution	float64[numberCommunities]	contribution of every community to the modularity
+*/
+
+#ifndef BINARYRESULTS_H_
+#define BINARYRESULTS_H_
+#include "Header.h"
+#include "BinaryFile.h"
+
+//Read-only view of a mapped results file; the arrays point into the mapping
+struct binaryResults
+{
+	long long numberInputNodes;
+	long long numberCommunities;
+	long long numberMates;
+	double modularity;
+	double alpha;
+	const int* membership;
+	const signed char* partition;
+	const int* communityId;
+	const int* mateOffsets;
+	const int* mates;
+	const double* contribution;
+	void* mapping;
+	size_t mappingSize;
+};
+
+class BinaryResults
+{
+  private:
+	static const int VERSION = 1;
+
+	struct Header
+	{
+		BinaryFile::SectionFileHeader file;
+		long long numberInputNodes;
+		long long numberCommunities;
+		long long numberMates;
+		double modularity;
+		double alpha;
+	};
+
+  public:
+
+	int static writeBinaryResults(const std::string &fileName,double modularity,double alpha,const std::vector<int> &membership,const std::vector<signed char> &partition,const std::vector<int> &communityId,const std::vector<int> &mateOffsets,const std::vector<int> &mates,const std::vector<double> &contribution)
+	{
+		BinaryFile::SectionArray arrays[] = {
+			{"membership",membership.data(),(long long)membership.size(),sizeof(int),BinaryFile::INT32},
+			{"partition",partition.data(),(long long)partition.size(),sizeof(signed char),BinaryFile::INT8},
+			{"communityId",communityId.data(),(long long)communityId.size(),sizeof(int),BinaryFile::INT32},
+			{"mateOffsets",mateOffsets.data(),(long long)mateOffsets.size(),sizeof(int),BinaryFile::INT32},
+			{"mates",mates.data(),(long long)mates.size(),sizeof(int),BinaryFile::INT32},
+			{"contribution",contribution.data(),(long long)contribution.size(),sizeof(double),BinaryFile::FLOAT64}};
+		Header header;
+		memset(&header,0,sizeof(header));
+		memcpy(header.file.magic,"BILVRSLT",8);
+		header.file.version = VERSION;
+		header.file.numberSections = sizeof(arrays)/sizeof(arrays[0]);
+		header.numberInputNodes = membership.size();
+		header.numberCommunities = partition.size();
+		header.numberMates = mates.size();
+		header.modularity = modularity;
+		header.alpha = alpha;
+		return BinaryFile::writeSectionFile(fileName,&header,sizeof(header),std::vector<BinaryFile::SectionArray>(arrays,arrays+header.file.numberSections));
+	}
+
+	//Maps a results file read-only. Returns -1 when it is missing or is not a valid results file.
+	int static mapBinaryResults(const std::string &fileName,binaryResults &results)
+	{
+		memset(&results,0,sizeof(results));
+		size_t mappingSize = 0;
+		const char* data = BinaryFile::mapSectionFile(fileName,"BILVRSLT",VERSION,sizeof(Header),mappingSize,"results file");
+		if(data == NULL)
+			return -1;
+		const Header* header = (const Header*)data;
+		long long communities = header->numberCommunities;
+		results.membership = (const int*)BinaryFile::findSection(data,mappingSize,sizeof(Header),"membership",BinaryFile::INT32,header->numberInputNodes);
+		results.partition = (const signed char*)BinaryFile::findSection(data,mappingSize,sizeof(Header),"partition",BinaryFile::INT8,communities);
+		results.communityId = (const int*)BinaryFile::findSection(data,mappingSize,sizeof(Header),"communityId",BinaryFile::INT32,communities);
+		results.mateOffsets = (const int*)BinaryFile::findSection(data,mappingSize,sizeof(Header),"mateOffsets",BinaryFile::INT32,communities+1);
+		results.mates = (const int*)BinaryFile::findSection(data,mappingSize,sizeof(Header),"mates",BinaryFile::INT32,header->numberMates);
+		results.contribution = (const double*)BinaryFile::findSection(data,mappingSize,sizeof(Header),"contribution",BinaryFile::FLOAT64,communities);
+		bool valid = (results.mateOffsets != NULL)&&(results.contribution != NULL)&&(results.communityId != NULL)&&(results.partition != NULL);
+		valid = valid&&((header->numberInputNodes == 0)||(results.membership != NULL))&&((header->numberMates == 0)||(results.mates != NULL));
+		if(valid == false)
+		{
+			BinaryFile::rejectSectionFile(data,mappingSize,fileName,"results file");
+			memset(&results,0,sizeof(results));
+			return -1;
+		}
+		results.numberInputNodes = header->numberInputNodes;
+		results.numberCommunities = header->numberCommunities;
+		results.numberMates = header->numberMates;
+		results.modularity = header->modularity;
+		results.alpha = header->alpha;
+		results.mapping = (void*)data;
+		results.mappingSize = mappingSize;
+		return 0;
+	}
+
+	static void unmapBinaryResults(binaryResults &results)
+	{
+		if(results.mapping != NULL)
+			munmap(results.mapping,results.mappingSize);
+		memset(&results,0,sizeof(results));
+	}
+
+};
+
+#endif /* BINARYRESULTS_H_ */
@@ -0,0 +1,309 @@
+// **************************************************************************************************
+// biLouvain: A C++ library for bipartite graph community detection
+// Paola Gabriela Pesantez-Cabrera, Ananth Kalyanaraman
+//      (p.pesantezcabrera@wsu.edu, ananth@eecs.wsu.edu)
+// Washington State University
+//
+// For citation, please cite the following paper:
+// Pesantez, Paola and Kalyanaraman, Ananth, "Detecting Communities in Biological
+// Bipartite Networks," Proc. ACM Conference on Bioinformatics, Computational Biology,
+// and Health Informatics (ACM-BCB), Seattle, WA, October 2-5, 2016, In press,
+// DOI: http://dx.doi.org/10.1145/2975167.2975177.
+//
+// **************************************************************************************************
+// Copyright (c) 2016. Washington State University ("WSU"). All Rights Reserved.
+// Permission to use, copy, modify, and distribute this software and its documentation
+// for educational, research, and not-for-profit purposes, without fee, is hereby
+// granted, provided that the above copyright notice, this paragraph and the following
+// two paragraphs appear in all copies, modifications, and distributions. For
+// commercial licensing opportunities, please contact The Office of Commercialization,
+// WSU, 280/286 Lighty, PB Box 641060, Pullman, WA 99164, (509) 335-5526,
+// commercialization@wsu.edu<mailto:commercialization@wsu.edu>, https://commercialization.wsu.edu/
+
+// IN NO EVENT SHALL WSU BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT, SPECIAL, INCIDENTAL,
+// OR CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF
+// THIS SOFTWARE AND ITS DOCUMENTATION, EVEN IF WSU HAS BEEN ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// WSU SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. THE SOFTWARE AND
+// ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS PROVIDED "AS IS". WSU HAS NO
+// OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+// **************************************************************************************************
+
+
+#include "CSRAdjacency.h"
+
+CSRAdjacency::CSRAdjacency()
+		:_numberNodes(0),_mapping(NULL),_mappingSize(0)
+{
+	_offsets.assign(1,0);
+	_intraTypeOffsets.assign(1,0);
+	bindNeighborRows();
+	bindIntraTypeNeighborRows();
+}
+
+CSRAdjacency::CSRAdjacency(int numberNodes)
+		:_numberNodes(numberNodes),_mapping(NULL),_mappingSize(0)
+{
+	_offsets.assign(numberNodes+1,0);
+	_intraTypeOffsets.assign(numberNodes+1,0);
+	bindNeighborRows();
+	bindIntraTypeNeighborRows();
+}
+
+CSRAdjacency::~CSRAdjacency()
+{
+	if(_mapping != NULL)
+		munmap(_mapping,_mappingSize);
+}
+
+void CSRAdjacency::bindNeighborRows()
+{
+	_offsetsData = _offsets.data();
+	_neighborsData = _neighbors.data();
+	_weightsData = _weights.data();
+	_numberEntries = _neighbors.size();
+}
+
+void CSRAdjacency::bindIntraTypeNeighborRows()
+{
+	_intraTypeOffsetsData = _intraTypeOffsets.data();
+	_intraTypeNeighborsData = _intraTypeNeighbors.data();
+	_intraTypeWeightsData = _intraTypeWeights.data();
+	_numberIntraTypeEntries = _intraTypeNeighbors.size();
+}
+
+//Counting sort of the (source,target,weight) entries into rows. Every row ends up sorted by neighbor id and,
+//as with the maps used before, a repeated (source,target) pair keeps the weight of its last occurrence.
+void CSRAdjacency::buildRows(int numberNodes,const std::vector<int> &sources,const std::vector<int> &targets,const std::vector<double> &weights,std::vector<int> &offsets,std::vector<int> &neighbors,std::vector<double> &rowWeights)
+{
+	int numberEntries = sources.size();
+	std::vector<int> position(numberNodes+1,0);
+	for(int i=0;i<numberEntries;i++)
+		position[sources[i]+1]++;
+	for(int i=0;i<numberNodes;i++)
+		position[i+1] += position[i];
+	std::vector<int> order(numberEntries);
+	std::vector<int> next(position.begin(),position.end()-1);
+	for(int i=0;i<numberEntries;i++)
+		order[next[sources[i]]++] = i;
+
+	offsets.assign(numberNodes+1,0);
+	neighbors.clear();
+	rowWeights.clear();
+	neighbors.reserve(numberEntries);
+	rowWeights.reserve(numberEntries);
+	for(int i=0;i<numberNodes;i++)
+	{
+		std::stable_sort(order.begin()+position[i],order.begin()+position[i+1],[&targets](int a,int b){return targets[a] < targets[b];});
+		for(int k=position[i];k<position[i+1];k++)
+		{
+			int entry = order[k];
+			if((k+1<position[i+1])&&(targets[order[k+1]] == targets[entry]))
+				continue;
+			neighbors.push_back(targets[entry]);
+			rowWeights.push_back(weights[entry]);
+		}
+		offsets[i+1] = neighbors.size();
+	}
+}
+
+/* Get functions */
+int CSRAdjacency::getNumberNodes()
+{
+	return _numberNodes;
+}
+
+int CSRAdjacency::getNumberEntries()
+{
+	return _numberEntries;
+}
+
+int CSRAdjacency::getNumberIntraTypeEntries()
+{
+	return _numberIntraTypeEntries;
+}
+
+const int* CSRAdjacency::getOffsets()
+{
+	return _offsetsData;
+}
+
+const int* CSRAdjacency::getIntraTypeOffsets()
+{
+	return _intraTypeOffsetsData;
+}
+
+int CSRAdjacency::getNumberNeighbors(int nodeId)
+{
+	return _offsetsData[nodeId+1] - _offsetsData[nodeId];
+}
+
+const int* CSRAdjacency::getNeighbors(int nodeId)
+{
+	return _neighborsData + _offsetsData[nodeId];
+}
+
+const double* CSRAdjacency::getWeights(int nodeId)
+{
+	return _weightsData + _offsetsData[nodeId];
+}
+
+int CSRAdjacency::getNumberIntraTypeNeighbors(int nodeId)
+{
+	return _intraTypeOffsetsData[nodeId+1] - _intraTypeOffsetsData[nodeId];
+}
+
+const int* CSRAdjacency::getIntraTypeNeighbors(int nodeId)
+{
+	return _intraTypeNeighborsData + _intraTypeOffsetsData[nodeId];
+}
+
+const double* CSRAdjacency::getIntraTypeWeights(int nodeId)
+{
+	return _intraTypeWeightsData + _intraTypeOffsetsData[nodeId];
+}
+
+/* Set procedures */
+void CSRAdjacency::buildNeighbors(int numberNodes,const std::vector<int> &sources,const std::vector<int> &targets,const std::vector<double> &weights)
+{
+	_numberNodes = numberNodes;
+	buildRows(numberNodes,sources,targets,weights,_offsets,_neighbors,_weights);
+	bindNeighborRows();
+	if(_intraTypeOffsets.size() != (unsigned int)(numberNodes+1))
+	{
+		_intraTypeOffsets.assign(numberNodes+1,0);
+		bindIntraTypeNeighborRows();
+	}
+}
+
+//Adds the given entries to the intra-type rows already stored. Entries given later override the existing ones.
+void CSRAdjacency::buildIntraTypeNeighbors(const std::vector<int> &sources,const std::vector<int> &targets,const std::vector<double> &weights)
+{
+	std::vector<int> allSources;
+	std::vector<int> allTargets;
+	std::vector<double> allWeights;
+	allSources.reserve(_numberIntraTypeEntries+sources.size());
+	allTargets.reserve(_numberIntraTypeEntries+sources.size());
+	allWeights.reserve(_numberIntraTypeEntries+sources.size());
+	for(int i=0;i<_numberNodes;i++)
+	{
+		for(int k=_intraTypeOffsetsData[i];k<_intraTypeOffsetsData[i+1];k++)
+		{
+			allSources.push_back(i);
+			allTargets.push_back(_intraTypeNeighborsData[k]);
+			allWeights.push_back(_intraTypeWeightsData[k]);
+		}
+	}
+	allSources.insert(allSources.end(),sources.begin(),sources.end());
+	allTargets.insert(allTargets.end(),targets.begin(),targets.end());
+	allWeights.insert(allWeights.end(),weights.begin(),weights.end());
+	buildRows(_numberNodes,allSources,allTargets,allWeights,_intraTypeOffsets,_intraTypeNeighbors,_intraTypeWeights);
+	bindIntraTypeNeighborRows();
+}
+
+//Stages the intra-type neighbors of a node until buildPendingIntraTypeNeighbors is called
+void CSRAdjacency::addIntraTypeNeighborsToNode(int nodeId,std::tr1::unordered_map<int,double> &intraTypeNeighbors)
+{
+	for(auto it=intraTypeNeighbors.begin();it!=intraTypeNeighbors.end();++it)
+	{
+		_pendingIntraTypeSources.push_back(nodeId);
+		_pendingIntraTypeTargets.push_back(it->first);
+		_pendingIntraTypeWeights.push_back(it->second);
+	}
+}
+
+void CSRAdjacency::buildPendingIntraTypeNeighbors()
+{
+	buildIntraTypeNeighbors(_pendingIntraTypeSources,_pendingIntraTypeTargets,_pendingIntraTypeWeights);
+	std::vector<int>().swap(_pendingIntraTypeSources);
+	std::vector<int>().swap(_pendingIntraTypeTargets);
+	std::vector<double>().swap(_pendingIntraTypeWeights);
+}
+
+//Takes over rows that are already built, each one sorted by neighbor id. The given vectors are left empty.
+void CSRAdjacency::setNeighborRows(int numberNodes,std::vector<int> &offsets,std::vector<int> &neighbors,std::vector<double> &weights)
+{
+	_numberNodes = numberNodes;
+	_offsets.swap(offsets);
+	_neighbors.swap(neighbors);
+	_weights.swap(weights);
+	std::vector<int>().swap(offsets);
+	std::vector<int>().swap(neighbors);
+	std::vector<double>().swap(weights);
+	bindNeighborRows();
+	if(_intraTypeOffsets.size() != (unsigned int)(numberNodes+1))
+	{
+		_intraTypeOffsets.assign(numberNodes+1,0);
+		bindIntraTypeNeighborRows();
+	}
+}
+
+void CSRAdjacency::setIntraTypeNeighborRows(std::vector<int> &offsets,std::vector<int> &neighbors,std::vector<double> &weights)
+{
+	_intraTypeOffsets.swap(offsets);
+	_intraTypeNeighbors.swap(neighbors);
+	_intraTypeWeights.swap(weights);
+	std::vector<int>().swap(offsets);
+	std::vector<int>().swap(neighbors);
+	std::vector<double>().swap(weights);
+	bindIntraTypeNeighborRows();
+}
+
+//Reads the rows from arrays owned by a read-only mapping, which is released with the adjacency. Without intra-type
+//arrays the intra-type rows are left empty.
+void CSRAdjacency::mapRows(void* mapping,size_t mappingSize,int numberNodes,const int* offsets,const int* neighbors,const double* weights,const int* intraTypeOffsets,const int* intraTypeNeighbors,const double* intraTypeWeights)
+{
+	if(_mapping != NULL)
+		munmap(_mapping,_mappingSize);
+	_mapping = mapping;
+	_mappingSize = mappingSize;
+	_numberNodes = numberNodes;
+	std::vector<int>().swap(_offsets);
+	std::vector<int>().swap(_neighbors);
+	std::vector<double>().swap(_weights);
+	_offsetsData = offsets;
+	_neighborsData = neighbors;
+	_weightsData = weights;
+	_numberEntries = offsets[numberNodes];
+	std::vector<int>().swap(_intraTypeNeighbors);
+	std::vector<double>().swap(_intraTypeWeights);
+	if(intraTypeOffsets != NULL)
+	{
+		std::vector<int>().swap(_intraTypeOffsets);
+		_intraTypeOffsetsData = intraTypeOffsets;
+		_intraTypeNeighborsData = intraTypeNeighbors;
+		_intraTypeWeightsData = intraTypeWeights;
+		_numberIntraTypeEntries = intraTypeOffsets[numberNodes];
+	}
+	else
+	{
+		_intraTypeOffsets.assign(numberNodes+1,0);
+		bindIntraTypeNeighborRows();
+	}
+}
+
+void CSRAdjacency::swap(CSRAdjacency &other)
+{
+	std::swap(_numberNodes,other._numberNodes);
+	_offsets.swap(other._offsets);
+	_neighbors.swap(other._neighbors);
+	_weights.swap(other._weights);
+	_intraTypeOffsets.swap(other._intraTypeOffsets);
+	_intraTypeNeighbors.swap(other._intraTypeNeighbors);
+	_intraTypeWeights.swap(other._intraTypeWeights);
+	_pendingIntraTypeSources.swap(other._pendingIntraTypeSources);
+	_pendingIntraTypeTargets.swap(other._pendingIntraTypeTargets);
+	_pendingIntraTypeWeights.swap(other._pendingIntraTypeWeights);
+	std::swap(_offsetsData,other._offsetsData);
+	std::swap(_neighborsData,other._neighborsData);
+	std::swap(_weightsData,other._weightsData);
+	std::swap(_numberEntries,other._numberEntries);
+	std::swap(_intraTypeOffsetsData,other._intraTypeOffsetsData);
+	std::swap(_intraTypeNeighborsData,other._intraTypeNeighborsData);
+	std::swap(_intraTypeWeightsData,other._intraTypeWeightsData);
+	std::swap(_numberIntraTypeEntries,other._numberIntraTypeEntries);
+	std::swap(_mapping,other._mapping);
+	std::swap(_mappingSize,other._mappingSize);
+}
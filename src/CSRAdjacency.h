@@ -0,0 +1,108 @@
+// **************************************************************************************************
+// biLouvain: A C++ library for bipartite graph community detection
+// Paola Gabriela Pesantez-Cabrera, Ananth Kalyanaraman
+//      (p.pesantezcabrera@wsu.edu, ananth@eecs.wsu.edu)
+// Washington State University
+//
+// For citation, please cite the following paper:
+// Pesantez, Paola and Kalyanaraman, Ananth, "Detecting Communities in Biological
+// Bipartite Networks," Proc. ACM Conference on Bioinformatics, Computational Biology,
+// and Health Informatics (ACM-BCB), Seattle, WA, October 2-5, 2016, In press,
+// DOI: http://dx.doi.org/10.1145/2975167.2975177.
+//
+// **************************************************************************************************
+// Copyright (c) 2016. Washington State University ("WSU"). All Rights Reserved.
+// Permission to use, copy, modify, and distribute this software and its documentation
+// for educational, research, and not-for-profit purposes, without fee, is hereby
+// granted, provided that the above copyright notice, this paragraph and the following
+// two paragraphs appear in all copies, modifications, and distributions. For
+// commercial licensing opportunities, please contact The Office of Commercialization,
+// WSU, 280/286 Lighty, PB Box 641060, Pullman, WA 99164, (509) 335-5526,
+// commercialization@wsu.edu<mailto:commercialization@wsu.edu>, https://commercialization.wsu.edu/
+
+// IN NO EVENT SHALL WSU BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT, SPECIAL, INCIDENTAL,
+// OR CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF
+// THIS SOFTWARE AND ITS DOCUMENTATION, EVEN IF WSU HAS BEEN ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// WSU SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. THE SOFTWARE AND
+// ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS PROVIDED "AS IS". WSU HAS NO
+// OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+// **************************************************************************************************
+
+
+/*
+# CSRAdjacency.h
+# Compressed sparse row storage for the inter-type and intra-type edges of the graph.
+# Rows are indexed by node id, so the rows of V1 come before the rows of V2 and each partition
+# is a contiguous slice of the offset, neighbor and weight arrays.
+# The rows are read through pointers that refer either to the vectors below or to a read-only memory mapped
+# graph snapshot (see GraphSnapshot.h), which is unmapped when the adjacency is destroyed.
+*/
+
+#ifndef CSRADJACENCY_H_
+#define CSRADJACENCY_H_
+
+#include "Header.h"
+
+class CSRAdjacency
+{
+	private:
+		int _numberNodes;
+		std::vector<int> _offsets;
+		std::vector<int> _neighbors;
+		std::vector<double> _weights;
+		std::vector<int> _intraTypeOffsets;
+		std::vector<int> _intraTypeNeighbors;
+		std::vector<double> _intraTypeWeights;
+		std::vector<int> _pendingIntraTypeSources;
+		std::vector<int> _pendingIntraTypeTargets;
+		std::vector<double> _pendingIntraTypeWeights;
+		const int* _offsetsData;
+		const int* _neighborsData;
+		const double* _weightsData;
+		int _numberEntries;
+		const int* _intraTypeOffsetsData;
+		const int* _intraTypeNeighborsData;
+		const double* _intraTypeWeightsData;
+		int _numberIntraTypeEntries;
+		void* _mapping;
+		size_t _mappingSize;
+
+		CSRAdjacency(const CSRAdjacency &other);
+		CSRAdjacency& operator=(const CSRAdjacency &other);
+		void bindNeighborRows();
+		void bindIntraTypeNeighborRows();
+		static void buildRows(int numberNodes,const std::vector<int> &sources,const std::vector<int> &targets,const std::vector<double> &weights,std::vector<int> &offsets,std::vector<int> &neighbors,std::vector<double> &rowWeights);
+
+	public:
+		CSRAdjacency();
+		CSRAdjacency(int numberNodes);
+		~CSRAdjacency();
+
+		/* Get functions */
+		int getNumberNodes();
+		int getNumberEntries();
+		int getNumberIntraTypeEntries();
+		const int* getOffsets();
+		const int* getIntraTypeOffsets();
+		int getNumberNeighbors(int nodeId);
+		const int* getNeighbors(int nodeId);
+		const double* getWeights(int nodeId);
+		int getNumberIntraTypeNeighbors(int nodeId);
+		const int* getIntraTypeNeighbors(int nodeId);
+		const double* getIntraTypeWeights(int nodeId);
+
+		/* Set procedures */
+		void buildNeighbors(int numberNodes,const std::vector<int> &sources,const std::vector<int> &targets,const std::vector<double> &weights);
+		void buildIntraTypeNeighbors(const std::vector<int> &sources,const std::vector<int> &targets,const std::vector<double> &weights);
+		void addIntraTypeNeighborsToNode(int nodeId,std::tr1::unordered_map<int,double> &intraTypeNeighbors);
+		void buildPendingIntraTypeNeighbors();
+		void setNeighborRows(int numberNodes,std::vector<int> &offsets,std::vector<int> &neighbors,std::vector<double> &weights);
+		void setIntraTypeNeighborRows(std::vector<int> &offsets,std::vector<int> &neighbors,std::vector<double> &weights);
+		void mapRows(void* mapping,size_t mappingSize,int numberNodes,const int* offsets,const int* neighbors,const double* weights,const int* intraTypeOffsets,const int* intraTypeNeighbors,const double* intraTypeWeights);
+		void swap(CSRAdjacency &other);
+};
+
+#endif /* CSRADJACENCY_H_ */
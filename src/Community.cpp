@@ -34,7 +34,13 @@
 
 #include "Community.h"
 
-Community::Community(){}
+Community::Community()
+{
+	_id = -1;
+	_modularityContribution = 0.0;
+	_betaFactor = 0.0;
+	calculateTotals();
+}
 
 Community::Community(int id, std::string description, std::tr1::unordered_map<int,double> nodes,int option)
 {
@@ -46,6 +52,7 @@ Community::Community(int id, std::string description, std::tr1::unordered_map<in
 		_nodesIntraType = nodes;
         _modularityContribution = 0.0;
         _betaFactor = 0.0;
+	calculateTotals();
 }
 
 
@@ -57,6 +64,19 @@ Community::Community(int id, std::string description, std::tr1::unordered_map<in
 	_nodesIntraType = nodesIntraType;
 	_modularityContribution = 0.0;
 	_betaFactor = 0.0;
+	calculateTotals();
+}
+
+void Community::calculateTotals()
+{
+	_degree = 0.0;
+	for(auto it=_nodes.begin();it!=_nodes.end();++it)
+		_degree += it->second;
+	_similarity = 0.0;
+	for(auto it=_nodesIntraType.begin();it!=_nodesIntraType.end();++it)
+		_similarity += it->second;
+	_internalSimilarity = 0.0;
+	_internalSimilarityValid = false;
 }
 
 /* Get functions */
@@ -96,6 +116,18 @@ std::vector<int> Community::getNodes()
 	return result;
 }
 
+MemberIdRange Community::getNodesRange()
+{
+	const std::tr1::unordered_map<int,double> &members = (_nodes.size() != 0) ? _nodes : _nodesIntraType;
+	return MemberIdRange(members.begin(),members.end(),members.size());
+}
+
+IdRange Community::getCoClusterMateCommunityIdRange()
+{
+	const int* mates = _coClusterMateCommunityId.data();
+	return IdRange(mates,mates+_coClusterMateCommunityId.size(),_coClusterMateCommunityId.size());
+}
+
 std::vector<int> Community::getCoClusterMateCommunityId()
 {
 	std::vector<int> result;
@@ -113,36 +145,70 @@ int Community::getNumberNodes()
 
 double Community::getDegreeCommunity()
 {
-	double result = 0.0;
-	for(auto it=_nodes.begin();it!=_nodes.end();++it)
-		result += it->second;
-	return result;
+	return (double)_degree;
 }
 
 double Community::getDegreeCommunityWithoutNode(int node_id)
 {
-	double result = 0.0;
-	for(auto it=_nodes.begin();it!=_nodes.end();++it)
-		if(it->first != node_id)
-			result += it->second;
-	return result;
+	auto it = _nodes.find(node_id);
+	if(it == _nodes.end())
+		return (double)_degree;
+	return (double)(_degree - it->second);
 }
 
 double Community::getSimilarity()
 {
-	double result = 0.0;
-        for(auto it=_nodesIntraType.begin();it!=_nodesIntraType.end();++it)
-        	result += it->second;
-        return result;
+        return (double)_similarity;
 }
 
 double Community::getSimilarityWithoutNode(int nodeId)
 {
-        double result = 0.0;
-        for(auto it=_nodesIntraType.begin();it!=_nodesIntraType.end();++it)
-                if(it->first != nodeId)
-                        result += it->second;
-        return result;
+        auto it = _nodesIntraType.find(nodeId);
+        if(it == _nodesIntraType.end())
+                return (double)_similarity;
+        return (double)(_similarity - it->second);
+}
+
+double Community::getWeightEdgesToNeighborCommunity(int communityId)
+{
+	auto it = _neighborCommunities.find(communityId);
+	if(it == _neighborCommunities.end())
+		return 0.0;
+	return (double)it->second.first;
+}
+
+int Community::getNumberEdgesToNeighborCommunity(int communityId)
+{
+	auto it = _neighborCommunities.find(communityId);
+	if(it == _neighborCommunities.end())
+		return 0;
+	return it->second.second;
+}
+
+NeighborCommunityIdRange Community::getNeighborCommunitiesRange()
+{
+	const std::tr1::unordered_map<int,std::pair<long double,int> > &neighbors = _neighborCommunities;
+	return NeighborCommunityIdRange(neighbors.begin(),neighbors.end(),neighbors.size());
+}
+
+int Community::getNumberNeighborCommunities()
+{
+	return _neighborCommunities.size();
+}
+
+bool Community::hasInternalSimilarity()
+{
+	return _internalSimilarityValid;
+}
+
+double Community::getInternalSimilarity()
+{
+	return _internalSimilarity;
+}
+
+int Community::getNumberNodesWithoutNode(int nodeId)
+{
+	return _nodes.size() - _nodes.count(nodeId);
 }
 
 std::vector<int> Community::getNodesWithoutNode(int nodeId)
@@ -171,14 +237,21 @@ void Community::setCoClusterMateCommunityId(std::vector<int> coClusterMateCommun
 	_coClusterMateCommunityId = coClusterMateCommunityId;
 }
 
+void Community::setCoClusterMateCommunityId(IdRange coClusterMateCommunityId)
+{
+	_coClusterMateCommunityId.assign(coClusterMateCommunityId.begin(),coClusterMateCommunityId.end());
+}
+
 void Community::setNodes(std::tr1::unordered_map<int,double> nodes)
 {
 	_nodes = nodes;
+	calculateTotals();
 }
 
 void Community::setNodesIntratype(std::tr1::unordered_map<int,double> nodesIntraType)
 {
         _nodesIntraType = nodesIntraType;
+	calculateTotals();
 }
 
 void Community::setModularityContribution(double modularityContribution)
@@ -191,24 +264,72 @@ void Community::setBetaFactor(double betaFactor)
         _betaFactor = betaFactor;
 }
 
+void Community::setInternalSimilarity(double internalSimilarity)
+{
+	_internalSimilarity = internalSimilarity;
+	_internalSimilarityValid = true;
+}
+
+void Community::invalidateInternalSimilarity()
+{
+	_internalSimilarityValid = false;
+}
+
+void Community::clearNeighborCommunities()
+{
+	_neighborCommunities.clear();
+}
+
+void Community::addNeighborCommunityWeight(int communityId, double weight)
+{
+	std::pair<long double,int> &entry = _neighborCommunities[communityId];
+	entry.first += weight;
+	entry.second++;
+}
+
+void Community::deleteNeighborCommunityWeight(int communityId, double weight)
+{
+	auto it = _neighborCommunities.find(communityId);
+	if(it == _neighborCommunities.end()) return;
+	if(--it->second.second <= 0)
+		_neighborCommunities.erase(it);
+	else
+		it->second.first -= weight;
+}
+
 void Community::addNode(int nodeId, double nodeDegree)
 {
-	_nodes[nodeId] = nodeDegree;
+	double &degree = _nodes[nodeId];
+	_degree += nodeDegree - degree;
+	degree = nodeDegree;
 }
 
 
 void Community::deleteNode(int nodeId)
 {
-	_nodes.erase(nodeId);
+	auto it = _nodes.find(nodeId);
+	if(it == _nodes.end()) return;
+	_degree -= it->second;
+	_nodes.erase(it);
+	//Avoid carrying rounding residue into an empty community
+	if(_nodes.empty()) _degree = 0.0;
 }
 
 void Community::addIntraTypeNode(int nodeId, double nodeSimilarity)
 {
-        _nodesIntraType[nodeId] = nodeSimilarity;
+        double &similarity = _nodesIntraType[nodeId];
+        _similarity += nodeSimilarity - similarity;
+        similarity = nodeSimilarity;
+        _internalSimilarityValid = false;
 }
 
 
 void Community::deleteIntraTypeNode(int nodeId)
 {
-        _nodesIntraType.erase(nodeId);
+        auto it = _nodesIntraType.find(nodeId);
+        if(it == _nodesIntraType.end()) return;
+        _similarity -= it->second;
+        _nodesIntraType.erase(it);
+        if(_nodesIntraType.empty()) _similarity = 0.0;
+        _internalSimilarityValid = false;
 }
@@ -43,10 +43,15 @@
 
 
 #include "Header.h"
+#include "Range.h"
+
+typedef Range<KeyIterator<std::tr1::unordered_map<int,double>::const_iterator> > MemberIdRange;
+typedef Range<KeyIterator<std::tr1::unordered_map<int,std::pair<long double,int> >::const_iterator> > NeighborCommunityIdRange;
 
 struct newDataCommunity
 {
-	std::string coClusterMateCommunityId;
+	int communityId;
+	std::vector<int> coClusterMateCommunityId;
 	double newModularityContribution;
 	double newBetaFactor;
 };
@@ -67,6 +72,17 @@ class Community
 		std::tr1::unordered_map<int,double> _nodes;
 		std::tr1::unordered_map<int,double> _nodesIntraType;
 		double _betaFactor;
+		//Running totals of _nodes and _nodesIntraType, updated on every add/delete
+		long double _degree;
+		long double _similarity;
+		//Sum of the intra type similarities among members, cached until a member or one of its neighbors moves
+		double _internalSimilarity;
+		bool _internalSimilarityValid;
+		//Sparse row of the community-to-community edge weights (e_lm): neighbor community id -> (weight, number of edges).
+		//The edge count lets an entry be erased exactly when its last edge leaves, without rounding residue.
+		std::tr1::unordered_map<int,std::pair<long double,int> > _neighborCommunities;
+
+		void calculateTotals();
 
 	public:
 		Community();
@@ -83,7 +99,17 @@ class Community
 		double getSimilarityWithoutNode(int nodeId);
 		double getDegreeCommunity();
 		double getDegreeCommunityWithoutNode(int nodeId);
+		double getWeightEdgesToNeighborCommunity(int communityId);
+		int getNumberEdgesToNeighborCommunity(int communityId);
+		NeighborCommunityIdRange getNeighborCommunitiesRange();
+		int getNumberNeighborCommunities();
+		bool hasInternalSimilarity();
+		double getInternalSimilarity();
 		
+		//Views that do not copy; invalidated when the members or co-cluster mates change
+		MemberIdRange getNodesRange();
+		IdRange getCoClusterMateCommunityIdRange();
+		int getNumberNodesWithoutNode(int nodeId);
 		std::vector<int> getNodesWithoutNode(int nodeId);
 		std::vector<int> getNodes();
                 std::vector<int> getCoClusterMateCommunityId();
@@ -92,10 +118,16 @@ class Community
 		void setId(int id);
 		void setDescription(std::string description);
 		void setCoClusterMateCommunityId(std::vector<int> coClusterCommunityId);
+		void setCoClusterMateCommunityId(IdRange coClusterCommunityId);
 		void setNodes(std::tr1::unordered_map<int,double> nodes);
 		void setNodesIntratype(std::tr1::unordered_map<int,double> nodesIntraType);
 		void setModularityContribution(double modularityContribution);
 		void setBetaFactor(double betaFactor);
+		void setInternalSimilarity(double internalSimilarity);
+		void invalidateInternalSimilarity();
+		void clearNeighborCommunities();
+		void addNeighborCommunityWeight(int communityId, double weight);
+		void deleteNeighborCommunityWeight(int communityId, double weight);
 		void addNode(int nodeId, double nodeDegree);
 		void deleteNode(int nodeId);
 		void addIntraTypeNode(int nodeId, double nodeSimilarity);
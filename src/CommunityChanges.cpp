@@ -0,0 +1,108 @@
+// **************************************************************************************************
+// biLouvain: A C++ library for bipartite graph community detection
+// Paola Gabriela Pesantez-Cabrera, Ananth Kalyanaraman
+//      (p.pesantezcabrera@wsu.edu, ananth@eecs.wsu.edu)
+// Washington State University
+//
+// For citation, please cite the following paper:
+// Pesantez, Paola and Kalyanaraman, Ananth, "Detecting Communities in Biological
+// Bipartite Networks," Proc. ACM Conference on Bioinformatics, Computational Biology,
+// and Health Informatics (ACM-BCB), Seattle, WA, October 2-5, 2016, In press,
+// DOI: http://dx.doi.org/10.1145/2975167.2975177.
+//
+// **************************************************************************************************
+// Copyright (c) 2016. Washington State University ("WSU"). All Rights Reserved.
+// Permission to use, copy, modify, and distribute this software and its documentation
+// for educational, research, and not-for-profit purposes, without fee, is hereby
+// granted, provided that the above copyright notice, this paragraph and the following
+// two paragraphs appear in all copies, modifications, and distributions. For
+// commercial licensing opportunities, please contact The Office of Commercialization,
+// WSU, 280/286 Lighty, PB Box 641060, Pullman, WA 99164, (509) 335-5526,
+// commercialization@wsu.edu<mailto:commercialization@wsu.edu>, https://commercialization.wsu.edu/
+
+// IN NO EVENT SHALL WSU BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT, SPECIAL, INCIDENTAL,
+// OR CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF
+// THIS SOFTWARE AND ITS DOCUMENTATION, EVEN IF WSU HAS BEEN ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// WSU SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. THE SOFTWARE AND
+// ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS PROVIDED "AS IS". WSU HAS NO
+// OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+// **************************************************************************************************
+
+
+#include "CommunityChanges.h"
+
+CommunityChanges::CommunityChanges()
+{
+	_coClusterMatesOffsets.push_back(0);
+}
+
+/* Get functions */
+int CommunityChanges::getNumberChanges()
+{
+	return _communityIds.size();
+}
+
+int CommunityChanges::getCommunityId(int change)
+{
+	return _communityIds[change];
+}
+
+double CommunityChanges::getModularityContribution(int change)
+{
+	return _modularityContributions[change];
+}
+
+double CommunityChanges::getBetaFactor(int change)
+{
+	return _betaFactors[change];
+}
+
+IdRange CommunityChanges::getCoClusterMateCommunityIdRange(int change)
+{
+	const int* mates = _coClusterMates.data();
+	int begin = _coClusterMatesOffsets[change];
+	int end = _coClusterMatesOffsets[change+1];
+	return IdRange(mates+begin,mates+end,end-begin);
+}
+
+/* Set procedures */
+void CommunityChanges::addChange(const newDataCommunity &change, double modularityContribution)
+{
+	_communityIds.push_back(change.communityId);
+	_modularityContributions.push_back(modularityContribution);
+	_betaFactors.push_back(change.newBetaFactor);
+	_coClusterMates.insert(_coClusterMates.end(),change.coClusterMateCommunityId.begin(),change.coClusterMateCommunityId.end());
+	_coClusterMatesOffsets.push_back(_coClusterMates.size());
+}
+
+void CommunityChanges::addChanges(CommunityChanges &changes)
+{
+	int offset = _coClusterMates.size();
+	_communityIds.insert(_communityIds.end(),changes._communityIds.begin(),changes._communityIds.end());
+	_modularityContributions.insert(_modularityContributions.end(),changes._modularityContributions.begin(),changes._modularityContributions.end());
+	_betaFactors.insert(_betaFactors.end(),changes._betaFactors.begin(),changes._betaFactors.end());
+	_coClusterMates.insert(_coClusterMates.end(),changes._coClusterMates.begin(),changes._coClusterMates.end());
+	for(unsigned int i=1;i<changes._coClusterMatesOffsets.size();i++)
+		_coClusterMatesOffsets.push_back(offset + changes._coClusterMatesOffsets[i]);
+}
+
+void CommunityChanges::clear()
+{
+	_communityIds.clear();
+	_modularityContributions.clear();
+	_betaFactors.clear();
+	_coClusterMates.clear();
+	_coClusterMatesOffsets.resize(1);
+}
+
+void CommunityChanges::swap(CommunityChanges &changes)
+{
+	_communityIds.swap(changes._communityIds);
+	_modularityContributions.swap(changes._modularityContributions);
+	_betaFactors.swap(changes._betaFactors);
+	_coClusterMatesOffsets.swap(changes._coClusterMatesOffsets);
+	_coClusterMates.swap(changes._coClusterMates);
+}
@@ -0,0 +1,92 @@
+// **************************************************************************************************
+// biLouvain: A C++ library for bipartite graph community detection
+// Paola Gabriela Pesantez-Cabrera, Ananth Kalyanaraman
+//      (p.pesantezcabrera@wsu.edu, ananth@eecs.wsu.edu)
+// Washington State University
+//
+// For citation, please cite the following paper:
+// Pesantez, Paola and Kalyanaraman, Ananth, "Detecting Communities in Biological
+// Bipartite Networks," Proc. ACM Conference on Bioinformatics, Computational Biology,
+// and Health Informatics (ACM-BCB), Seattle, WA, October 2-5, 2016, In press,
+// DOI: http://dx.doi.org/10.1145/2975167.2975177.
+//
+// **************************************************************************************************
+// Copyright (c) 2016. Washington State University ("WSU"). All Rights Reserved.
+// Permission to use, copy, modify, and distribute this software and its documentation
+// for educational, research, and not-for-profit purposes, without fee, is hereby
+// granted, provided that the above copyright notice, this paragraph and the following
+// two paragraphs appear in all copies, modifications, and distributions. For
+// commercial licensing opportunities, please contact The Office of Commercialization,
+// WSU, 280/286 Lighty, PB Box 641060, Pullman, WA 99164, (509) 335-5526,
+// commercialization@wsu.edu<mailto:commercialization@wsu.edu>, https://commercialization.wsu.edu/
+
+// IN NO EVENT SHALL WSU BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT, SPECIAL, INCIDENTAL,
+// OR CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF
+// THIS SOFTWARE AND ITS DOCUMENTATION, EVEN IF WSU HAS BEEN ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// WSU SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. THE SOFTWARE AND
+// ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS PROVIDED "AS IS". WSU HAS NO
+// OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+// **************************************************************************************************
+
+
+/*
+# CommunityChanges.h
+# Typed buffer of the community updates implied by a vertex move (community id, co-cluster mates,
+# new modularity contribution and new beta factor). Records are appended while the move is scored and
+# applied in order if it is accepted. The storage is reused between moves, so it only grows.
+*/
+
+#ifndef COMMUNITYCHANGES_H_
+#define COMMUNITYCHANGES_H_
+
+#include "Header.h"
+#include "Community.h"
+
+class CommunityChanges
+{
+	private:
+		std::vector<int> _communityIds;
+		std::vector<double> _modularityContributions;
+		std::vector<double> _betaFactors;
+		//Mates of change k are _coClusterMates[_coClusterMatesOffsets[k] .. _coClusterMatesOffsets[k+1])
+		std::vector<int> _coClusterMatesOffsets;
+		std::vector<int> _coClusterMates;
+
+	public:
+		CommunityChanges();
+
+		/* Get functions */
+		int getNumberChanges();
+		int getCommunityId(int change);
+		double getModularityContribution(int change);
+		double getBetaFactor(int change);
+		IdRange getCoClusterMateCommunityIdRange(int change);
+
+		/* Set procedures */
+		void addChange(const newDataCommunity &change, double modularityContribution);
+		void addChanges(CommunityChanges &changes);
+		void clear();
+		void swap(CommunityChanges &changes);
+};
+
+//Best move found for a node while scoring it, together with the scratch storage used to find it
+struct moveProposal
+{
+	int nodeId;
+	int currentCommunity;
+	int candidateCommunity;
+	double totalDeltaModularityGain;
+	double betaFactorCurrentCommunity;
+	double betaFactorCandidateCommunity;
+	CommunityChanges changes;
+	CommunityChanges candidateChanges;
+	CommunityChanges maxChangesCandidate;
+	std::vector<int> candidates;
+	//Communities whose state the scoring depended on, used to detect conflicts with moves committed before it
+	std::vector<int> dependencies;
+};
+
+#endif /* COMMUNITYCHANGES_H_ */
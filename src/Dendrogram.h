@@ -0,0 +1,261 @@
+// **************************************************************************************************
+// biLouvain: A C++ library for bipartite graph community detection
+// Paola Gabriela Pesantez-Cabrera, Ananth Kalyanaraman
+//      (p.pesantezcabrera@wsu.edu, ananth@eecs.wsu.edu)
+// Washington State University
+//
+// For citation, please cite the following paper:
+// Pesantez, Paola and Kalyanaraman, Ananth, "Detecting Communities in Biological
+// Bipartite Networks," Proc. ACM Conference on Bioinformatics, Computational Biology,
+// and Health Informatics (ACM-BCB), Seattle, WA, October 2-5, 2016, In press,
+// DOI: http://dx.doi.org/10.1145/2975167.2975177.
+//
+// **************************************************************************************************
+// Copyright (c) 2016. Washington State University ("WSU"). All Rights Reserved.
+// Permission to use, copy, modify, and distribute this software and its documentation
+// for educational, research, and not-for-profit purposes, without fee, is hereby
+// granted, provided that the above copyright notice, this paragraph and the following
+// two paragraphs appear in all copies, modifications, and distributions. For
+// commercial licensing opportunities, please contact The Office of Commercialization,
+// WSU, 280/286 Lighty, PB Box 641060, Pullman, WA 99164, (509) 335-5526,
+// commercialization@wsu.edu<mailto:commercialization@wsu.edu>, https://commercialization.wsu.edu/
+
+// IN NO EVENT SHALL WSU BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT, SPECIAL, INCIDENTAL,
+// OR CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF
+// THIS SOFTWARE AND ITS DOCUMENTATION, EVEN IF WSU HAS BEEN ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// WSU SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. THE SOFTWARE AND
+// ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS PROVIDED "AS IS". WSU HAS NO
+// OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+// **************************************************************************************************
+
+
+/*
+# Dendrogram.h
+# Community hierarchy of a run. Level 0 holds the nodes the first phase starts from (the input vertices, or the
+# initial communities after fuse) and level k the communities found by phase k; the last level holds the final
+# communities, numbered as in _ResultsCommunities.txt. Every level is a parent-pointer array: the community of the
+# next level of each of its nodes, so the community of a vertex at any level is found by following the pointers.
+# writeDendrogram saves it as _ResultsDendrogram.bin, a self-describing file (named sections, 8-byte aligned) that
+# mapDendrogram maps read-only:
+#   leaves		int32[numberInputNodes]	node of level 0 of every input id (-1 for ids not in the graph)
+#   levelOffsets	int64[numberLevels+1]	parents of the nodes of level k are parents[levelOffsets[k],levelOffsets[k+1])
+#   parents		int32[numberParents]
+#   modularity		float64[numberLevels]	modularity of the partition of level k+1
+*/
+
+#ifndef DENDROGRAM_H_
+#define DENDROGRAM_H_
+#include "Header.h"
+#include "BinaryFile.h"
+
+//Read-only view of a mapped dendrogram file; the arrays point into the mapping
+struct dendrogramFile
+{
+	long long numberInputNodes;
+	long long numberLevels;
+	long long numberParents;
+	const int* leaves;
+	const long long* levelOffsets;
+	const int* parents;
+	const double* modularity;
+	void* mapping;
+	size_t mappingSize;
+};
+
+class Dendrogram
+{
+  private:
+	static const int VERSION = 1;
+
+	std::vector<int> _leaves;
+	std::vector<long long> _levelOffsets;
+	std::vector<int> _parents;
+	std::vector<double> _modularity;
+
+	struct Header
+	{
+		BinaryFile::SectionFileHeader file;
+		long long numberInputNodes;
+		long long numberLevels;
+		long long numberParents;
+	};
+
+	//Every pointer must name a node of the next level, so following them never leaves the arrays
+	static bool validPointers(const int* leaves,long long numberInputNodes,const long long* levelOffsets,const int* parents,long long numberLevels)
+	{
+		if(levelOffsets[0] != 0)
+			return false;
+		for(long long k=0;k<numberLevels;k++)
+			if(levelOffsets[k+1] < levelOffsets[k])
+				return false;
+		long long numberNodes = (numberLevels > 0) ? levelOffsets[1] : 0;
+		for(long long vertex=0;vertex<numberInputNodes;vertex++)
+			if((leaves[vertex] < -1)||((numberLevels > 0)&&(leaves[vertex] >= numberNodes)))
+				return false;
+		for(long long k=0;k+1<numberLevels;k++)
+		{
+			numberNodes = levelOffsets[k+2] - levelOffsets[k+1];
+			for(long long i=levelOffsets[k];i<levelOffsets[k+1];i++)
+				if((parents[i] < 0)||(parents[i] >= numberNodes))
+					return false;
+		}
+		for(long long i=(numberLevels > 0) ? levelOffsets[numberLevels-1] : 0;i<levelOffsets[numberLevels];i++)
+			if(parents[i] < 0)
+				return false;
+		return true;
+	}
+
+	//Shared by the in-memory and the mapped dendrogram; -1 for ids that are not in the graph or levels out of range
+	static int findCommunity(const int* leaves,long long numberInputNodes,const long long* levelOffsets,const int* parents,long long numberLevels,int vertex,int level)
+	{
+		if((vertex < 0)||(vertex >= numberInputNodes)||(level < 0)||(level > numberLevels))
+			return -1;
+		int node = leaves[vertex];
+		for(int k=0;(k<level)&&(node >= 0);k++)
+			node = parents[levelOffsets[k]+node];
+		return node;
+	}
+
+  public:
+	Dendrogram()
+	{
+		clear();
+	}
+
+	void clear()
+	{
+		_leaves.clear();
+		_levelOffsets.assign(1,0);
+		_parents.clear();
+		_modularity.clear();
+	}
+
+	void setLeaves(const std::vector<int> &leaves)
+	{
+		_leaves = leaves;
+	}
+
+	//parent[i] is the community of the next level of node i of the current top level
+	void addLevel(const std::vector<int> &parent,double modularity)
+	{
+		_parents.insert(_parents.end(),parent.begin(),parent.end());
+		_levelOffsets.push_back(_parents.size());
+		_modularity.push_back(modularity);
+	}
+
+	//Levels above level 0; the final communities are the ones of level getNumberLevels()
+	int getNumberLevels() const
+	{
+		return _modularity.size();
+	}
+
+	int getNumberInputNodes() const
+	{
+		return _leaves.size();
+	}
+
+	//Modularity of the partition of level (1..getNumberLevels())
+	double getModularity(int level) const
+	{
+		return _modularity[level-1];
+	}
+
+	int communityAtLevel(int vertex,int level) const
+	{
+		return findCommunity(_leaves.data(),_leaves.size(),_levelOffsets.data(),_parents.data(),getNumberLevels(),vertex,level);
+	}
+
+	//Community at level of every input id, -1 for ids that are not in the graph
+	std::vector<int> membershipAtLevel(int level) const
+	{
+		std::vector<int> membership(_leaves.size(),-1);
+		for(unsigned int vertex=0;vertex<_leaves.size();vertex++)
+			membership[vertex] = communityAtLevel(vertex,level);
+		return membership;
+	}
+
+	//The arrays are copied as they are into the phase checkpoints
+	const std::vector<int>& getLeaves() const { return _leaves; }
+	const std::vector<long long>& getLevelOffsets() const { return _levelOffsets; }
+	const std::vector<int>& getParents() const { return _parents; }
+	const std::vector<double>& getModularities() const { return _modularity; }
+
+	void setLevels(const std::vector<int> &leaves,const std::vector<long long> &levelOffsets,const std::vector<int> &parents,const std::vector<double> &modularity)
+	{
+		_leaves = leaves;
+		_levelOffsets = levelOffsets;
+		_parents = parents;
+		_modularity = modularity;
+	}
+
+	int writeDendrogram(const std::string &fileName) const
+	{
+		BinaryFile::SectionArray arrays[] = {
+			{"leaves",_leaves.data(),(long long)_leaves.size(),sizeof(int),BinaryFile::INT32},
+			{"levelOffsets",_levelOffsets.data(),(long long)_levelOffsets.size(),sizeof(long long),BinaryFile::INT64},
+			{"parents",_parents.data(),(long long)_parents.size(),sizeof(int),BinaryFile::INT32},
+			{"modularity",_modularity.data(),(long long)_modularity.size(),sizeof(double),BinaryFile::FLOAT64}};
+		Header header;
+		memset(&header,0,sizeof(header));
+		memcpy(header.file.magic,"BILVDEND",8);
+		header.file.version = VERSION;
+		header.file.numberSections = sizeof(arrays)/sizeof(arrays[0]);
+		header.numberInputNodes = _leaves.size();
+		header.numberLevels = _modularity.size();
+		header.numberParents = _parents.size();
+		return BinaryFile::writeSectionFile(fileName,&header,sizeof(header),std::vector<BinaryFile::SectionArray>(arrays,arrays+header.file.numberSections));
+	}
+
+	//Maps a dendrogram file read-only. Returns -1 when it is missing or is not a valid dendrogram file.
+	int static mapDendrogram(const std::string &fileName,dendrogramFile &dendrogram)
+	{
+		memset(&dendrogram,0,sizeof(dendrogram));
+		size_t mappingSize = 0;
+		const char* data = BinaryFile::mapSectionFile(fileName,"BILVDEND",VERSION,sizeof(Header),mappingSize,"dendrogram file");
+		if(data == NULL)
+			return -1;
+		const Header* header = (const Header*)data;
+		bool valid = (header->numberLevels >= 0);
+		if(valid)
+		{
+			dendrogram.leaves = (const int*)BinaryFile::findSection(data,mappingSize,sizeof(Header),"leaves",BinaryFile::INT32,header->numberInputNodes);
+			dendrogram.levelOffsets = (const long long*)BinaryFile::findSection(data,mappingSize,sizeof(Header),"levelOffsets",BinaryFile::INT64,header->numberLevels+1);
+			dendrogram.parents = (const int*)BinaryFile::findSection(data,mappingSize,sizeof(Header),"parents",BinaryFile::INT32,header->numberParents);
+			dendrogram.modularity = (const double*)BinaryFile::findSection(data,mappingSize,sizeof(Header),"modularity",BinaryFile::FLOAT64,header->numberLevels);
+			valid = (dendrogram.levelOffsets != NULL)&&(dendrogram.levelOffsets[header->numberLevels] == header->numberParents);
+			valid = valid&&((header->numberInputNodes == 0)||(dendrogram.leaves != NULL))&&((header->numberParents == 0)||(dendrogram.parents != NULL))&&((header->numberLevels == 0)||(dendrogram.modularity != NULL));
+			valid = valid&&validPointers(dendrogram.leaves,header->numberInputNodes,dendrogram.levelOffsets,dendrogram.parents,header->numberLevels);
+		}
+		if(valid == false)
+		{
+			BinaryFile::rejectSectionFile(data,mappingSize,fileName,"dendrogram file");
+			memset(&dendrogram,0,sizeof(dendrogram));
+			return -1;
+		}
+		dendrogram.numberInputNodes = header->numberInputNodes;
+		dendrogram.numberLevels = header->numberLevels;
+		dendrogram.numberParents = header->numberParents;
+		dendrogram.mapping = (void*)data;
+		dendrogram.mappingSize = mappingSize;
+		return 0;
+	}
+
+	static void unmapDendrogram(dendrogramFile &dendrogram)
+	{
+		if(dendrogram.mapping != NULL)
+			munmap(dendrogram.mapping,dendrogram.mappingSize);
+		memset(&dendrogram,0,sizeof(dendrogram));
+	}
+
+	//Community of vertex at level (0..numberLevels) of a mapped dendrogram
+	static int communityAtLevel(const dendrogramFile &dendrogram,int vertex,int level)
+	{
+		return findCommunity(dendrogram.leaves,dendrogram.numberInputNodes,dendrogram.levelOffsets,dendrogram.parents,dendrogram.numberLevels,vertex,level);
+	}
+
+};
+
+#endif /* DENDROGRAM_H_ */
@@ -42,20 +42,62 @@ FuseMethod::FuseMethod():biLouvainMethodMurataPN()
 }
 FuseMethod::~FuseMethod(){}
 
+//Inverted index of the cocluster mates of the communities in [start,end): the communities listing mate m are
+//communities[offsets[m+2],offsets[m+3]), in increasing order. Mates are shifted by 2 because -1 and -2 are also stored.
+void FuseMethod::buildCoClusterMateIndex(int start,int end,std::vector<int> &offsets,std::vector<int> &communities)
+{
+	offsets.assign(_numberCommunities+3,0);
+	#pragma omp parallel for schedule(dynamic,256) num_threads(_numberThreads) if(_numberThreads > 1)
+	for(int i=start;i<end;i++)
+	{
+		IdRange mates = _communities[i].getCoClusterMateCommunityIdRange();
+		for(auto it=mates.begin();it!=mates.end();++it)
+		{
+			#pragma omp atomic
+			offsets[*it+3]++;
+		}
+	}
+	for(unsigned int m=1;m<offsets.size();m++)
+		offsets[m] += offsets[m-1];
+	communities.resize(offsets.back());
+	std::vector<int> next(offsets.begin(),offsets.end()-1);
+	#pragma omp parallel for schedule(dynamic,256) num_threads(_numberThreads) if(_numberThreads > 1)
+	for(int i=start;i<end;i++)
+	{
+		IdRange mates = _communities[i].getCoClusterMateCommunityIdRange();
+		for(auto it=mates.begin();it!=mates.end();++it)
+		{
+			int position;
+			#pragma omp atomic capture
+			position = next[*it+2]++;
+			communities[position] = i;
+		}
+	}
+	#pragma omp parallel for schedule(dynamic,256) num_threads(_numberThreads) if(_numberThreads > 1)
+	for(int m=0;m<(int)offsets.size()-1;m++)
+		std::sort(communities.begin()+offsets[m],communities.begin()+offsets[m+1]);
+}
+
+//Community i is fused with an earlier community j of the same partition. Only the communities that share a cocluster
+//mate with i (found through the index) or, when alpha is 0, that i has similarity to can satisfy the conditions, so
+//only those are visited, in increasing order as in the all-pairs comparison used before.
 int FuseMethod::fuseCommunities(Graph &g,int start,int end, double &lambda)
 {
 	int maxIntersection = 0;
 	int result = 0;
         int key = 0;
-        std::vector<int> a;
-        std::vector<int> b;
-	std::vector<int> c;
+        IdRange a;
 	std::vector<int> coClusterMate;
 	double temp = 0.0, betaFactor = 0.0;
 	double totalModularity = 0.0;
-	int first = 0;
+	std::vector<int> mateOffsets, mateCommunities;
+	std::vector<int> intersections(std::max(end-start,0),0);
+	std::vector<int> candidates;
 	if(_alpha != 0.0)
+	{
 		totalModularity = CoClusterMateDefinitionAllCommunities(g,start,end);
+		buildCoClusterMateIndex(start,end,mateOffsets,mateCommunities);
+	}
 	else
 		totalModularity = IntraTypeDefinitionAllCommunities(g,start,end);
 	for(int i=start;i<end;i++)
@@ -63,41 +105,49 @@ int FuseMethod::fuseCommunities(Graph &g,int start,int end, double &lambda)
 	  maxIntersection = 0;
 	  betaFactor = 0.0;
           key = i;
+	  candidates.clear();
 	  if(_alpha != 0.0)
-	         a =  _communities[i].getCoClusterMateCommunityId();
-          //std::unordered_set<int> c(a.begin(),a.end());
-          for(int j=start;j<i;j++)
+	  {
+		a =  _communities[i].getCoClusterMateCommunityIdRange();
+		for(auto it=a.begin();it!=a.end();++it)
+		{
+			for(int k=mateOffsets[*it+2];(k<mateOffsets[*it+3])&&(mateCommunities[k]<i);k++)
+			{
+				if(intersections[mateCommunities[k]-start]++ == 0)
+					candidates.push_back(mateCommunities[k]);
+			}
+		}
+		sort(candidates.begin(),candidates.end());
+	  }
+	  else
+	  {
+		CommunityIdRange intraTypeNeighbors = g._graph[i].getIntraTypeNeighborCommunitiesRange();
+		for(auto it=intraTypeNeighbors.begin();it!=intraTypeNeighbors.end();++it)
+			if((*it >= start)&&(*it < i))
+				candidates.push_back(*it);
+	  }
+          for(unsigned int c=0;c<candidates.size();c++)
           {
-         	//std::cout << "\nCommunity: " << j << "\t Number Nodes: " << _communities[j].getNumberNodes() << std::endl;
+		int j = candidates[c];
+		int intersection = (_alpha != 0.0) ? intersections[j-start] : 0;
                 if(_communities[j].getNumberNodes()>0) 
 		{
-                	if(_alpha != 0.0)
-				b = _communities[j].getCoClusterMateCommunityId();
-                        //int intersection = std::count_if(b.begin(),b.end(),[&](int k){return c.find(k) != c.end();});
-			//similarityCommunity = calculateCommunitySimilarity(i);	
-			//std::cout << "\nBeta Factor entre: " << key << "\t"<<j<<"\t"<< temp;
 			if((_alpha > 0.0)&&(_alpha < 1.0))
                         {
-				set_intersection(a.begin(),a.end(),b.begin(),b.end(),back_inserter(c));
 				temp = calculateCommunityBetaFactor(g,_communities[j].getDescription(),g._graph[i].getSimilarityToIntraTypeNeighborCommunity(j));
-				if((c.size() > maxIntersection)&&(temp >= lambda)&&(temp>betaFactor))
+				if((intersection > maxIntersection)&&(temp >= lambda)&&(temp>betaFactor))
                         	{
                         		key = j;
-                                	maxIntersection = c.size();
-					coClusterMate.clear();
-					coClusterMate = c;
+                                	maxIntersection = intersection;
 					betaFactor = temp;
 				}
                         }
 			else if(_alpha == 1.0)
 			{
-				set_intersection(a.begin(),a.end(),b.begin(),b.end(),back_inserter(c));
-				if(c.size() > maxIntersection)
+				if(intersection > maxIntersection)
                                 {
                                         key = j;
-                                        maxIntersection = c.size();
-                                        coClusterMate.clear();
-                                        coClusterMate = c;
+                                        maxIntersection = intersection;
                                 }
 			}
 			else
@@ -110,15 +160,20 @@ int FuseMethod::fuseCommunities(Graph &g,int start,int end, double &lambda)
 					//std::cout << "\nCommunity: " << j << "\tBF: " << betaFactor<< "\tTemp: "<< temp << std::endl;
                                 }
 			}
-                        b.clear();
-			c.clear();
-                        //std::cout << "\nCommunity Comparison: " << j << "\t Inter: " << intersection << std::endl;
                 }
          }
-         a.clear();
+	 if(_alpha != 0.0)
+		for(unsigned int c=0;c<candidates.size();c++)
+			intersections[candidates[c]-start] = 0;
          if(key != i) //we have communities to merge
          {
 		result++;
+		if(_alpha != 0.0)
+		{
+			IdRange b = _communities[key].getCoClusterMateCommunityIdRange();
+			coClusterMate.clear();
+			set_intersection(a.begin(),a.end(),b.begin(),b.end(),back_inserter(coClusterMate));
+		}
                 //update communities
 		updateNodeCommunity(g,g._graph[i].getId(),i,key);
 		updateNeighborCommunities(g,g._graph[i].getId(),i,key);
@@ -178,7 +233,8 @@ void FuseMethod::fuseMethodCalculationMF(Graph &g, std::string outputFileName,do
 			finalModularity = fuseMethodInit(g);
                         gettimeofday(&endTime,NULL);
                         fuseTime = (endTime.tv_sec - startTime.tv_sec)*1000000 + (endTime.tv_usec - startTime.tv_usec);
-                        std::cout<<"\n ::: Fuse "<<finalModularity<<"\t"<<initialModularity<<"\t"<<g._lastIdPartitionV1+1<<"\t"<<g._numberNodes-(g._lastIdPartitionV1+1)<<"\t"<<g._numberNodes<<"\t"<<g._numberEdges<<"\t"<<fuseTime<<std::endl;
+                        if(_verbose)
+                                std::cout<<"\n ::: Fuse "<<finalModularity<<"\t"<<initialModularity<<"\t"<<g._lastIdPartitionV1+1<<"\t"<<g._numberNodes-(g._lastIdPartitionV1+1)<<"\t"<<g._numberNodes<<"\t"<<g._numberEdges<<"\t"<<fuseTime<<std::endl;
                 }
         }while((finalModularity - initialModularity) > cutoffFuse);
 	
@@ -186,12 +242,13 @@ void FuseMethod::fuseMethodCalculationMF(Graph &g, std::string outputFileName,do
         std::ofstream outputFile;
         outputFile.open(outputFileName.c_str(),std::ios::out|std::ios::trunc);
         std::vector<int>community;
-        for(int i=0;i<_numberCommunities;i++)
+        for(int i=0;(i<_numberCommunities)&&(outputFileName.empty() == false);i++)
         {
         	if(_communities[i].getNumberNodes()>0)
                 {
-                	for(int j=0;j<g._graph[_communities[i].getNodes()[0]].getNumberNodes();j++)
-                        	initialCommunities << g._graph[_communities[i].getNodes()[0]].getNodesSorted()[j].getIdInput() << ",";
+                	std::vector<Node> sorted = g._graph[*_communities[i].getNodesRange().begin()].getNodesSorted();
+                	for(unsigned int j=0;j<sorted.size();j++)
+                        	initialCommunities << sorted[j].getIdInput() << ",";
                         initialCommunities.seekp(initialCommunities.str().length()-1);
                         initialCommunities << "\n";
                         //std::cout<<initialCommunities.str();
@@ -228,11 +285,12 @@ void FuseMethod::fuseMethodCalculation(Graph &g, std::string outputFileName)
         std::ofstream outputFile;
         outputFile.open(outputFileName.c_str(),std::ios::out|std::ios::trunc);
 	std::vector<int>community;
-	for(int i=0;i<_numberCommunities;i++)
+	for(int i=0;(i<_numberCommunities)&&(outputFileName.empty() == false);i++)
 	{
 		if(_communities[i].getNumberNodes()>0)
 		{
-			community = _communities[i].getNodes();
+			MemberIdRange members = _communities[i].getNodesRange();
+			community.assign(members.begin(),members.end());
 			sort(community.begin(),community.end());
 			for(int j=0;j<_communities[i].getNumberNodes();j++)
 				initialCommunities << community[j] << ",";
@@ -247,7 +305,8 @@ void FuseMethod::fuseMethodCalculation(Graph &g, std::string outputFileName)
 	//printCommunitiesContributionModularity();
         outputFile.close();
 	fromCommunitiesToNodes(g);
-	std::cout<<"\n ::: Fuse "<<g._lastIdPartitionV1+1<<"\t"<<g._numberNodes-(g._lastIdPartitionV1+1)<<"\t"<<g._numberNodes<<std::endl;
+	if(_verbose)
+		std::cout<<"\n ::: Fuse "<<g._lastIdPartitionV1+1<<"\t"<<g._numberNodes-(g._lastIdPartitionV1+1)<<"\t"<<g._numberNodes<<std::endl;
 	//for(int i=0;i<g._numberNodes;i++)
         //        std::cout << g._graph[i].getId()<< "\t" << g._graph[i].getDegreeNode()<<std::endl;
 }
@@ -339,31 +398,42 @@ void FuseMethod::initialCommunityDefinitionProvidedFileMetaNodes(Graph &g,const
 				//std::cout<<nodes[i]<<",";
 				id = stoi(nodes[i]);
 				g._graph[id].setCommunityId(numberCommunities);
-                                nodesInCommunity.push_back(g._graph[id].getNodes()[0]);
+                                nodesInCommunity.push_back(g._graph[id].getNodesReference()[0]);
                         }
 			//std::cout<<"\n";
-			MetaNode metanode(numberCommunities,nodesInCommunity[0].getType(),nodesInCommunity,neighbors,-1);
+			MetaNode metanode(numberCommunities,nodesInCommunity[0].getType(),nodesInCommunity,-1);
                         numberCommunities++;
 			newGraph.push_back(metanode);
                         if(metanode.getType()=="V1")
                                 lastIdPartitionV1++;
                         nodesInCommunity.clear();
                 }
+		std::vector<int> sources, targets;
+		std::vector<double> weights;
 		for(int i=0;i<numberCommunities;i++)
 		{
-			for(int j=0;j<newGraph[i].getNumberNodes();j++)
+			const std::vector<Node> &metanodeNodes = newGraph[i].getNodesReference();
+			for(unsigned int j=0;j<metanodeNodes.size();j++)
 			{
-				for(int k=0; k<g._graph[newGraph[i].getNodes()[j].getIdInput()].getNumberNeighbors();k++)
+				MetaNode &member = g._graph[metanodeNodes[j].getIdInput()];
+				const int* memberNeighbors = member.getNeighborIds();
+				const double* memberWeights = member.getNeighborWeights();
+				for(int k=0; k<member.getNumberNeighbors();k++)
                         	{
-                        		int idNeighbor = g._graph[g._graph[newGraph[i].getNodes()[j].getIdInput()].getNeighbors()[k]].getCommunityId();
+                        		int idNeighbor = g._graph[memberNeighbors[k]].getCommunityId();
 	                                if(neighbors.find(idNeighbor)!= neighbors.end())
-        	                        	neighbors[idNeighbor] += g._graph[newGraph[i].getNodes()[j].getIdInput()].getWeightNeighbor(g._graph[newGraph[i].getNodes()[j].getIdInput()].getNeighbors()[k]);
+        	                        	neighbors[idNeighbor] += memberWeights[k];
                 	                else
-                                	        neighbors[idNeighbor] = g._graph[newGraph[i].getNodes()[j].getIdInput()].getWeightNeighbor(g._graph[newGraph[i].getNodes()[j].getIdInput()].getNeighbors()[k]);
+                                	        neighbors[idNeighbor] = memberWeights[k];
                         	        //std::cout << "Neighbor:" << idNeighbor << "  Weight: " << neighbors[idNeighbor] << std::endl;
 				}
                         }
-			newGraph[i].setNeighbors(neighbors);
+			for(auto it=neighbors.begin();it!=neighbors.end();++it)
+			{
+				sources.push_back(i);
+				targets.push_back(it->first);
+				weights.push_back(it->second);
+			}
 			neighbors.clear();
 		}
                 delete[] nodes;
@@ -371,9 +441,13 @@ void FuseMethod::initialCommunityDefinitionProvidedFileMetaNodes(Graph &g,const
 		MetaNode*_newGraph = new MetaNode[numberCommunities];
 		for(int i=0;i<numberCommunities;i++)
 			_newGraph[i] = newGraph[i];
-		Graph compactedGraph(_newGraph,numberCommunities,g._numberEdges,g._weightEdges,g._weightEdgesV1,g._weightEdgesV2,lastIdPartitionV1);
-		g.destroyGraph();
+		CSRAdjacency compactedAdjacency(numberCommunities);
+		compactedAdjacency.buildNeighbors(numberCommunities,sources,targets,weights);
+		g._adjacency->swap(compactedAdjacency);
+		Graph compactedGraph(_newGraph,g._adjacency,numberCommunities,g._numberEdges,g._weightEdges,g._weightEdgesV1,g._weightEdgesV2,lastIdPartitionV1);
+		delete[] g._graph;
 	        g = compactedGraph;
+		g.bindAdjacency();
 		std::cout<<g._lastIdPartitionV1+1<<"\t"<<g._numberNodes-(g._lastIdPartitionV1+1)<<"\t"<<g._numberNodes<<std::endl;
                 //for(int i=0;i<g._numberNodes;i++)
                 //      std::cout << g._graph[i].getId()<< "\t" << g._graph[i].getDegreeNode()<<std::endl;
@@ -385,6 +459,20 @@ void FuseMethod::initialCommunityDefinitionProvidedFileMetaNodes(Graph &g,const
         }
 }
 
+//Fuse without the _InitialCommunities.txt file: the fused communities are neither read from nor written to disk
+void FuseMethod::fuseMethodMemory(Graph &g,double &alpha,double cf)
+{
+	_alpha = alpha;
+	struct timeval startTime,endTime;
+	gettimeofday(&startTime,NULL);
+	if(cf == 1.0)
+		fuseMethodCalculation(g,"");
+	else
+		fuseMethodCalculationMF(g,"",cf);
+	gettimeofday(&endTime,NULL);
+	fusingTime = (endTime.tv_sec - startTime.tv_sec)*1000000 + (endTime.tv_usec - startTime.tv_usec);
+}
+
 void FuseMethod::fuseMethodFile(Graph &g,const std::string &inputFileName,double &alpha, double cf)
 {
 	//std::vector<double> communitiesBetaFactor;
@@ -54,8 +54,10 @@ class FuseMethod : public biLouvainMethodMurataPN
 		void initialCommunityDefinitionProvidedFileCommunities(Graph &g,const std::string &initialCommunitiesFileName, double &alpha);
 		void initialCommunityDefinitionProvidedFileMetaNodes(Graph &g,const std::string &initialCommunitiesFileName, double &alpha);
 		void fuseMethodFile(Graph &g,const std::string &inputFileName,double &alpha,double cf);
+		void fuseMethodMemory(Graph &g,double &alpha,double cf);
 
 	private:
+		void buildCoClusterMateIndex(int start,int end,std::vector<int> &offsets,std::vector<int> &communities);
 		int fuseCommunities(Graph &g,int start,int end,double &lambda);
                 void fuseMethodCalculation(Graph &g, std::string outputFileName);
 		void fuseMethodCalculationMF(Graph &g, std::string outputFileName,double cf);
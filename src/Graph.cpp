@@ -35,11 +35,11 @@
 
 //Class constructor
 Graph::Graph()
-		:_graph(NULL),_numberNodes(0),_numberEdges(0),_weightEdges(0.0),_weightEdgesV1(0.0),_weightEdgesV2(0.0),_lastIdPartitionV1(0),_lambdaV1(0.0),_lambdaV2(0.0),_sumSimilarityV1(0.0),_sumSimilarityV2(0.0)
+		:_graph(NULL),_adjacency(NULL),_numberNodes(0),_numberEdges(0),_weightEdges(0.0),_weightEdgesV1(0.0),_weightEdgesV2(0.0),_lastIdPartitionV1(0),_lambdaV1(0.0),_lambdaV2(0.0),_sumSimilarityV1(0.0),_sumSimilarityV2(0.0)
 {}
 
-Graph::Graph(MetaNode* &graph,int &numberNodes,int &numberEdges,double &weightEdges,double &weightEdgesV1,double &weightEdgesV2,int &lastIdPartitionV1)
-		:_graph(graph),_numberNodes(numberNodes),_numberEdges(numberEdges),_weightEdges(weightEdges),_weightEdgesV1(weightEdgesV1),_weightEdgesV2(weightEdgesV2),_lastIdPartitionV1(lastIdPartitionV1),_lambdaV1(0.0),_lambdaV2(0.0),_sumSimilarityV1(0.0),_sumSimilarityV2(0.0)
+Graph::Graph(MetaNode* &graph,CSRAdjacency* &adjacency,int &numberNodes,int &numberEdges,double &weightEdges,double &weightEdgesV1,double &weightEdgesV2,int &lastIdPartitionV1)
+		:_graph(graph),_adjacency(adjacency),_numberNodes(numberNodes),_numberEdges(numberEdges),_weightEdges(weightEdges),_weightEdgesV1(weightEdgesV1),_weightEdgesV2(weightEdgesV2),_lastIdPartitionV1(lastIdPartitionV1),_lambdaV1(0.0),_lambdaV2(0.0),_sumSimilarityV1(0.0),_sumSimilarityV2(0.0)
 {}
 
 //Class destructor
@@ -59,6 +59,11 @@ MetaNode Graph::getNode(const int &nodeId)
 	return _graph[nodeId];		
 }
 
+CSRAdjacency* Graph::getAdjacency()
+{
+	return _adjacency;
+}
+
 int Graph::getNumberNodes()
 {
 	return _numberNodes;
@@ -130,9 +135,70 @@ void Graph::setSimilarityV2(double sumSimilarityV2)
         _sumSimilarityV2 = sumSimilarityV2;
 }
 
+//The intra-type neighbors are staged and only become visible after buildIntraTypeNeighbors
 void Graph::addIntraTypeNeighborsToNode(int &nodeId,std::tr1::unordered_map<int,double> &intraTypeNeighbors)
 {
-	_graph[nodeId].setIntraTypeNeighbors(intraTypeNeighbors);
+	_adjacency->addIntraTypeNeighborsToNode(nodeId,intraTypeNeighbors);
+}
+
+void Graph::buildIntraTypeNeighbors()
+{
+	_adjacency->buildPendingIntraTypeNeighbors();
+	bindAdjacency();
+}
+
+//Adds the (source,target,weight) entries to the intra-type rows without staging them
+void Graph::buildIntraTypeNeighbors(const std::vector<int> &sources,const std::vector<int> &targets,const std::vector<double> &weights)
+{
+	_adjacency->buildIntraTypeNeighbors(sources,targets,weights);
+	bindAdjacency();
+}
+
+//Points every metanode to its rows in the CSR arrays. Needed after any rebuild of _adjacency.
+void Graph::bindAdjacency()
+{
+	for(int i=0;i<_numberNodes;i++)
+	{
+		_graph[i].setNeighbors(_adjacency->getNeighbors(i),_adjacency->getWeights(i),_adjacency->getNumberNeighbors(i));
+		_graph[i].setIntraTypeNeighbors(_adjacency->getIntraTypeNeighbors(i),_adjacency->getIntraTypeWeights(i),_adjacency->getNumberIntraTypeNeighbors(i));
+	}
+}
+
+//Greedy distance-2 coloring over the bipartite and intra-type edges: two metanodes get different colors when they are
+//neighbors or share a neighbor. Returns the number of colors; the color of every metanode is kept in the metanode.
+int Graph::colorGraph()
+{
+	std::vector<int> forbidden;
+	for(int i=0;i<_numberNodes;i++)
+		_graph[i].setColor(-1);
+	for(int i=0;i<_numberNodes;i++)
+	{
+		IdRange ranges[2] = {_graph[i].getNeighborsRange(),_graph[i].getIntraTypeNeighborsRange()};
+		for(int r=0;r<2;r++)
+		{
+			for(auto it=ranges[r].begin();it!=ranges[r].end();++it)
+			{
+				int color = _graph[*it].getColor();
+				if(color >= 0)forbidden[color] = i;
+				IdRange secondRanges[2] = {_graph[*it].getNeighborsRange(),_graph[*it].getIntraTypeNeighborsRange()};
+				for(int s=0;s<2;s++)
+				{
+					for(auto jt=secondRanges[s].begin();jt!=secondRanges[s].end();++jt)
+					{
+						color = _graph[*jt].getColor();
+						if(color >= 0)forbidden[color] = i;
+					}
+				}
+			}
+		}
+		int color = 0;
+		while((color < (int)forbidden.size())&&(forbidden[color] == i))
+			color++;
+		if(color == (int)forbidden.size())
+			forbidden.push_back(-1);
+		_graph[i].setColor(color);
+	}
+	return forbidden.size();
 }
 
 void Graph::printNeighborsNode(int id)
@@ -141,16 +207,17 @@ void Graph::printNeighborsNode(int id)
 	{
 		if(_graph[i].getId()==id)
 		{
-			if(_graph[i].getNeighbors().empty())
+			IdRange neighbors = _graph[i].getNeighborsRange();
+			if(neighbors.empty())
 			{
 				printf("Node %d doesn't have neighbors \n", id);
 			}
 			else
 			{
 				printf("\nNode ID: %d \n", _graph[i].getId());
-				for (int j = 0; j < _graph[i].getNumberNeighbors(); j++)
+				for(auto it=neighbors.begin();it!=neighbors.end();++it)
 				{
-					printf("Neighbor ID: %d \n",_graph[i].getNeighbors()[j]);
+					printf("Neighbor ID: %d \n",*it);
 				}
 			}
 			break;
@@ -182,4 +249,5 @@ void Graph::printGraph(const std::string &inputFileName)
 void Graph::destroyGraph()
 {
 	delete[] _graph;
+	delete _adjacency;
 }
@@ -42,6 +42,7 @@
 
 #include "Header.h"
 #include "MetaNode.h"
+#include "CSRAdjacency.h"
 
 class Graph
 {
@@ -51,6 +52,7 @@ class Graph
 
 	protected:
 		MetaNode* _graph;
+		CSRAdjacency* _adjacency;
 		int _numberNodes;
 		int _numberEdges;
 		double _weightEdges;
@@ -67,11 +69,12 @@ class Graph
 	public:
 		//Class constructor
 		Graph();
-		Graph(MetaNode* &graph,int &numberNodes,int &numberEdges,double &weightEdges,double &weightEdgesV1,double &weightEdgesV2,int &lastIdPartitionV1);
+		Graph(MetaNode* &graph,CSRAdjacency* &adjacency,int &numberNodes,int &numberEdges,double &weightEdges,double &weightEdgesV1,double &weightEdgesV2,int &lastIdPartitionV1);
 		//Class destructor
 		~Graph();
 		MetaNode* getGraph();
 		MetaNode getNode(const int &nodeId);
+		CSRAdjacency* getAdjacency();
 		int getNumberNodes();
 		int getLastIdPartitionV1();
 		int getNumberEdges();
@@ -90,6 +93,10 @@ class Graph
 		void setSimilarityV2(double sumSImilarityV2);
 		void setNumberCoClusters(int number);
 		void addIntraTypeNeighborsToNode(int &nodeId,std::tr1::unordered_map<int,double> &intraTypeNeighbors);
+		void buildIntraTypeNeighbors();
+		void buildIntraTypeNeighbors(const std::vector<int> &sources,const std::vector<int> &targets,const std::vector<double> &weights);
+		void bindAdjacency();
+		int colorGraph();
 		void printNeighborsNode(int nodeId);
 		void printGraph(const std::string &inputFileName);
 		void destroyGraph();
@@ -0,0 +1,275 @@
+// **************************************************************************************************
+// biLouvain: A C++ library for bipartite graph community detection
+// Paola Gabriela Pesantez-Cabrera, Ananth Kalyanaraman
+//      (p.pesantezcabrera@wsu.edu, ananth@eecs.wsu.edu)
+// Washington State University
+//
+// For citation, please cite the following paper:
+// Pesantez, Paola and Kalyanaraman, Ananth, "Detecting Communities in Biological
+// Bipartite Networks," Proc. ACM Conference on Bioinformatics, Computational Biology,
+// and Health Informatics (ACM-BCB), Seattle, WA, October 2-5, 2016, In press,
+// DOI: http://dx.doi.org/10.1145/2975167.2975177.
+//
+// **************************************************************************************************
+// Copyright (c) 2016. Washington State University ("WSU"). All Rights Reserved.
+// Permission to use, copy, modify, and distribute this software and its documentation
+// for educational, research, and not-for-profit purposes, without fee, is hereby
+// granted, provided that the above copyright notice, this paragraph and the following
+// two paragraphs appear in all copies, modifications, and distributions. For
+// commercial licensing opportunities, please contact The Office of Commercialization,
+// WSU, 280/286 Lighty, PB Box 641060, Pullman, WA 99164, (509) 335-5526,
+// commercialization@wsu.edu<mailto:commercialization@wsu.edu>, https://commercialization.wsu.edu/
+
+// IN NO EVENT SHALL WSU BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT, SPECIAL, INCIDENTAL,
+// OR CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF
+// THIS SOFTWARE AND ITS DOCUMENTATION, EVEN IF WSU HAS BEEN ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// WSU SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. THE SOFTWARE AND
+// ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS PROVIDED "AS IS". WSU HAS NO
+// OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+// **************************************************************************************************
+
+/*
+# GraphSnapshot.h
+# Binary snapshot of a loaded bipartite graph: the CSR arrays, the V1/V2 split, the total weights and, when they
+# were loaded, the intra-type similarity rows. A snapshot is written once and later memory mapped read-only, so
+# the graph does not need to be parsed again. The similarity rows are tied to the matrix files they were read from
+# (name, size and modification time); when they no longer match the current files the rows are not used.
+*/
+
+#ifndef GRAPHSNAPSHOT_H_
+#define GRAPHSNAPSHOT_H_
+#include "Header.h"
+#include "BinaryFile.h"
+#include "Graph.h"
+#include "LoadGraph.h"
+
+class GraphSnapshot
+{
+  private:
+	static const int VERSION = 2;
+	static const int HAS_SIMILARITY = 1;
+
+	//Identifies the similarity matrix file of one set of vertices; all zeros when there was none
+	struct SimilarityFile
+	{
+		unsigned long long nameHash;
+		long long size;
+		long long modificationSeconds;
+		long long modificationNanoseconds;
+	};
+
+	struct Header
+	{
+		char magic[8];
+		int version;
+		int flags;
+		long long numberNodes;
+		long long numberEdges;
+		long long lastIdPartitionV1;
+		long long numberEntries;
+		long long numberIntraTypeEntries;
+		double weightEdges;
+		double weightEdgesV1;
+		double weightEdgesV2;
+		double lambdaV1;
+		double lambdaV2;
+		double sumSimilarityV1;
+		double sumSimilarityV2;
+		SimilarityFile similarityFiles[2];
+	};
+
+	static SimilarityFile describeSimilarityFile(const std::string &fileName)
+	{
+		SimilarityFile description;
+		memset(&description,0,sizeof(description));
+		struct stat fileStat;
+		if(fileName.empty()||(stat(fileName.c_str(),&fileStat) != 0))
+			return description;
+		//FNV-1a of the file name
+		description.nameHash = 14695981039346656037ULL;
+		for(unsigned int i=0;i<fileName.size();i++)
+			description.nameHash = (description.nameHash ^ (unsigned char)fileName[i])*1099511628211ULL;
+		description.size = fileStat.st_size;
+		description.modificationSeconds = fileStat.st_mtim.tv_sec;
+		description.modificationNanoseconds = fileStat.st_mtim.tv_nsec;
+		return description;
+	}
+
+	//Rows of numberNodes nodes: offsets start at 0, do not decrease and end at numberEntries, and every neighbor is a node
+	//of the other set of vertices (of the same set for the intra-type rows)
+	static bool validRows(const int* offsets,const int* neighbors,int numberNodes,long long numberEntries,int lastIdPartitionV1,bool sameSet)
+	{
+		if((offsets[0] != 0)||(offsets[numberNodes] != numberEntries))
+			return false;
+		for(int i=0;i<numberNodes;i++)
+		{
+			if(offsets[i+1] < offsets[i])
+				return false;
+			for(int k=offsets[i];k<offsets[i+1];k++)
+			{
+				if((neighbors[k] < 0)||(neighbors[k] >= numberNodes))
+					return false;
+				if(((i <= lastIdPartitionV1) == (neighbors[k] <= lastIdPartitionV1)) != sameSet)
+					return false;
+			}
+		}
+		return true;
+	}
+
+  public:
+
+	//Writes the graph as it is right after loading (one metanode per node). similarityFiles are the V1 and V2 matrix
+	//files its similarity rows were read from ("" for none).
+	int static writeGraphSnapshot(Graph &g,const std::string &snapshotFileName,const std::vector<std::string> &similarityFiles)
+	{
+		std::ofstream outputFile(snapshotFileName.c_str(),std::ios::out|std::ios::binary|std::ios::trunc);
+		if(outputFile.is_open() == false)
+			return -1;
+		CSRAdjacency* adjacency = g.getAdjacency();
+		int numberNodes = g.getNumberNodes();
+		Header header;
+		memset(&header,0,sizeof(header));
+		memcpy(header.magic,"BILVSNAP",8);
+		header.version = VERSION;
+		header.numberNodes = numberNodes;
+		header.numberEdges = g.getNumberEdges();
+		header.lastIdPartitionV1 = g.getLastIdPartitionV1();
+		header.numberEntries = adjacency->getNumberEntries();
+		header.numberIntraTypeEntries = adjacency->getNumberIntraTypeEntries();
+		if(header.numberIntraTypeEntries > 0)
+			header.flags |= HAS_SIMILARITY;
+		header.weightEdges = g.getWeightEdges();
+		header.weightEdgesV1 = g.getWeightEdgesV1();
+		header.weightEdgesV2 = g.getWeightEdgesV2();
+		header.lambdaV1 = g.getLambdaV1();
+		header.lambdaV2 = g.getLambdaV2();
+		header.sumSimilarityV1 = g.getSimilarityV1();
+		header.sumSimilarityV2 = g.getSimilarityV2();
+		for(unsigned int k=0;(k<2)&&(k<similarityFiles.size());k++)
+			header.similarityFiles[k] = describeSimilarityFile(similarityFiles[k]);
+		BinaryFile::writeArray(outputFile,&header,sizeof(header));
+		BinaryFile::writeArray(outputFile,adjacency->getOffsets(),(numberNodes+1)*sizeof(int));
+		BinaryFile::writeArray(outputFile,adjacency->getNeighbors(0),header.numberEntries*sizeof(int));
+		BinaryFile::writeArray(outputFile,adjacency->getWeights(0),header.numberEntries*sizeof(double));
+		if(header.flags & HAS_SIMILARITY)
+		{
+			BinaryFile::writeArray(outputFile,adjacency->getIntraTypeOffsets(),(numberNodes+1)*sizeof(int));
+			BinaryFile::writeArray(outputFile,adjacency->getIntraTypeNeighbors(0),header.numberIntraTypeEntries*sizeof(int));
+			BinaryFile::writeArray(outputFile,adjacency->getIntraTypeWeights(0),header.numberIntraTypeEntries*sizeof(double));
+		}
+		outputFile.close();
+		return outputFile.fail() ? -1 : 0;
+	}
+
+	//Maps the snapshot and builds the graph on top of it. The similarity rows are used only when withSimilarity is
+	//set and, when similarityFiles (the current V1 and V2 matrix files) are given, they are the files the rows were
+	//read from, unchanged; hasSimilarity tells whether they were used. Returns -1 when the file is missing or is not
+	//a valid snapshot, rows included, so that the graph is parsed again.
+	int static loadGraphSnapshot(Graph* &g,const std::string &snapshotFileName,bool withSimilarity,const std::vector<std::string> &similarityFiles,bool &hasSimilarity)
+	{
+		hasSimilarity = false;
+		int file = open(snapshotFileName.c_str(),O_RDONLY);
+		if(file < 0)
+			return -1;
+		struct stat fileStat;
+		if((fstat(file,&fileStat) != 0)||((size_t)fileStat.st_size < sizeof(Header)))
+		{
+			close(file);
+			return -1;
+		}
+		size_t mappingSize = fileStat.st_size;
+		void* mapping = mmap(NULL,mappingSize,PROT_READ,MAP_PRIVATE,file,0);
+		close(file);
+		if(mapping == MAP_FAILED)
+			return -1;
+		const char* data = (const char*)mapping;
+		const Header* header = (const Header*)data;
+		//The counts are checked before they size anything
+		bool valid = (header->numberNodes >= 0)&&(header->numberNodes < std::numeric_limits<int>::max())&&(header->numberEntries >= 0)&&(header->numberEntries <= std::numeric_limits<int>::max())&&(header->numberIntraTypeEntries >= 0)&&(header->numberIntraTypeEntries <= std::numeric_limits<int>::max())&&(header->lastIdPartitionV1 >= -1)&&(header->lastIdPartitionV1 < header->numberNodes);
+		if((valid == false)||(memcmp(header->magic,"BILVSNAP",8) != 0)||(header->version != VERSION))
+		{
+			printf("\n ::: %s is not a valid graph snapshot :::",snapshotFileName.c_str());
+			munmap(mapping,mappingSize);
+			return -1;
+		}
+		size_t offsetsSize = BinaryFile::alignedSize((header->numberNodes+1)*sizeof(int));
+		size_t expectedSize = BinaryFile::alignedSize(sizeof(Header)) + offsetsSize + BinaryFile::alignedSize(header->numberEntries*sizeof(int)) + BinaryFile::alignedSize(header->numberEntries*sizeof(double));
+		if(header->flags & HAS_SIMILARITY)
+			expectedSize += offsetsSize + BinaryFile::alignedSize(header->numberIntraTypeEntries*sizeof(int)) + BinaryFile::alignedSize(header->numberIntraTypeEntries*sizeof(double));
+		if(expectedSize == mappingSize)
+		{
+			size_t position = BinaryFile::alignedSize(sizeof(Header));
+			const int* offsets = (const int*)(data + position);
+			const int* neighbors = (const int*)(data + position + offsetsSize);
+			valid = validRows(offsets,neighbors,header->numberNodes,header->numberEntries,header->lastIdPartitionV1,false);
+			if(valid&&(header->flags & HAS_SIMILARITY))
+			{
+				position += offsetsSize + BinaryFile::alignedSize(header->numberEntries*sizeof(int)) + BinaryFile::alignedSize(header->numberEntries*sizeof(double));
+				offsets = (const int*)(data + position);
+				neighbors = (const int*)(data + position + offsetsSize);
+				valid = validRows(offsets,neighbors,header->numberNodes,header->numberIntraTypeEntries,header->lastIdPartitionV1,true);
+			}
+		}
+		if((valid == false)||(expectedSize != mappingSize))
+		{
+			printf("\n ::: %s is not a valid graph snapshot :::",snapshotFileName.c_str());
+			munmap(mapping,mappingSize);
+			return -1;
+		}
+		int _numberNodes = header->numberNodes;
+		int _numberEdges = header->numberEdges;
+		int _lastIdPartitionV1 = header->lastIdPartitionV1;
+		double _weightEdges = header->weightEdges;
+		double _weightEdgesV1 = 0.0;
+		double _weightEdgesV2 = 0.0;
+		size_t position = BinaryFile::alignedSize(sizeof(Header));
+		const int* offsets = (const int*)(data + position);
+		position += offsetsSize;
+		const int* neighbors = (const int*)(data + position);
+		position += BinaryFile::alignedSize(header->numberEntries*sizeof(int));
+		const double* weights = (const double*)(data + position);
+		position += BinaryFile::alignedSize(header->numberEntries*sizeof(double));
+		const int* intraTypeOffsets = NULL;
+		const int* intraTypeNeighbors = NULL;
+		const double* intraTypeWeights = NULL;
+		if((header->flags & HAS_SIMILARITY)&&withSimilarity&&(similarityFiles.empty() == false))
+		{
+			for(unsigned int k=0;k<2;k++)
+			{
+				SimilarityFile current = describeSimilarityFile((k < similarityFiles.size()) ? similarityFiles[k] : "");
+				if(memcmp(&current,&header->similarityFiles[k],sizeof(current)) != 0)
+					withSimilarity = false;
+			}
+			if(withSimilarity == false)
+				printf("\n ::: The similarity rows of %s were not read from the current similarity matrices, they are not used :::",snapshotFileName.c_str());
+		}
+		if((header->flags & HAS_SIMILARITY)&&withSimilarity)
+		{
+			intraTypeOffsets = (const int*)(data + position);
+			position += offsetsSize;
+			intraTypeNeighbors = (const int*)(data + position);
+			position += BinaryFile::alignedSize(header->numberIntraTypeEntries*sizeof(int));
+			intraTypeWeights = (const double*)(data + position);
+			hasSimilarity = true;
+		}
+		CSRAdjacency* _adjacency = new CSRAdjacency();
+		_adjacency->mapRows(mapping,mappingSize,_numberNodes,offsets,neighbors,weights,intraTypeOffsets,intraTypeNeighbors,intraTypeWeights);
+		MetaNode* _graph = LoadGraph::createMetaNodes(_adjacency,_numberNodes,_lastIdPartitionV1,_weightEdgesV1,_weightEdgesV2);
+		g = new Graph(_graph,_adjacency,_numberNodes,_numberEdges,_weightEdges,_weightEdgesV1,_weightEdgesV2,_lastIdPartitionV1);
+		if(hasSimilarity)
+		{
+			g->setLambdaV1(header->lambdaV1);
+			g->setLambdaV2(header->lambdaV2);
+			g->setSimilarityV1(header->sumSimilarityV1);
+			g->setSimilarityV2(header->sumSimilarityV2);
+			g->bindAdjacency();
+		}
+		return 0;
+	}
+
+};
+
+#endif /* GRAPHSNAPSHOT_H_ */
@@ -38,9 +38,12 @@
 
 
 #include <sys/resource.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include <algorithm>
 #include <cassert>
 #include <cstdlib>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <fstream>
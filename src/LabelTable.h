@@ -0,0 +1,114 @@
+// **************************************************************************************************
+// biLouvain: A C++ library for bipartite graph community detection
+// Paola Gabriela Pesantez-Cabrera, Ananth Kalyanaraman
+//      (p.pesantezcabrera@wsu.edu, ananth@eecs.wsu.edu)
+// Washington State University
+//
+// For citation, please cite the following paper:
+// Pesantez, Paola and Kalyanaraman, Ananth, "Detecting Communities in Biological
+// Bipartite Networks," Proc. ACM Conference on Bioinformatics, Computational Biology,
+// and Health Informatics (ACM-BCB), Seattle, WA, October 2-5, 2016, In press,
+// DOI: http://dx.doi.org/10.1145/2975167.2975177.
+//
+// **************************************************************************************************
+// Copyright (c) 2016. Washington State University ("WSU"). All Rights Reserved.
+// Permission to use, copy, modify, and distribute this software and its documentation
+// for educational, research, and not-for-profit purposes, without fee, is hereby
+// granted, provided that the above copyright notice, this paragraph and the following
+// two paragraphs appear in all copies, modifications, and distributions. For
+// commercial licensing opportunities, please contact The Office of Commercialization,
+// WSU, 280/286 Lighty, PB Box 641060, Pullman, WA 99164, (509) 335-5526,
+// commercialization@wsu.edu<mailto:commercialization@wsu.edu>, https://commercialization.wsu.edu/
+
+// IN NO EVENT SHALL WSU BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT, SPECIAL, INCIDENTAL,
+// OR CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF
+// THIS SOFTWARE AND ITS DOCUMENTATION, EVEN IF WSU HAS BEEN ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// WSU SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. THE SOFTWARE AND
+// ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS PROVIDED "AS IS". WSU HAS NO
+// OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+// **************************************************************************************************
+
+
+/*
+# LabelTable.h
+# Interns the string labels of the raw input: every distinct label is copied once into a contiguous arena and gets
+# the index of its first appearance. Lookups hash the bytes in place, so no temporary std::string is built per field.
+*/
+
+#ifndef LABELTABLE_H_
+#define LABELTABLE_H_
+
+#include "Header.h"
+
+class LabelTable
+{
+	private:
+		std::vector<char> _arena;
+		std::vector<size_t> _starts;		//label i is _arena[_starts[i],_starts[i+1])
+		std::vector<unsigned int> _hashes;
+		std::vector<int> _slots;		//open addressing over label indices, -1 when empty
+		unsigned int _mask;
+
+		static unsigned int hash(const char* label,int length)
+		{
+			unsigned int value = 2166136261u;		//FNV-1a
+			for(int i=0;i<length;i++)
+			{
+				value ^= (unsigned char)label[i];
+				value *= 16777619u;
+			}
+			return value;
+		}
+
+		void grow()
+		{
+			std::vector<int> slots(_slots.size()*2,-1);
+			unsigned int mask = slots.size()-1;
+			for(unsigned int i=0;i<_hashes.size();i++)
+			{
+				unsigned int slot = _hashes[i] & mask;
+				while(slots[slot] != -1)
+					slot = (slot+1) & mask;
+				slots[slot] = i;
+			}
+			_slots.swap(slots);
+			_mask = mask;
+		}
+
+	public:
+		LabelTable():_slots(1024,-1),_mask(1023)
+		{
+			_starts.push_back(0);
+		}
+
+		int size() const {return _hashes.size();}
+		const char* getLabel(int index) const {return _arena.data() + _starts[index];}
+		int getLength(int index) const {return _starts[index+1] - _starts[index];}
+
+		//Returns the index of the label, adding it when it was not seen before
+		int intern(const char* label,int length)
+		{
+			unsigned int value = hash(label,length);
+			unsigned int slot = value & _mask;
+			while(_slots[slot] != -1)
+			{
+				int index = _slots[slot];
+				if((_hashes[index] == value)&&(getLength(index) == length)&&(memcmp(getLabel(index),label,length) == 0))
+					return index;
+				slot = (slot+1) & _mask;
+			}
+			int index = _hashes.size();
+			_slots[slot] = index;
+			_hashes.push_back(value);
+			_arena.insert(_arena.end(),label,label+length);
+			_starts.push_back(_arena.size());
+			if(_hashes.size()*2 > _slots.size())
+				grow();
+			return index;
+		}
+};
+
+#endif /* LABELTABLE_H_ */
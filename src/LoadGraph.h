@@ -41,23 +41,93 @@
 #include "StringSplitter.h"
 #include "Node.h"
 #include "MetaNode.h"
+#include "CSRAdjacency.h"
 
 class LoadGraph
 {
+  private:
+	static const int BLOCK_SIZE = 64 << 20;		//bytes read from the input file at a time
+
+	//Parses the edge lines in [begin,end). Both directions of every edge are appended, in file order, to sources,
+	//targets and weights. Returns the number of lines that do not have three tab separated columns.
+	int static parseEdges(const char* begin,const char* end,std::vector<int> &sources,std::vector<int> &targets,std::vector<double> &weights,int &maximumId,int &lastIdPartitionV1)
+	{
+		int malformedLines = 0;
+		const char* p = begin;
+		while(p < end)
+		{
+			const char* lineEnd = (const char*)memchr(p,'\n',end-p);
+			if(lineEnd == NULL)lineEnd = end;
+			if((p < lineEnd)&&(*p != '#')&&(*p != '\r'))	//because some inputs can contain informative lines starting with #
+			{
+				const char* firstTab = (const char*)memchr(p,'\t',lineEnd-p);
+				const char* secondTab = (firstTab == NULL) ? NULL : (const char*)memchr(firstTab+1,'\t',lineEnd-(firstTab+1));
+				if(secondTab == NULL)
+					malformedLines++;
+				else
+				{
+					int source = 0;
+					int target = 0;
+					double weight = 0.0;
+					StringSplitter::parseInt(p,firstTab,source);
+					StringSplitter::parseInt(firstTab+1,secondTab,target);
+					StringSplitter::parseDouble(secondTab+1,lineEnd,weight);
+					sources.push_back(source);
+					targets.push_back(target);
+					weights.push_back(weight);
+					sources.push_back(target);
+					targets.push_back(source);
+					weights.push_back(weight);
+					if(target > maximumId)
+						maximumId = target;
+					if(source > lastIdPartitionV1)
+						lastIdPartitionV1 = source;
+				}
+			}
+			p = lineEnd + 1;
+		}
+		return malformedLines;
+	}
+
   public:
 
 
-	//Read the bipartite graph from the input file input by the user
-	int static loadBipartiteGraphFromFile(Graph* &g,std::string &inputFileName)
+	//Creates one metanode (with one node) per row of the adjacency and adds up the degree of each partition
+	static MetaNode* createMetaNodes(CSRAdjacency* adjacency,int numberNodes,int lastIdPartitionV1,double &weightEdgesV1,double &weightEdgesV2)
+	{
+		MetaNode* _graph = new MetaNode[numberNodes];
+		std::vector<Node> nodeV;
+		for(int i=0;i<numberNodes;i++)   //Creation of metanodes and nodes
+		{					
+			if(i<=lastIdPartitionV1)	//Create nodes belonging to set V1
+			{	Node node(i,"V1",0);
+				nodeV.push_back(node);
+				MetaNode metanode(i,"V1",nodeV,-1);
+				_graph[i] = metanode;
+				_graph[i].setNeighbors(adjacency->getNeighbors(i),adjacency->getWeights(i),adjacency->getNumberNeighbors(i));
+				weightEdgesV1 += _graph[i].getDegreeNode();
+				nodeV.clear();
+			}
+			else				//Create nodes belonging to set V2
+			{	Node node(i,"V2",0);	
+				nodeV.push_back(node);
+				MetaNode metanode(i,"V2",nodeV,-1);
+				_graph[i] = metanode;
+				_graph[i].setNeighbors(adjacency->getNeighbors(i),adjacency->getWeights(i),adjacency->getNumberNeighbors(i));
+				weightEdgesV2 += _graph[i].getDegreeNode();
+				nodeV.clear();
+			}
+		}
+		return _graph;
+	}
+
+	//Read the bipartite graph from the input file input by the user. The file is read once, in blocks; every block is
+	//cut at line boundaries into one chunk per thread and the chunks are parsed in parallel into per-thread buffers that
+	//are appended in file order, so the graph does not depend on the number of threads.
+	int static loadBipartiteGraphFromFile(Graph* &g,std::string &inputFileName,int numberThreads = 1)
 	{
-		MetaNode* _graph = NULL;
-		int _numberNodes = 0;
-		int _numberEdges = 0;
-		double _weightEdges = 0.0;
-		double _weightEdgesV1 = 0.0;
-		double _weightEdgesV2 = 0.0;
 		int _lastIdPartitionV1 = 0;
-		std::ifstream inputFile(inputFileName.c_str());
+		std::ifstream inputFile(inputFileName.c_str(),std::ios::in|std::ios::binary);
 		bool is_good = true;
 		int result;
 
@@ -68,83 +138,123 @@ class LoadGraph
 		}
 		if(is_good)						//If the file has been found
 		{
-			std::string line = "";
-                        getline(inputFile,line);
-                        int location = line.find("\t");
-                        if(location == std::string::npos)
-                        {
-                                printf("\n ::: The bipartite file should be tab delimited :::\n");
-                        	exit(EXIT_FAILURE);
-			}
-			//Getting the maximum id which will indicate us the number of nodes in the bipartite graph
-			inputFile.clear();
-                        inputFile.seekg(0, std::ios::beg);
+			if(numberThreads < 1)numberThreads = 1;
 			int maximumId = 0;
-			int items = 0;
-			std::string* pieces;
-			while(inputFile.good())				//read line by line
+			int malformedLines = 0;
+			std::vector<int> sources;
+			std::vector<int> targets;
+			std::vector<double> weights;
+			std::vector<std::vector<int> > threadSources(numberThreads);
+			std::vector<std::vector<int> > threadTargets(numberThreads);
+			std::vector<std::vector<double> > threadWeights(numberThreads);
+			std::vector<int> threadMaximumId(numberThreads,0);
+			std::vector<int> threadLastIdPartitionV1(numberThreads,0);
+			std::vector<const char*> chunks(numberThreads+1);
+			std::vector<char> buffer(BLOCK_SIZE);
+			size_t carried = 0;			//bytes of an incomplete line kept from the previous block
+			bool firstBlock = true;
+			bool lastBlock = false;
+			while(!lastBlock)
 			{
-				getline(inputFile,line);
-				if(inputFile.eof())break;
-				if((line.length()>0)&&(line[0] != '#')) //because some inputs can contain informative lines starting with #
+				if(carried == buffer.size())		//a line longer than the block
+					buffer.resize(buffer.size()*2);
+				inputFile.read(&buffer[carried],buffer.size()-carried);
+				size_t size = carried + inputFile.gcount();
+				lastBlock = !inputFile.good();
+				const char* begin = buffer.data();
+				const char* end = begin + size;
+				if(firstBlock)
 				{
-					pieces = StringSplitter::split(line,"\t",items);
-					if(atoi(pieces[1].c_str())>maximumId)
-						maximumId = atoi(pieces[1].c_str());
-					if(atoi(pieces[0].c_str())>_lastIdPartitionV1)
-						_lastIdPartitionV1 = atoi(pieces[0].c_str());
+					const char* firstLineEnd = (const char*)memchr(begin,'\n',size);
+					if(firstLineEnd == NULL)firstLineEnd = end;
+					if(memchr(begin,'\t',firstLineEnd-begin) == NULL)
+					{
+						printf("\n ::: The bipartite file should be tab delimited :::\n");
+						exit(EXIT_FAILURE);
+					}
+					firstBlock = false;
 				}
-			}
-			_numberNodes = maximumId+1;
-			_graph = new MetaNode[_numberNodes];
-			inputFile.clear();
-			inputFile.seekg(0, std::ios::beg);
-	
-			std::tr1::unordered_map<int,double> neighborsPerNode[_numberNodes];
-			while(inputFile.good())				//read line by line
-			{
-				getline(inputFile,line);
-				if(inputFile.eof())break;
-				if((line.length()>0)&&(line[0] != '#'))
-				{       //find neighbors for each node
-					pieces = StringSplitter::split(line,"\t",items);
-					neighborsPerNode[atoi(pieces[0].c_str())][atoi(pieces[1].c_str())] = atof(pieces[2].c_str());		
-					neighborsPerNode[atoi(pieces[1].c_str())][atoi(pieces[0].c_str())] = atof(pieces[2].c_str());
-					_numberEdges++;
-					_weightEdges += atof(pieces[2].c_str());
+				if(!lastBlock)
+				{
+					const char* lastNewLine = end;
+					while((lastNewLine > begin)&&(lastNewLine[-1] != '\n'))lastNewLine--;
+					if(lastNewLine == begin)
+					{
+						carried = size;
+						continue;
+					}
+					end = lastNewLine;
 				}
-			}
-			std::vector<Node> nodeV;
-			for(int i=0;i<_numberNodes;i++)   //Creation of metanodes and nodes
-			{					
-				if(i<=_lastIdPartitionV1)	//Create nodes belonging to set V1
-				{	Node node(i,"V1",0);
-					nodeV.push_back(node);
-					MetaNode metanode(i,"V1",nodeV,neighborsPerNode[i],-1);
-					for(auto it=neighborsPerNode[i].begin();it!=neighborsPerNode[i].end();++it)
-						_weightEdgesV1 += it->second;
-					_graph[i] = metanode;
-					nodeV.clear();
+				chunks[0] = begin;
+				for(int t=1;t<numberThreads;t++)
+				{
+					const char* cut = begin + (end-begin)*t/numberThreads;
+					if(cut < chunks[t-1])cut = chunks[t-1];
+					while((cut < end)&&(cut > begin)&&(cut[-1] != '\n'))cut++;
+					chunks[t] = cut;
 				}
-				else				//Create nodes belonging to set V2
-				{	Node node(i,"V2",0);	
-					nodeV.push_back(node);
-					MetaNode metanode(i,"V2",nodeV,neighborsPerNode[i],-1);
-					for(auto it=neighborsPerNode[i].begin();it!=neighborsPerNode[i].end();++it)
-						_weightEdgesV2 += it->second;
-					_graph[i] = metanode;
-					nodeV.clear();
+				chunks[numberThreads] = end;
+				#pragma omp parallel for schedule(static,1) num_threads(numberThreads) reduction(+:malformedLines)
+				for(int t=0;t<numberThreads;t++)
+				{
+					threadSources[t].clear();
+					threadTargets[t].clear();
+					threadWeights[t].clear();
+					malformedLines += parseEdges(chunks[t],chunks[t+1],threadSources[t],threadTargets[t],threadWeights[t],threadMaximumId[t],threadLastIdPartitionV1[t]);
+				}
+				for(int t=0;t<numberThreads;t++)
+				{
+					sources.insert(sources.end(),threadSources[t].begin(),threadSources[t].end());
+					targets.insert(targets.end(),threadTargets[t].begin(),threadTargets[t].end());
+					weights.insert(weights.end(),threadWeights[t].begin(),threadWeights[t].end());
 				}
+				carried = (buffer.data() + size) - end;
+				if(carried > 0)
+					memmove(buffer.data(),end,carried);
 			}
-			delete[] pieces;
 			inputFile.close();		//close the file from which we were reading
-			result = 0;			//reading completed successfully
-			g = new Graph(_graph,_numberNodes,_numberEdges,_weightEdges,_weightEdgesV1,_weightEdgesV2,_lastIdPartitionV1);
-			//delete[] _graph;
+			std::vector<char>().swap(buffer);
+			if(malformedLines > 0)
+			{
+				printf("\n ::: %d lines of the bipartite file do not have three tab separated columns :::\n",malformedLines);
+				exit(EXIT_FAILURE);
+			}
+			for(int t=0;t<numberThreads;t++)
+			{
+				maximumId = std::max(maximumId,threadMaximumId[t]);
+				_lastIdPartitionV1 = std::max(_lastIdPartitionV1,threadLastIdPartitionV1[t]);
+			}
+			result = loadBipartiteGraphFromEdges(g,sources,targets,weights,maximumId,_lastIdPartitionV1);
 		}
 		return result;
 	}
 
+	//Builds the graph from edges already in memory. Both directions of every edge are expected, one after the other
+	//and in input order, as parseEdges appends them; the vectors are released once the adjacency is built.
+	int static loadBipartiteGraphFromEdges(Graph* &g,std::vector<int> &sources,std::vector<int> &targets,std::vector<double> &weights,int maximumId,int lastIdPartitionV1)
+	{
+		MetaNode* _graph = NULL;
+		int _numberNodes = 0;
+		int _numberEdges = 0;
+		double _weightEdges = 0.0;
+		double _weightEdgesV1 = 0.0;
+		double _weightEdgesV2 = 0.0;
+		int _lastIdPartitionV1 = lastIdPartitionV1;
+		//The weight is added in input order to get the same total as a sequential read
+		_numberEdges = weights.size()/2;
+		for(unsigned int i=0;i<weights.size();i+=2)
+			_weightEdges += weights[i];
+		_numberNodes = maximumId+1;
+		CSRAdjacency* _adjacency = new CSRAdjacency(_numberNodes);
+		_adjacency->buildNeighbors(_numberNodes,sources,targets,weights);
+		std::vector<int>().swap(sources);
+		std::vector<int>().swap(targets);
+		std::vector<double>().swap(weights);
+		_graph = createMetaNodes(_adjacency,_numberNodes,_lastIdPartitionV1,_weightEdgesV1,_weightEdgesV2);
+		g = new Graph(_graph,_adjacency,_numberNodes,_numberEdges,_weightEdges,_weightEdgesV1,_weightEdgesV2,_lastIdPartitionV1);
+		return 0;			//reading completed successfully
+	}
+
 };
 
 #endif /* LOADGRAPH_H_ */
@@ -34,6 +34,10 @@
 /*
 # LoadSimilarityMatrix.h
 # Reads the input file/files containing the similarity matrices of each set of vertices of the bipartite graph.
+# A matrix is given either dense, one "," delimited row per vertex, or sparse, one "row,column,similarity" triplet
+# per line when the file name contains "triplets". In both formats ids are local to the set of vertices (starting
+# at 0) and the matrix is preceded by a "name:expected similarity" line. A sparse matrix lists both (i,j) and (j,i)
+# with the same similarity. The file name, without extension and "_triplets", ends with the set: V1 or V2.
 */
 
 #ifndef LOADSIMILARITYMATRIX_H_
@@ -43,13 +47,151 @@
 
 class LoadSimilarityMatrix
 {
+  private:
+
+	//A field is read only when the number takes all of it, apart from surrounding blanks
+	static bool fieldEnd(const char* parsed,const char* end)
+	{
+		while((parsed < end)&&((*parsed == ' ')||(*parsed == '\t')))parsed++;
+		return parsed == end;
+	}
+
+	static bool parseIntField(const char* begin,const char* end,int &value)
+	{
+		const char* parsed = StringSplitter::parseInt(begin,end,value);
+		return (parsed > begin)&&(parsed[-1] >= '0')&&(parsed[-1] <= '9')&&fieldEnd(parsed,end);
+	}
+
+	static bool parseDoubleField(const char* begin,const char* end,double &value)
+	{
+		while((begin < end)&&((*begin == ' ')||(*begin == '\t')))begin++;
+		const char* parsed = StringSplitter::parseDouble(begin,end,value);
+		return (parsed > begin)&&fieldEnd(parsed,end);
+	}
+
+	//Number of (row,column) pairs given more than once; the intra-type rows keep only one of them
+	static int countRepeatedEntries(const std::vector<int> &sources,const std::vector<int> &targets)
+	{
+		std::vector<unsigned long long> keys(sources.size());
+		for(unsigned int k=0;k<sources.size();k++)
+			keys[k] = ((unsigned long long)(unsigned int)sources[k] << 32) | (unsigned int)targets[k];
+		std::sort(keys.begin(),keys.end());
+		int repeated = 0;
+		for(unsigned int k=1;k<keys.size();k++)
+			if(keys[k] == keys[k-1])
+				repeated++;
+		return repeated;
+	}
+
+	//Number of entries whose transpose is missing or has another similarity; the pairs are not repeated
+	static int countAsymmetricEntries(const std::vector<int> &sources,const std::vector<int> &targets,const std::vector<double> &weights)
+	{
+		std::vector<std::pair<unsigned long long,double> > entries(sources.size());
+		for(unsigned int k=0;k<sources.size();k++)
+			entries[k] = std::make_pair(((unsigned long long)(unsigned int)sources[k] << 32) | (unsigned int)targets[k],weights[k]);
+		std::sort(entries.begin(),entries.end());
+		int asymmetric = 0;
+		for(unsigned int k=0;k<sources.size();k++)
+		{
+			unsigned long long transpose = ((unsigned long long)(unsigned int)targets[k] << 32) | (unsigned int)sources[k];
+			std::vector<std::pair<unsigned long long,double> >::const_iterator it = std::lower_bound(entries.begin(),entries.end(),std::make_pair(transpose,-std::numeric_limits<double>::infinity()));
+			if((it == entries.end())||(it->first != transpose)||(it->second != weights[k]))
+				asymmetric++;
+		}
+		return asymmetric;
+	}
+
+	//The set of a matrix file is the end of its name, without directories, extension and "_triplets"
+	static bool isPartitionV2(const std::string &fileName)
+	{
+		std::string name = fileName.substr(fileName.find_last_of('/')+1);
+		name = name.substr(0,name.find_last_of('.'));
+		if((name.size() >= 9)&&(name.compare(name.size()-9,9,"_triplets") == 0))
+			name.erase(name.size()-9);
+		return (name.size() >= 2)&&(name.compare(name.size()-2,2,"V2") == 0);
+	}
+
+	//Parses the matrix lines in [begin,end) into local (row,column,similarity) entries, skipping zeros. Dense rows
+	//are numbered from 0 within the chunk; rows returns how many there were. Returns the number of triplet lines
+	//that are not three "," separated numbers.
+	int static parseEntries(const char* begin,const char* end,bool triplets,std::vector<int> &sources,std::vector<int> &targets,std::vector<double> &weights,int &rows)
+	{
+		int malformedLines = 0;
+		rows = 0;
+		const char* p = begin;
+		while(p < end)
+		{
+			const char* lineEnd = (const char*)memchr(p,'\n',end-p);
+			if(lineEnd == NULL)lineEnd = end;
+			const char* contentEnd = lineEnd;
+			if((contentEnd > p)&&(contentEnd[-1] == '\r'))contentEnd--;
+			if((p < contentEnd)&&(*p != '#')&&(memchr(p,':',contentEnd-p) == NULL))
+			{
+				if(triplets)
+				{
+					const char* firstComma = (const char*)memchr(p,',',contentEnd-p);
+					const char* secondComma = (firstComma == NULL) ? NULL : (const char*)memchr(firstComma+1,',',contentEnd-(firstComma+1));
+					int row = 0;
+					int column = 0;
+					double similarity = 0.0;
+					if((secondComma == NULL)||!parseIntField(p,firstComma,row)||!parseIntField(firstComma+1,secondComma,column)||!parseDoubleField(secondComma+1,contentEnd,similarity))
+						malformedLines++;
+					else
+					{
+						if(similarity != 0.0)
+						{
+							sources.push_back(row);
+							targets.push_back(column);
+							weights.push_back(similarity);
+						}
+					}
+				}
+				else
+				{
+					const char* field = p;
+					for(int column=0;field <= contentEnd;column++)
+					{
+						const char* fieldEnd = (const char*)memchr(field,',',contentEnd-field);
+						if(fieldEnd == NULL)fieldEnd = contentEnd;
+						double similarity = 0.0;
+						StringSplitter::parseDouble(field,fieldEnd,similarity);
+						if(similarity != 0.0)
+						{
+							sources.push_back(rows);
+							targets.push_back(column);
+							weights.push_back(similarity);
+						}
+						field = fieldEnd + 1;
+					}
+					rows++;
+				}
+			}
+			p = lineEnd + 1;
+		}
+		return malformedLines;
+	}
+
   public:
 
+	//Matrix file of the vertices of partition ("V1" or "V2") for the -similarity prefix: {prefix}V1.csv when it
+	//exists, {prefix}V1_triplets.csv otherwise, or "" when there is none
+	static std::string findSimilarityMatrixFile(const std::string &prefix,const std::string &partition)
+	{
+		std::string fileName = prefix + partition + ".csv";
+		if(access(fileName.c_str(),R_OK) == 0)
+			return fileName;
+		fileName = prefix + partition + "_triplets.csv";
+		if(access(fileName.c_str(),R_OK) == 0)
+			return fileName;
+		return "";
+	}
 
-	//Read the similarity matrices for V1, V2, or both.
-	int static loadSimilarityMatrixFromFile(Graph &g,std::string &similarityMatrixFileName)
+	//Read the similarity matrices for V1, V2, or both. The file is read at once and cut at line boundaries into one
+	//chunk per thread; the chunks are parsed in parallel and their entries are added in file order straight to the
+	//intra-type rows of the graph, so the result does not depend on the number of threads.
+	int static loadSimilarityMatrixFromFile(Graph &g,std::string &similarityMatrixFileName,int numberThreads = 1)
 	{
-		std::ifstream inputFile(similarityMatrixFileName.c_str());
+		std::ifstream inputFile(similarityMatrixFileName.c_str(),std::ios::in|std::ios::binary);
 		bool is_good = true;
 		int result;
 
@@ -60,78 +202,179 @@ class LoadSimilarityMatrix
 		}
 		if(is_good)						//If the file has been found
 		{
-			std::string line = "";
-			getline(inputFile,line);
-			while(line[0] == '#')
-				getline(inputFile,line);
-	                int location = line.find(":");
- 			if(location == std::string::npos)
-                        {
-                             	printf("\n ::: Expected similarity (alpha) not specified :::\n");
-                             	exit(EXIT_FAILURE);
-                        }
-                        else
+			if(numberThreads < 1)numberThreads = 1;
+			inputFile.seekg(0,std::ios::end);
+			std::vector<char> buffer((size_t)inputFile.tellg());
+			inputFile.seekg(0,std::ios::beg);
+			if(buffer.size() > 0)
+				inputFile.read(buffer.data(),buffer.size());
+			inputFile.close();		//close the file from which we were reading
+			const char* begin = buffer.data();
+			const char* end = begin + buffer.size();
+			const char* line = begin;
+			const char* lineEnd = begin;
+			while(line < end)
 			{
-				int row = 0, column = 0;
-				double lambdaPartition =0.0, sumSimilarityPartition = 0.0;
-				lambdaPartition = atof(line.substr(location+1,line.length()).c_str());
-				if(similarityMatrixFileName.find("V2") != std::string::npos)
-                                        column = g.getLastIdPartitionV1()+1;
-				getline(inputFile,line);
-				location = line.find(",");
-				if(location == std::string::npos)
-				{
-					printf("\n ::: The similarity matrix should be "," delimited :::\n");
-					exit(EXIT_FAILURE);
-				}
-				inputFile.clear();
-	                        inputFile.seekg(0, std::ios::beg);
-				int columnId = 0, rowId = 0;
-				int items = 0;
-				std::string* pieces;
-				std::tr1::unordered_map<int,double> intraTypeNeighbors;
-				while(inputFile.good())				//read line by line
+				lineEnd = (const char*)memchr(line,'\n',end-line);
+				if(lineEnd == NULL)lineEnd = end;
+				if(*line != '#')break;
+				line = lineEnd + 1;
+			}
+			const char* location = (line < end) ? (const char*)memchr(line,':',lineEnd-line) : NULL;
+			if(location == NULL)
+			{
+				printf("\n ::: Expected similarity (alpha) not specified :::\n");
+				exit(EXIT_FAILURE);
+			}
+			double lambdaPartition = 0.0, sumSimilarityPartition = 0.0;
+			StringSplitter::parseDouble(location+1,lineEnd,lambdaPartition);
+			begin = std::min(lineEnd + 1,end);
+			bool triplets = (similarityMatrixFileName.substr(similarityMatrixFileName.find_last_of('/')+1).find("triplets") != std::string::npos);
+			bool partitionV2 = isPartitionV2(similarityMatrixFileName);
+			const char* firstRowEnd = (const char*)memchr(begin,'\n',end-begin);
+			if(firstRowEnd == NULL)firstRowEnd = end;
+			if(memchr(begin,',',firstRowEnd-begin) == NULL)
+			{
+				printf("\n ::: The similarity matrix should be \",\" delimited :::\n");
+				exit(EXIT_FAILURE);
+			}
+			int firstId = 0, partitionSize = g.getLastIdPartitionV1()+1;
+			if(partitionV2)
+			{
+				firstId = g.getLastIdPartitionV1()+1;
+				partitionSize = g.getNumberNodes() - firstId;
+			}
+			std::vector<const char*> chunks(numberThreads+1);
+			chunks[0] = begin;
+			for(int t=1;t<numberThreads;t++)
+			{
+				const char* cut = begin + (end-begin)*t/numberThreads;
+				if(cut < chunks[t-1])cut = chunks[t-1];
+				while((cut < end)&&(cut > begin)&&(cut[-1] != '\n'))cut++;
+				chunks[t] = cut;
+			}
+			chunks[numberThreads] = end;
+			std::vector<std::vector<int> > threadSources(numberThreads);
+			std::vector<std::vector<int> > threadTargets(numberThreads);
+			std::vector<std::vector<double> > threadWeights(numberThreads);
+			std::vector<int> threadRows(numberThreads,0);
+			int malformedLines = 0;
+			#pragma omp parallel for schedule(static,1) num_threads(numberThreads) reduction(+:malformedLines)
+			for(int t=0;t<numberThreads;t++)
+				malformedLines += parseEntries(chunks[t],chunks[t+1],triplets,threadSources[t],threadTargets[t],threadWeights[t],threadRows[t]);
+			std::vector<char>().swap(buffer);
+			if(malformedLines > 0)
+			{
+				printf("\n ::: %d lines of the similarity matrix are not three \",\" separated numbers :::\n",malformedLines);
+				exit(EXIT_FAILURE);
+			}
+			//Dense rows are renumbered from the rows of the previous chunks, the diagonal is dropped and the similarity is
+			//added in file order
+			std::vector<int> sources;
+			std::vector<int> targets;
+			std::vector<double> weights;
+			int firstRow = 0, outOfRange = 0;
+			for(int t=0;t<numberThreads;t++)
+			{
+				for(unsigned int k=0;k<threadSources[t].size();k++)
 				{
-					getline(inputFile,line);
-					//std::cout << "\n" << line;
-					if(inputFile.eof())break;
-					if((line.length()>0)&&(line[0] != '#')&&(line.find(":") == std::string::npos))
-					{       
-						pieces = StringSplitter::split(line,",",items);
-						for(int i=0; i<items;i++)						
-						{
-							rowId = row + column;
-							columnId = column + i;
-							if((atof(pieces[i].c_str()) != 0.0)&&(rowId != columnId))
-							{
-							    intraTypeNeighbors[columnId] = atof(pieces[i].c_str());
- 							    sumSimilarityPartition += atof(pieces[i].c_str());
-							}
-						}
-						g.addIntraTypeNeighborsToNode(rowId,intraTypeNeighbors);
-						intraTypeNeighbors.clear();
-						row++;
+					int row = threadSources[t][k] + firstRow;
+					int column = threadTargets[t][k];
+					if((row < 0)||(row >= partitionSize)||(column < 0)||(column >= partitionSize))
+						outOfRange++;
+					else if(row != column)
+					{
+						sources.push_back(row + firstId);
+						targets.push_back(column + firstId);
+						weights.push_back(threadWeights[t][k]);
+						sumSimilarityPartition += threadWeights[t][k];
 					}
-				}		
-				std::cout<<"\n Similarity Sum:"<< sumSimilarityPartition;
-				if(similarityMatrixFileName.find("V1") != std::string::npos)
-				{
-                                        g.setSimilarityV1(sumSimilarityPartition);
-					g.setLambdaV1(lambdaPartition/sumSimilarityPartition);
-				}
-                                else	
-				{
-					g.setSimilarityV2(sumSimilarityPartition);
-					g.setLambdaV2(lambdaPartition/sumSimilarityPartition);
 				}
-				delete[] pieces;
-				inputFile.close();		//close the file from which we were reading
-				result = 0;				//reading completed successfully
-			}					
+				firstRow += threadRows[t];
+				std::vector<int>().swap(threadSources[t]);
+				std::vector<int>().swap(threadTargets[t]);
+				std::vector<double>().swap(threadWeights[t]);
+			}
+			if(outOfRange > 0)
+			{
+				printf("\n ::: %d entries of the similarity matrix refer to vertices outside the %d vertices of the set :::\n",outOfRange,partitionSize);
+				exit(EXIT_FAILURE);
+			}
+			int repeated = countRepeatedEntries(sources,targets);
+			if(repeated > 0)
+			{
+				printf("\n ::: %d entries of the similarity matrix repeat a (row,column) pair given before :::\n",repeated);
+				exit(EXIT_FAILURE);
+			}
+			int asymmetric = triplets ? countAsymmetricEntries(sources,targets,weights) : 0;
+			if(asymmetric > 0)
+			{
+				printf("\n ::: %d entries of the similarity matrix have no (column,row) entry with the same similarity :::\n",asymmetric);
+				exit(EXIT_FAILURE);
+			}
+			g.buildIntraTypeNeighbors(sources,targets,weights);
+			std::cout<<"\n Similarity Sum:"<< sumSimilarityPartition;
+			if(partitionV2)
+			{
+				g.setSimilarityV2(sumSimilarityPartition);
+				g.setLambdaV2(lambdaPartition/sumSimilarityPartition);
+			}
+			else
+			{
+				g.setSimilarityV1(sumSimilarityPartition);
+				g.setLambdaV1(lambdaPartition/sumSimilarityPartition);
+			}
+			result = 0;				//reading completed successfully
 		}
 		return result;
 	}
 
+	//Same as loadSimilarityMatrixFromFile for a matrix already in memory: (row,column,similarity) entries with ids
+	//local to V1 or V2 and the expected similarity of the set. Zeros and the diagonal are skipped. Returns -1, without
+	//changing the graph, when an entry refers to a vertex outside the set, repeats a (row,column) pair or has no
+	//(column,row) entry with the same similarity.
+	int static loadSimilarityMatrixFromEntries(Graph &g,bool partitionV2,double expectedSimilarity,const std::vector<int> &rows,const std::vector<int> &columns,const std::vector<double> &similarities)
+	{
+		int firstId = 0, partitionSize = g.getLastIdPartitionV1()+1;
+		if(partitionV2)
+		{
+			firstId = g.getLastIdPartitionV1()+1;
+			partitionSize = g.getNumberNodes() - firstId;
+		}
+		if((rows.size() != columns.size())||(rows.size() != similarities.size()))
+			return -1;
+		std::vector<int> sources;
+		std::vector<int> targets;
+		std::vector<double> weights;
+		double sumSimilarityPartition = 0.0;
+		for(unsigned int k=0;k<rows.size();k++)
+		{
+			if((rows[k] < 0)||(rows[k] >= partitionSize)||(columns[k] < 0)||(columns[k] >= partitionSize))
+				return -1;
+			if((rows[k] != columns[k])&&(similarities[k] != 0.0))
+			{
+				sources.push_back(rows[k] + firstId);
+				targets.push_back(columns[k] + firstId);
+				weights.push_back(similarities[k]);
+				sumSimilarityPartition += similarities[k];
+			}
+		}
+		if((sumSimilarityPartition == 0.0)||(countRepeatedEntries(sources,targets) > 0)||(countAsymmetricEntries(sources,targets,weights) > 0))
+			return -1;
+		g.buildIntraTypeNeighbors(sources,targets,weights);
+		if(partitionV2)
+		{
+			g.setSimilarityV2(sumSimilarityPartition);
+			g.setLambdaV2(expectedSimilarity/sumSimilarityPartition);
+		}
+		else
+		{
+			g.setSimilarityV1(sumSimilarityPartition);
+			g.setLambdaV1(expectedSimilarity/sumSimilarityPartition);
+		}
+		return 0;
+	}
+
 };
 
 #endif /* LOADSIMILARITYMATRIX_H_ */
@@ -36,6 +36,8 @@
 #include "Graph.h"
 #include "LoadGraph.h"
 #include "LoadSimilarityMatrix.h"
+#include "GraphSnapshot.h"
+#include "PhaseCheckpoint.h"
 #include "FuseMethod.h"
 #include "biLouvainMethod.h"
 #include "biLouvainMethodMurataPN.h"
@@ -46,6 +48,8 @@ static std::string inputFileName = "";
 static std::string initialCommunitiesFileName = "";
 static std::string similarityMatrixFileName = "";
 static std::string outputFileName = "";
+static std::string snapshotFileName = "";
+static std::string checkpointFileName = "";
 static std::string delimiter = "\t";
 static int optionOrder = 3;
 static int fuse = 1;
@@ -53,6 +57,15 @@ static double cutoffIterations = 0.01;
 static double cutoffPhases =  0.0;
 static double cutoffFuse = 1.0;
 static double alpha =  1.0;
+static int numberThreads = 1;
+static int batchSize = 1024;
+static int compensated = 1;
+static unsigned long long seed = 1;
+static int active = 0;
+static double activeTolerance = 1.0;
+static int resume = 0;
+static int binaryResults = 0;
+static int dendrogram = 0;
 static int flag;
 static void parseCommandLine(const int argc, char * const argv[]);
 
@@ -67,6 +80,17 @@ static struct option longopts[] = {
    { "cf",              required_argument,&flag,6},
    { "similarity",	required_argument,&flag,7},
    { "alpha",		required_argument,&flag,8},
+   { "threads",		required_argument,&flag,9},
+   { "batch",		required_argument,&flag,10},
+   { "snapshot",	required_argument,&flag,11},
+   { "compensated",	required_argument,&flag,12},
+   { "seed",		required_argument,&flag,13},
+   { "active",		required_argument,&flag,14},
+   { "activetol",	required_argument,&flag,15},
+   { "checkpoint",	required_argument,&flag,16},
+   { "resume",		required_argument,&flag,17},
+   { "binary",		required_argument,&flag,18},
+   { "dendrogram",	required_argument,&flag,19},
    { "output",		required_argument,0,'o'},
    { 0, 0, 0, 0 }
 };
@@ -87,6 +111,7 @@ int main(int argc, char *argv[])
                         std::cout << "\n ::: Loading Bipartite Graph " << inputFileName << " :::";
                         std::string bipartiteFileName;
                         std::tr1::unordered_map<int,std::string> bipartiteOriginalEntities;
+			BipartiteEdges preProcessedEdges;
                         //if((inputFileName.find("bipartite") == std::string::npos)||(inputFileName.find("Bipartite") == std::string::npos))
                         std::string* pieces;
                         pieces = StringSplitter::split(inputFileName,"bipartite",items);
@@ -109,7 +134,7 @@ int main(int argc, char *argv[])
                         {
 				int pos = inputFileName.find_last_of(".");
 				bipartiteFileName = inputFileName.substr(0,pos)+"_bipartite.txt";
-				bipartiteOriginalEntities=PreProcessInputBipartiteGraph::preProcessingGraphData(inputFileName,delimiter);
+				bipartiteOriginalEntities=PreProcessInputBipartiteGraph::preProcessingGraphData(inputFileName,delimiter,&preProcessedEdges);
 			}
 			else
 			{
@@ -120,26 +145,64 @@ int main(int argc, char *argv[])
 			int pass = -1;
 			gettimeofday(&startTime,NULL);
 			Graph* graph;
-			pass = LoadGraph::loadBipartiteGraphFromFile(graph,bipartiteFileName);
+			//A snapshot older than the bipartite file is stale and is written again
+			bool snapshotLoaded = false;
+			bool snapshotSimilarity = false;
+			//A resumed run takes the compacted graph, and the alpha it was clustered with, from the checkpoint
+			bool checkpointLoaded = false;
+			phaseCheckpointState checkpointState;
+			if((resume != 0)&&(checkpointFileName.empty() == false))
+			{
+				std::cout << "\n ::: Loading Checkpoint " << checkpointFileName << " :::";
+				checkpointLoaded = (PhaseCheckpoint::loadPhaseCheckpoint(graph,checkpointState,checkpointFileName) == 0);
+				if(checkpointLoaded)
+					alpha = checkpointState.alpha;
+				else
+					printf("\n ::: Warning: Checkpoint %s could not be loaded, the run starts from the input graph. :::",checkpointFileName.c_str());
+			}
+			//Matrix files of V1 and V2 for the -similarity prefix; a snapshot only uses similarity rows read from them
+			std::vector<std::string> similarityFiles;
+			if(similarityMatrixFileName.empty() == false)
+			{
+				similarityFiles.push_back(LoadSimilarityMatrix::findSimilarityMatrixFile(similarityMatrixFileName,"V1"));
+				similarityFiles.push_back(LoadSimilarityMatrix::findSimilarityMatrixFile(similarityMatrixFileName,"V2"));
+			}
+			if(checkpointLoaded)
+				pass = 0;
+			else if(snapshotFileName.empty() == false)
+			{
+				struct stat snapshotStat,bipartiteStat;
+				if((stat(snapshotFileName.c_str(),&snapshotStat) == 0)&&((stat(bipartiteFileName.c_str(),&bipartiteStat) != 0)||(bipartiteStat.st_mtime <= snapshotStat.st_mtime)))
+				{
+					std::cout << "\n ::: Mapping Graph Snapshot " << snapshotFileName << " :::";
+					snapshotLoaded = (GraphSnapshot::loadGraphSnapshot(graph,snapshotFileName,alpha != 1.0,similarityFiles,snapshotSimilarity) == 0);
+				}
+			}
+			if(checkpointLoaded||snapshotLoaded)
+				pass = 0;
+			else if(preProcessedEdges.loaded)	//the graph was just preprocessed and is still in memory
+				pass = LoadGraph::loadBipartiteGraphFromEdges(graph,preProcessedEdges.sources,preProcessedEdges.targets,preProcessedEdges.weights,preProcessedEdges.maximumId,preProcessedEdges.lastIdPartitionV1);
+			else
+				pass = LoadGraph::loadBipartiteGraphFromFile(graph,bipartiteFileName,numberThreads);
 			gettimeofday(&endTime,NULL);
 			loadGraphTime = (endTime.tv_sec - startTime.tv_sec)*1000000 + (endTime.tv_usec - startTime.tv_usec);
 			if (pass == 0)
 			{                            
 				std::cout << "\n ::: Done Loading Bipartite Graph :::";		
-				if(alpha != 1.0)
+				if((alpha != 1.0)&&(checkpointLoaded == false))
 				{
 					int numberMatrices = 0;
-					std::string similarityMatrixPartitionFileName = "";
-					if(similarityMatrixFileName.empty()== false)
+					if(snapshotSimilarity)
+						numberMatrices++;
+					else if(similarityMatrixFileName.empty()== false)
 					{	
-						similarityMatrixPartitionFileName = similarityMatrixFileName + "V1.csv";
-						pass = LoadSimilarityMatrix::loadSimilarityMatrixFromFile(*graph,similarityMatrixPartitionFileName); 
+						//A dense matrix is looked for first and then a sparse one ({prefix}V1_triplets.csv)
+						pass = similarityFiles[0].empty() ? -1 : LoadSimilarityMatrix::loadSimilarityMatrixFromFile(*graph,similarityFiles[0],numberThreads);
 						if (pass == 0)	
 							numberMatrices ++;
 						else
 							printf("\n ::: Warning: Similarity Matrix for vertices in V1 was not found. :::");
-						similarityMatrixPartitionFileName = similarityMatrixFileName + "V2.csv";
-						pass = LoadSimilarityMatrix::loadSimilarityMatrixFromFile(*graph,similarityMatrixPartitionFileName); 
+						pass = similarityFiles[1].empty() ? -1 : LoadSimilarityMatrix::loadSimilarityMatrixFromFile(*graph,similarityFiles[1],numberThreads);
 						if (pass == 0)	
 							numberMatrices ++;
 						else
@@ -149,12 +212,32 @@ int main(int argc, char *argv[])
 					if(numberMatrices == 0)
 						alpha = 1.0;
 				}	
+				if((snapshotFileName.empty() == false)&&(snapshotLoaded == false)&&(checkpointLoaded == false))
+				{
+					if(GraphSnapshot::writeGraphSnapshot(*graph,snapshotFileName,similarityFiles) == 0)
+						std::cout << "\n ::: Graph Snapshot written to " << snapshotFileName << " :::";
+					else
+						printf("\n ::: Warning: Graph Snapshot %s could not be written. :::",snapshotFileName.c_str());
+				}
 				FuseMethod f;
 				biLouvainMethodMurataPN biLouvain;
+				biLouvain.setNumberThreads(numberThreads);
+				biLouvain.setBatchSize(batchSize);
+				biLouvain.setCompensatedSummation(compensated != 0);
+				biLouvain.setSeed(seed);
+				biLouvain.setActiveSet(active != 0,activeTolerance);
+				biLouvain.setCheckpoint(checkpointFileName);
+				biLouvain.setBinaryResults(binaryResults != 0);
+				biLouvain.setWriteDendrogram(dendrogram != 0);
+				if(checkpointLoaded)
+					biLouvain.resumeFromCheckpoint(checkpointState);
+				f.setNumberThreads(numberThreads);
+				f.setCompensatedSummation(compensated != 0);
 				//std::vector<double> communitiesBetaFactor;
-				 if((fuse == 1)&&(initialCommunitiesFileName.empty()==true))
+				//The nodes of a checkpoint graph are already the communities of the finished phases
+				 if((fuse == 1)&&(checkpointLoaded == false)&&(initialCommunitiesFileName.empty()==true))
                                         f.fuseMethodFile(*graph,bipartiteFileName,alpha,cutoffFuse);
-                                else if((fuse == 1)&&(initialCommunitiesFileName.empty()==false))
+                                else if((fuse == 1)&&(checkpointLoaded == false)&&(initialCommunitiesFileName.empty()==false))
                                         f.initialCommunityDefinitionProvidedFileCommunities(*graph,initialCommunitiesFileName,alpha);
 				std::cout << "\n ::: Starting biLouvain Algorithm :::";
 				gettimeofday(&startTime,NULL);							
@@ -189,7 +272,7 @@ int main(int argc, char *argv[])
 
 void printUsage()
 {
-	 printf("Usage: -i {inputFile} -d {delimiter (\" \",\",\",\"\\t\")} [-ci {cutoff iterations(default=0.01)} -cp {cutoff phases(default=0.0)} -order {1:Sequential, 2:Alternate, 3:Random(default=3)} -initial {initialCommuitiesFile}(default=\"\") -fuse {0/1 flag(default=1)} -o {outputFileName(default=input_Results*)}]\n");  
+	 printf("Usage: -i {inputFile} -d {delimiter (\" \",\",\",\"\\t\")} [-ci {cutoff iterations(default=0.01)} -cp {cutoff phases(default=0.0)} -order {1:Sequential, 2:Alternate, 3:Random, 4:Color classes, 5:Degree descending, 6:Random inside each partition, V1 first(default=3)} -seed {seed of the random orders(default=1)} -active {0/1 flag, score again only the nodes whose neighborhood changed, not used with -alpha 0(default=0)} -activetol {contribution change of a community that makes its members active, not used with -alpha 0(default=1.0, only co-cluster mate changes)} -initial {initialCommuitiesFile}(default=\"\") -similarity {prefix of the similarity matrices {prefix}V1.csv and {prefix}V2.csv, or {prefix}V1_triplets.csv and {prefix}V2_triplets.csv with \"row,column,similarity\" lines listing both (i,j) and (j,i)(default=\"\")} -alpha {weight of the bipartite modularity against the similarity(default=1.0)} -fuse {0/1 flag(default=1)} -threads {number of threads(default=1), the node moves of -alpha 0 are made on one thread} -batch {nodes scored together when threads > 1, not used with -alpha 0(default=1024)} -snapshot {binary graph file, written when missing and mapped otherwise(default=\"\")} -compensated {0/1 flag, Kahan summation of the weights of compacted graphs(default=1)} -checkpoint {binary file with the compacted graph of the last finished phase, written after every phase(default=\"\")} -resume {0/1 flag, continue from the checkpoint with its alpha(default=0)} -binary {0/1 flag, also write the results to output_Results.bin(default=0)} -dendrogram {0/1 flag, write the community of every vertex at every phase to output_ResultsDendrogram.bin(default=0)} -o {outputFileName(default=input_Results*)}]\n");  
          exit(EXIT_FAILURE);
 }
 
@@ -271,6 +354,61 @@ void parseCommandLine(const int argc, char * const argv[])
 				if(optarg != NULL)
 					alpha = atof(optarg);
 			}
+			else if(*(longopts[indexPtr].flag)==9)
+			{
+				if(optarg != NULL)
+					numberThreads = atoi(optarg);
+			}
+			else if(*(longopts[indexPtr].flag)==10)
+			{
+				if(optarg != NULL)
+					batchSize = atoi(optarg);
+			}
+			else if(*(longopts[indexPtr].flag)==11)
+			{
+				if(optarg != NULL)
+					snapshotFileName = optarg;
+			}
+			else if(*(longopts[indexPtr].flag)==12)
+			{
+				if(optarg != NULL)
+					compensated = atoi(optarg);
+			}
+			else if(*(longopts[indexPtr].flag)==13)
+			{
+				if(optarg != NULL)
+					seed = strtoull(optarg,NULL,10);
+			}
+			else if(*(longopts[indexPtr].flag)==14)
+			{
+				if(optarg != NULL)
+					active = atoi(optarg);
+			}
+			else if(*(longopts[indexPtr].flag)==15)
+			{
+				if(optarg != NULL)
+					activeTolerance = atof(optarg);
+			}
+			else if(*(longopts[indexPtr].flag)==16)
+			{
+				if(optarg != NULL)
+					checkpointFileName = optarg;
+			}
+			else if(*(longopts[indexPtr].flag)==17)
+			{
+				if(optarg != NULL)
+					resume = atoi(optarg);
+			}
+			else if(*(longopts[indexPtr].flag)==18)
+			{
+				if(optarg != NULL)
+					binaryResults = atoi(optarg);
+			}
+			else if(*(longopts[indexPtr].flag)==19)
+			{
+				if(optarg != NULL)
+					dendrogram = atoi(optarg);
+			}
 			break;
 		    case ':':
 			printUsage;
@@ -34,17 +34,49 @@
 
 #include "MetaNode.h"
 
-MetaNode::MetaNode(){}
+MetaNode::MetaNode()
+		:_idGraph(0),_communityId(-1),_color(-1),_neighbors(NULL),_neighborWeights(NULL),_numberNeighbors(0),_degree(0.0),_intraTypeNeighbors(NULL),_intraTypeNeighborWeights(NULL),_numberIntraTypeNeighbors(0),_similarity(0.0)
+{}
 
-MetaNode::MetaNode(int id, std::string type, std::vector<Node> nodes,std::tr1::unordered_map<int,double> neighbors,int communityId)
+MetaNode::MetaNode(int id, std::string type, std::vector<Node> nodes,int communityId)
+		:_color(-1),_neighbors(NULL),_neighborWeights(NULL),_numberNeighbors(0),_degree(0.0),_intraTypeNeighbors(NULL),_intraTypeNeighborWeights(NULL),_numberIntraTypeNeighbors(0),_similarity(0.0)
 {
 	_idGraph   = id;
 	_type = type;
 	_nodes = nodes;
-	_neighbors = neighbors;
 	_communityId = communityId;
 }
 
+/* Sorted (id,weight) entries */
+std::vector<std::pair<int,double> >::iterator MetaNode::findEntry(std::vector<std::pair<int,double> > &entries,int id)
+{
+	return std::lower_bound(entries.begin(),entries.end(),std::make_pair(id,-std::numeric_limits<double>::infinity()));
+}
+
+double MetaNode::getEntryWeight(std::vector<std::pair<int,double> > &entries,int id)
+{
+	auto search = findEntry(entries,id);
+	if((search != entries.end())&&(search->first == id))return search->second;
+	else return 0.0;
+}
+
+void MetaNode::addEntryWeight(std::vector<std::pair<int,double> > &entries,int id,double weight)
+{
+	auto search = findEntry(entries,id);
+	if((search != entries.end())&&(search->first == id))search->second += weight;
+	else entries.insert(search,std::make_pair(id,weight));
+}
+
+void MetaNode::deleteEntryWeight(std::vector<std::pair<int,double> > &entries,int id,double weight)
+{
+	auto search = findEntry(entries,id);
+	if((search != entries.end())&&(search->first == id))
+	{
+		if(search->second == weight) entries.erase(search);
+		else if (search->second > weight) search->second -= weight;
+	}
+}
+
 /* Get functions */
 int MetaNode::getId()
 {
@@ -61,6 +93,11 @@ int MetaNode::getCommunityId()
 	return _communityId;
 }
 
+int MetaNode::getColor()
+{
+	return _color;
+}
+
 int MetaNode::getNumberNodes()
 {
 	return _nodes.size();
@@ -79,44 +116,80 @@ std::vector<Node> MetaNode::getNodesSorted()
 
 std::vector<int> MetaNode::getNeighbors()
 {
-	std::vector<int> result;
-	for(auto it=_neighbors.begin();it!=_neighbors.end();++it)
-		result.push_back(it->first);
-	return result;
+	return std::vector<int>(_neighbors,_neighbors+_numberNeighbors);
 }
 
 std::vector<int> MetaNode::getNeighborsSorted()
 {
-	std::vector<int> result;
-	for(auto it=_neighbors.begin();it!=_neighbors.end();++it)
-		result.push_back(it->first);
-	sort(result.begin(),result.end(),myobject2);
-	return result;
+	return std::vector<int>(_neighbors,_neighbors+_numberNeighbors);
 }
 
 std::vector<int> MetaNode::getNeighborsWithoutNode(int nodeId)
 {
 	std::vector<int> result;
-	for(auto it=_neighbors.begin();it!=_neighbors.end();++it)
+	for(int i=0;i<_numberNeighbors;i++)
 	{
-		if(it->first != nodeId)
-			//cout << it->first << endl;
-			result.push_back(it->first);
+		if(_neighbors[i] != nodeId)
+			result.push_back(_neighbors[i]);
 	}
 	return result;
 }
 
+IdRange MetaNode::getNeighborsRange()
+{
+	return IdRange(_neighbors,_neighbors+_numberNeighbors,_numberNeighbors);
+}
+
+IdRange MetaNode::getIntraTypeNeighborsRange()
+{
+	return IdRange(_intraTypeNeighbors,_intraTypeNeighbors+_numberIntraTypeNeighbors,_numberIntraTypeNeighbors);
+}
+
+CommunityIdRange MetaNode::getNeighborCommunitiesRange()
+{
+	const std::vector<std::pair<int,double> > &entries = _neighborCommunities;
+	return CommunityIdRange(entries.begin(),entries.end(),entries.size());
+}
+
+CommunityIdRange MetaNode::getIntraTypeNeighborCommunitiesRange()
+{
+	const std::vector<std::pair<int,double> > &entries = _intraTypeNeighborCommunities;
+	return CommunityIdRange(entries.begin(),entries.end(),entries.size());
+}
+
+const std::vector<Node>& MetaNode::getNodesReference()
+{
+	return _nodes;
+}
+
+const int* MetaNode::getNeighborIds()
+{
+	return _neighbors;
+}
+
+const double* MetaNode::getNeighborWeights()
+{
+	return _neighborWeights;
+}
+
+const int* MetaNode::getIntraTypeNeighborIds()
+{
+	return _intraTypeNeighbors;
+}
+
+const double* MetaNode::getIntraTypeNeighborWeights()
+{
+	return _intraTypeNeighborWeights;
+}
+
 int MetaNode::getNumberNeighbors()
 {
-	return _neighbors.size();
+	return _numberNeighbors;
 }
 
 double MetaNode::getDegreeNode()
 {
-	double result = 0.0;
-	for(auto it=_neighbors.begin();it!=_neighbors.end();++it) 
-                result += it->second;
-	return result;
+	return _degree;
 }
 
 int MetaNode::getNumberNeighborCommunities()
@@ -126,7 +199,7 @@ int MetaNode::getNumberNeighborCommunities()
 
 int MetaNode::getNumberIntraTypeNeighbors()
 {
-        return _intraTypeNeighbors.size();
+        return _numberIntraTypeNeighbors;
 }
 
 int MetaNode::getNumberIntraTypeNeighborCommunities()
@@ -145,39 +218,32 @@ double MetaNode::getDegreeNeighborCommunities()
 
 double MetaNode::getWeightEdgesToNeighborCommunity(int communityId)
 {
-	auto search = _neighborCommunities.find(communityId);
-	if(search != _neighborCommunities.end())return _neighborCommunities[communityId];
-	else return 0.0;
+	return getEntryWeight(_neighborCommunities,communityId);
 }
 
 double MetaNode::getSimilarityToIntraTypeNeighborCommunity(int communityId)
 {
-        auto search = _intraTypeNeighborCommunities.find(communityId);
-        if(search != _intraTypeNeighborCommunities.end())return _intraTypeNeighborCommunities[communityId];
-        else return 0.0;
+        return getEntryWeight(_intraTypeNeighborCommunities,communityId);
 }
 
 
 double MetaNode::getWeightNeighbor(int id)
 {
-	auto search = _neighbors.find(id);
-	if(search != _neighbors.end())return _neighbors[id];
+	const int* search = std::lower_bound(_neighbors,_neighbors+_numberNeighbors,id);
+	if((search != _neighbors+_numberNeighbors)&&(*search == id))return _neighborWeights[search-_neighbors];
 	else return 0.0;
 }
 
 double MetaNode::getSimilarityIntraTypeNeighbor(int id)
 {
-        auto search = _intraTypeNeighbors.find(id);
-        if(search != _intraTypeNeighbors.end())return _intraTypeNeighbors[id];
-        else return 0.0;
+	const int* search = std::lower_bound(_intraTypeNeighbors,_intraTypeNeighbors+_numberIntraTypeNeighbors,id);
+	if((search != _intraTypeNeighbors+_numberIntraTypeNeighbors)&&(*search == id))return _intraTypeNeighborWeights[search-_intraTypeNeighbors];
+	else return 0.0;
 }
 
 double MetaNode::getSimilarityNode()
 {
-	double result = 0.0;
-        for(auto it=_intraTypeNeighbors.begin();it!=_intraTypeNeighbors.end();++it)
-                result += it->second;
-        return result;
+        return _similarity;
 }
 
 std::vector<int> MetaNode::getNeighborCommunities()
@@ -190,10 +256,7 @@ std::vector<int> MetaNode::getNeighborCommunities()
 
 std::vector<int> MetaNode::getIntraTypeNeighbors()
 {
-        std::vector<int> result;
-        for(auto it=_intraTypeNeighbors.begin();it!=_intraTypeNeighbors.end();++it)
-                result.push_back(it->first);
-        return result;
+        return std::vector<int>(_intraTypeNeighbors,_intraTypeNeighbors+_numberIntraTypeNeighbors);
 }
 
 std::vector<int> MetaNode::getIntraTypeNeighborCommunities()
@@ -221,9 +284,14 @@ void MetaNode::setNodes(std::vector<Node> nodes)
 	_nodes = nodes;
 }
 
-void MetaNode::setNeighbors(std::tr1::unordered_map<int,double> neighbors)
+void MetaNode::setNeighbors(const int* neighbors,const double* weights,int numberNeighbors)
 {
 	_neighbors = neighbors;
+	_neighborWeights = weights;
+	_numberNeighbors = numberNeighbors;
+	_degree = 0.0;
+	for(int i=0;i<numberNeighbors;i++)
+		_degree += weights[i];
 }
 
 void MetaNode::setCommunityId(int communityId)
@@ -231,85 +299,71 @@ void MetaNode::setCommunityId(int communityId)
 	_communityId = communityId;
 }
 
-void MetaNode::setNeighborCommunities(std::tr1::unordered_map<int,double> neighborCommunities)
+void MetaNode::setColor(int color)
 {
-	_neighborCommunities = neighborCommunities;
+	_color = color;
 }
 
-void MetaNode::setIntraTypeNeighbors(std::tr1::unordered_map<int,double> intraTypeNeighbors)
+void MetaNode::setIntraTypeNeighbors(const int* intraTypeNeighbors,const double* similarities,int numberIntraTypeNeighbors)
 {
         _intraTypeNeighbors = intraTypeNeighbors;
+	_intraTypeNeighborWeights = similarities;
+	_numberIntraTypeNeighbors = numberIntraTypeNeighbors;
+	_similarity = 0.0;
+	for(int i=0;i<numberIntraTypeNeighbors;i++)
+		_similarity += similarities[i];
+}
+
+void MetaNode::clearNeighborCommunities()
+{
+	_neighborCommunities.clear();
 }
 
-void MetaNode::setIntraTypeNeighborCommunities(std::tr1::unordered_map<int,double> intraTypeNeighborCommunities)
+void MetaNode::clearIntraTypeNeighborCommunities()
 {
-        _intraTypeNeighborCommunities = intraTypeNeighborCommunities;
+	_intraTypeNeighborCommunities.clear();
 }
 
 
 void MetaNode::deleteNeighborCommunity(int communityId)
 {
-	auto search = _neighborCommunities.find(communityId);
-	if(search != _neighborCommunities.end())
+	auto search = findEntry(_neighborCommunities,communityId);
+	if((search != _neighborCommunities.end())&&(search->first == communityId))
 	{
-		if(_neighborCommunities[communityId] == 1)_neighborCommunities.erase(communityId);
-		else if (_neighborCommunities[communityId] > 1) _neighborCommunities[communityId]--;
+		if(search->second == 1)_neighborCommunities.erase(search);
+		else if (search->second > 1) search->second--;
 	}
 }
 
 void MetaNode::deleteNeighborCommunityWeight(int communityId, double weight)
 {
-	auto search = _neighborCommunities.find(communityId);
-	if(search != _neighborCommunities.end())
-	{
-		if(_neighborCommunities[communityId] == weight) _neighborCommunities.erase(communityId);
-		else if (_neighborCommunities[communityId] > weight) _neighborCommunities[communityId] -=  weight;
-	}
+	deleteEntryWeight(_neighborCommunities,communityId,weight);
 }
 
 void MetaNode::deleteIntraTypeNeighborCommunitySimilarity(int communityId, double similarity)
 {
-        auto search = _intraTypeNeighborCommunities.find(communityId);
-        if(search != _intraTypeNeighborCommunities.end())
-        {
-                if(_intraTypeNeighborCommunities[communityId] == similarity) _intraTypeNeighborCommunities.erase(communityId);
-                else if (_intraTypeNeighborCommunities[communityId] > similarity) _intraTypeNeighborCommunities[communityId] -=  similarity;
-        }
-}
-
-void MetaNode::addNeighbor(int idNeighbor,double weight)
-{
-	if(_neighbors.find(idNeighbor) == _neighbors.end()) _neighbors[idNeighbor] = weight;
+        deleteEntryWeight(_intraTypeNeighborCommunities,communityId,similarity);
 }
 
 void MetaNode::addNeighborCommunity(int communityId)
 {
-	auto search = _neighborCommunities.find(communityId);
-	if(search != _neighborCommunities.end())_neighborCommunities[communityId]++;
-	else _neighborCommunities[communityId] = 1;
+	addEntryWeight(_neighborCommunities,communityId,1);
 }
 
 void MetaNode::addNeighborCommunityWeight(int communityId, double weight)
 {
-	auto search = _neighborCommunities.find(communityId);
-	if(search != _neighborCommunities.end())_neighborCommunities[communityId] += weight;
-	else _neighborCommunities[communityId] = weight;
+	addEntryWeight(_neighborCommunities,communityId,weight);
 }
 
 void MetaNode::addIntraTypeNeighborCommunitySimilarity(int communityId, double similarity)
 {
-        auto search = _intraTypeNeighborCommunities.find(communityId);
-        if(search != _intraTypeNeighborCommunities.end())_intraTypeNeighborCommunities[communityId] += similarity;
-        else _intraTypeNeighborCommunities[communityId] = similarity;
+        addEntryWeight(_intraTypeNeighborCommunities,communityId,similarity);
 }
 
 int MetaNode::findNeighborCommunity(int communityId)
 {
 	int result = 0;
-	auto search = _neighborCommunities.find(communityId);
-	if(search != _neighborCommunities.end())result = 1;
+	auto search = findEntry(_neighborCommunities,communityId);
+	if((search != _neighborCommunities.end())&&(search->first == communityId))result = 1;
 	return result;
 }
-
-
-
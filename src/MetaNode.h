@@ -43,6 +43,9 @@
 
 #include "Header.h"
 #include "Node.h"
+#include "Range.h"
+
+typedef Range<KeyIterator<std::vector<std::pair<int,double> >::const_iterator> > CommunityIdRange;
 
 class MetaNode
 
@@ -51,11 +54,20 @@ class MetaNode
 		int _idGraph;
 		std::string _type;
 		int _communityId;
+		int _color;
 		std::vector<Node>_nodes;
-		std::tr1::unordered_map<int,double> _neighbors;
-		std::tr1::unordered_map<int,double> _neighborCommunities;
-		std::tr1::unordered_map<int,double> _intraTypeNeighbors;
-		std::tr1::unordered_map<int,double> _intraTypeNeighborCommunities;	
+		//Views into the CSR arrays of the graph (see CSRAdjacency), sorted by neighbor id
+		const int* _neighbors;
+		const double* _neighborWeights;
+		int _numberNeighbors;
+		double _degree;
+		const int* _intraTypeNeighbors;
+		const double* _intraTypeNeighborWeights;
+		int _numberIntraTypeNeighbors;
+		double _similarity;
+		//(communityId,weight) pairs sorted by community id
+		std::vector<std::pair<int,double> > _neighborCommunities;
+		std::vector<std::pair<int,double> > _intraTypeNeighborCommunities;
 		struct CompareById {
 			bool operator()(Node i, Node j) {return (i.getIdInput() < j.getIdInput());}
 		}myobject;
@@ -63,15 +75,21 @@ class MetaNode
 			bool operator()(int i, int j) {return (i < j);}
 		}myobject2;
 
+		static std::vector<std::pair<int,double> >::iterator findEntry(std::vector<std::pair<int,double> > &entries,int id);
+		static double getEntryWeight(std::vector<std::pair<int,double> > &entries,int id);
+		static void addEntryWeight(std::vector<std::pair<int,double> > &entries,int id,double weight);
+		static void deleteEntryWeight(std::vector<std::pair<int,double> > &entries,int id,double weight);
+
 
 	public:
 		MetaNode();
-		MetaNode(int id, std::string type, std::vector<Node> nodes,std::tr1::unordered_map<int,double> neighbors,int communityId);
+		MetaNode(int id, std::string type, std::vector<Node> nodes,int communityId);
 
 		/* Get functions */
 		int getId();
 		std::string getType();
 		int getCommunityId();
+		int getColor();
 		int getNumberNodes();
 		std::vector<Node> getNodes();
 		std::vector<Node> getNodesSorted();
@@ -81,6 +99,16 @@ class MetaNode
 		std::vector<int> getNeighborCommunities();
                 std::vector<int> getIntraTypeNeighbors();
                 std::vector<int> getIntraTypeNeighborCommunities();
+		//Views that do not copy; invalidated when the neighbors or neighbor communities change
+		IdRange getNeighborsRange();
+		IdRange getIntraTypeNeighborsRange();
+		CommunityIdRange getNeighborCommunitiesRange();
+		CommunityIdRange getIntraTypeNeighborCommunitiesRange();
+		const std::vector<Node>& getNodesReference();
+		const int* getNeighborIds();
+		const double* getNeighborWeights();
+		const int* getIntraTypeNeighborIds();
+		const double* getIntraTypeNeighborWeights();
 
 		int getNumberNeighbors();
 		int getNumberNeighborCommunities();
@@ -100,15 +128,15 @@ class MetaNode
 		void setId(int id);
 		void setType(std::string type);
 		void setNodes(std::vector<Node> nodes);
-		void setNeighbors(std::tr1::unordered_map<int,double> neighbors);
+		void setNeighbors(const int* neighbors,const double* weights,int numberNeighbors);
 		void setCommunityId(int communityId);
-		void setNeighborCommunities(std::tr1::unordered_map<int,double> neighborCommunities);
-		void setIntraTypeNeighbors(std::tr1::unordered_map<int,double> intraTypeNeighbors);
-		void setIntraTypeNeighborCommunities(std::tr1::unordered_map<int,double> intraTypeNeighborCommunities);
+		void setColor(int color);
+		void setIntraTypeNeighbors(const int* intraTypeNeighbors,const double* similarities,int numberIntraTypeNeighbors);
+		void clearNeighborCommunities();
+		void clearIntraTypeNeighborCommunities();
 		void deleteNeighborCommunity(int communityId);
 		void deleteNeighborCommunityWeight(int communityId, double weight);
 		void deleteIntraTypeNeighborCommunitySimilarity(int communityId, double similarity);
-		void addNeighbor(int idNeighbor,double weight);
 		void addNeighborCommunity(int communityId);
 		void addIntraTypeNeighborCommunitySimilarity(int communityId, double similarity);
 		void addNeighborCommunityWeight(int communityId, double weight);
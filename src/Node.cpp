@@ -41,17 +41,17 @@ Node::Node(int idInput, std::string type, int color)
 }
 
 /* GETTERS */
-int Node::getIdInput()
+int Node::getIdInput() const
 {
 	return _idInput;
 }
 
-std::string Node::getType()
+std::string Node::getType() const
 {
 	return _type;
 }
 
-int Node::getColor()
+int Node::getColor() const
 {
 	return _color;
 }
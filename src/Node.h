@@ -54,9 +54,9 @@ class Node
 		Node(int idInput, std::string type, int color);
 
 		/* Get functions */
-		int getIdInput();
-		std::string getType();
-		int getColor();
+		int getIdInput() const;
+		std::string getType() const;
+		int getColor() const;
 
 		/* Set procedures */
 		void setIdInput(int id);
@@ -0,0 +1,255 @@
+// **************************************************************************************************
+// biLouvain: A C++ library for bipartite graph community detection
+// Paola Gabriela Pesantez-Cabrera, Ananth Kalyanaraman
+//      (p.pesantezcabrera@wsu.edu, ananth@eecs.wsu.edu)
+// Washington State University
+//
+// For citation, please cite the following paper:
+// Pesantez, Paola and Kalyanaraman, Ananth, "Detecting Communities in Biological
+// Bipartite Networks," Proc. ACM Conference on Bioinformatics, Computational Biology,
+// and Health Informatics (ACM-BCB), Seattle, WA, October 2-5, 2016, In press,
+// DOI: http://dx.doi.org/10.1145/2975167.2975177.
+//
+// **************************************************************************************************
+// Copyright (c) 2016. Washington State University ("WSU"). All Rights Reserved.
+// Permission to use, copy, modify, and distribute this software and its documentation
+// for educational, research, and not-for-profit purposes, without fee, is hereby
+// granted, provided that the above copyright notice, this paragraph and the following
+// two paragraphs appear in all copies, modifications, and distributions. For
+// commercial licensing opportunities, please contact The Office of Commercialization,
+// WSU, 280/286 Lighty, PB Box 641060, Pullman, WA 99164, (509) 335-5526,
+// commercialization@wsu.edu<mailto:commercialization@wsu.edu>, https://commercialization.wsu.edu/
+
+// IN NO EVENT SHALL WSU BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT, SPECIAL, INCIDENTAL,
+// OR CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF
+// THIS SOFTWARE AND ITS DOCUMENTATION, EVEN IF WSU HAS BEEN ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// WSU SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. THE SOFTWARE AND
+// ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS PROVIDED "AS IS". WSU HAS NO
+// OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+// **************************************************************************************************
+
+
+/*
+# PhaseCheckpoint.h
+# Binary checkpoint written by biLouvainMethodAlgorithm after every compaction: the compacted graph (CSR rows and
+# the input nodes of every metanode), the number of the next phase, the modularity reached so far, the lines already
+# written to the modularity file, the community hierarchy of the finished phases and the state of the random generator. A run started again with -resume continues
+# from the next phase instead of loading and clustering the input graph again.
+*/
+
+#ifndef PHASECHECKPOINT_H_
+#define PHASECHECKPOINT_H_
+#include "Header.h"
+#include "BinaryFile.h"
+#include "Graph.h"
+#include "Dendrogram.h"
+
+//What biLouvainMethodAlgorithm needs, besides the graph, to continue from the phase after the checkpoint
+struct phaseCheckpointState
+{
+	int phase;
+	double totalModularity;
+	double phaseModularity;
+	double alpha;
+	unsigned long long randomState[4];
+	std::string modularityLog;
+	Dendrogram dendrogram;
+};
+
+class PhaseCheckpoint
+{
+  private:
+	static const int VERSION = 2;
+
+	struct Header
+	{
+		char magic[8];
+		int version;
+		int phase;
+		long long numberNodes;
+		long long numberEdges;
+		long long lastIdPartitionV1;
+		long long numberEntries;
+		long long numberIntraTypeEntries;
+		long long numberMembers;
+		long long logSize;
+		long long numberLeaves;
+		long long numberLevels;
+		long long numberParents;
+		double weightEdges;
+		double weightEdgesV1;
+		double weightEdgesV2;
+		double lambdaV1;
+		double lambdaV2;
+		double sumSimilarityV1;
+		double sumSimilarityV2;
+		double totalModularity;
+		double phaseModularity;
+		double alpha;
+		unsigned long long randomState[4];
+	};
+
+	//Copies the next array of the file into values and moves position past its padding
+	template <typename T>
+	static void readArray(const std::vector<char> &data,size_t &position,std::vector<T> &values,size_t count)
+	{
+		values.resize(count);
+		if(count > 0)
+			memcpy(values.data(),data.data()+position,count*sizeof(T));
+		position += BinaryFile::alignedSize(count*sizeof(T));
+	}
+
+  public:
+
+	//The file is written next to its final name and renamed, so a run stopped while writing keeps the previous checkpoint
+	int static writePhaseCheckpoint(Graph &g,const phaseCheckpointState &state,const std::string &checkpointFileName)
+	{
+		std::string temporaryFileName = checkpointFileName + ".tmp";
+		std::ofstream outputFile(temporaryFileName.c_str(),std::ios::out|std::ios::binary|std::ios::trunc);
+		if(outputFile.is_open() == false)
+			return -1;
+		CSRAdjacency* adjacency = g.getAdjacency();
+		MetaNode* metaNodes = g.getGraph();
+		int numberNodes = g.getNumberNodes();
+		std::vector<int> memberOffsets(numberNodes+1,0);
+		std::vector<int> members;
+		for(int i=0;i<numberNodes;i++)
+		{
+			const std::vector<Node> &nodes = metaNodes[i].getNodesReference();
+			for(unsigned int k=0;k<nodes.size();k++)
+				members.push_back(nodes[k].getIdInput());
+			memberOffsets[i+1] = members.size();
+		}
+		Header header;
+		memset(&header,0,sizeof(header));
+		memcpy(header.magic,"BILVCKPT",8);
+		header.version = VERSION;
+		header.phase = state.phase;
+		header.numberNodes = numberNodes;
+		header.numberEdges = g.getNumberEdges();
+		header.lastIdPartitionV1 = g.getLastIdPartitionV1();
+		header.numberEntries = adjacency->getNumberEntries();
+		header.numberIntraTypeEntries = adjacency->getNumberIntraTypeEntries();
+		header.numberMembers = members.size();
+		header.logSize = state.modularityLog.size();
+		header.numberLeaves = state.dendrogram.getNumberInputNodes();
+		header.numberLevels = state.dendrogram.getNumberLevels();
+		header.numberParents = state.dendrogram.getParents().size();
+		header.weightEdges = g.getWeightEdges();
+		header.weightEdgesV1 = g.getWeightEdgesV1();
+		header.weightEdgesV2 = g.getWeightEdgesV2();
+		header.lambdaV1 = g.getLambdaV1();
+		header.lambdaV2 = g.getLambdaV2();
+		header.sumSimilarityV1 = g.getSimilarityV1();
+		header.sumSimilarityV2 = g.getSimilarityV2();
+		header.totalModularity = state.totalModularity;
+		header.phaseModularity = state.phaseModularity;
+		header.alpha = state.alpha;
+		memcpy(header.randomState,state.randomState,sizeof(header.randomState));
+		BinaryFile::writeArray(outputFile,&header,sizeof(header));
+		BinaryFile::writeArray(outputFile,adjacency->getOffsets(),(numberNodes+1)*sizeof(int));
+		BinaryFile::writeArray(outputFile,adjacency->getNeighbors(0),header.numberEntries*sizeof(int));
+		BinaryFile::writeArray(outputFile,adjacency->getWeights(0),header.numberEntries*sizeof(double));
+		BinaryFile::writeArray(outputFile,adjacency->getIntraTypeOffsets(),(numberNodes+1)*sizeof(int));
+		BinaryFile::writeArray(outputFile,adjacency->getIntraTypeNeighbors(0),header.numberIntraTypeEntries*sizeof(int));
+		BinaryFile::writeArray(outputFile,adjacency->getIntraTypeWeights(0),header.numberIntraTypeEntries*sizeof(double));
+		BinaryFile::writeArray(outputFile,memberOffsets.data(),(numberNodes+1)*sizeof(int));
+		BinaryFile::writeArray(outputFile,members.data(),members.size()*sizeof(int));
+		BinaryFile::writeArray(outputFile,state.modularityLog.data(),state.modularityLog.size());
+		BinaryFile::writeArray(outputFile,state.dendrogram.getLeaves().data(),header.numberLeaves*sizeof(int));
+		BinaryFile::writeArray(outputFile,state.dendrogram.getLevelOffsets().data(),(header.numberLevels+1)*sizeof(long long));
+		BinaryFile::writeArray(outputFile,state.dendrogram.getParents().data(),header.numberParents*sizeof(int));
+		BinaryFile::writeArray(outputFile,state.dendrogram.getModularities().data(),header.numberLevels*sizeof(double));
+		outputFile.close();
+		if(outputFile.fail()||(rename(temporaryFileName.c_str(),checkpointFileName.c_str()) != 0))
+		{
+			remove(temporaryFileName.c_str());
+			return -1;
+		}
+		return 0;
+	}
+
+	//Builds the compacted graph of the checkpoint and fills state. Returns -1 when the file is missing or is not a
+	//valid checkpoint.
+	int static loadPhaseCheckpoint(Graph* &g,phaseCheckpointState &state,const std::string &checkpointFileName)
+	{
+		std::ifstream inputFile(checkpointFileName.c_str(),std::ios::in|std::ios::binary);
+		if(inputFile.is_open() == false)
+			return -1;
+		std::vector<char> data((std::istreambuf_iterator<char>(inputFile)),std::istreambuf_iterator<char>());
+		inputFile.close();
+		if(data.size() < sizeof(Header))
+			return -1;
+		Header header;
+		memcpy(&header,data.data(),sizeof(header));
+		size_t offsetsSize = BinaryFile::alignedSize((header.numberNodes+1)*sizeof(int));
+		size_t expectedSize = BinaryFile::alignedSize(sizeof(Header)) + 3*offsetsSize + BinaryFile::alignedSize(header.numberEntries*sizeof(int)) + BinaryFile::alignedSize(header.numberEntries*sizeof(double)) + BinaryFile::alignedSize(header.numberIntraTypeEntries*sizeof(int)) + BinaryFile::alignedSize(header.numberIntraTypeEntries*sizeof(double)) + BinaryFile::alignedSize(header.numberMembers*sizeof(int)) + BinaryFile::alignedSize(header.logSize) + BinaryFile::alignedSize(header.numberLeaves*sizeof(int)) + BinaryFile::alignedSize((header.numberLevels+1)*sizeof(long long)) + BinaryFile::alignedSize(header.numberParents*sizeof(int)) + BinaryFile::alignedSize(header.numberLevels*sizeof(double));
+		if((memcmp(header.magic,"BILVCKPT",8) != 0)||(header.version != VERSION)||(header.numberNodes <= 0)||(header.numberLevels < 0)||(expectedSize != data.size()))
+		{
+			printf("\n ::: %s is not a valid phase checkpoint :::",checkpointFileName.c_str());
+			return -1;
+		}
+		int _numberNodes = header.numberNodes;
+		int _numberEdges = header.numberEdges;
+		int _lastIdPartitionV1 = header.lastIdPartitionV1;
+		double _weightEdges = header.weightEdges;
+		double _weightEdgesV1 = header.weightEdgesV1;
+		double _weightEdgesV2 = header.weightEdgesV2;
+		size_t position = BinaryFile::alignedSize(sizeof(Header));
+		std::vector<int> offsets, neighbors, intraTypeOffsets, intraTypeNeighbors, memberOffsets, members;
+		std::vector<double> weights, intraTypeWeights;
+		std::vector<char> log;
+		std::vector<int> leaves, parents;
+		std::vector<long long> levelOffsets;
+		std::vector<double> levelModularity;
+		readArray(data,position,offsets,_numberNodes+1);
+		readArray(data,position,neighbors,header.numberEntries);
+		readArray(data,position,weights,header.numberEntries);
+		readArray(data,position,intraTypeOffsets,_numberNodes+1);
+		readArray(data,position,intraTypeNeighbors,header.numberIntraTypeEntries);
+		readArray(data,position,intraTypeWeights,header.numberIntraTypeEntries);
+		readArray(data,position,memberOffsets,_numberNodes+1);
+		readArray(data,position,members,header.numberMembers);
+		readArray(data,position,log,header.logSize);
+		readArray(data,position,leaves,header.numberLeaves);
+		readArray(data,position,levelOffsets,header.numberLevels+1);
+		readArray(data,position,parents,header.numberParents);
+		readArray(data,position,levelModularity,header.numberLevels);
+		std::vector<char>().swap(data);
+
+		CSRAdjacency* _adjacency = new CSRAdjacency(_numberNodes);
+		_adjacency->setNeighborRows(_numberNodes,offsets,neighbors,weights);
+		_adjacency->setIntraTypeNeighborRows(intraTypeOffsets,intraTypeNeighbors,intraTypeWeights);
+		MetaNode* _graph = new MetaNode[_numberNodes];
+		std::vector<Node> nodes;
+		for(int i=0;i<_numberNodes;i++)
+		{
+			std::string type = (i <= _lastIdPartitionV1) ? "V1" : "V2";
+			for(int k=memberOffsets[i];k<memberOffsets[i+1];k++)
+				nodes.push_back(Node(members[k],type,0));
+			_graph[i] = MetaNode(i,type,nodes,-1);
+			nodes.clear();
+		}
+		g = new Graph(_graph,_adjacency,_numberNodes,_numberEdges,_weightEdges,_weightEdgesV1,_weightEdgesV2,_lastIdPartitionV1);
+		g->setLambdaV1(header.lambdaV1);
+		g->setLambdaV2(header.lambdaV2);
+		g->setSimilarityV1(header.sumSimilarityV1);
+		g->setSimilarityV2(header.sumSimilarityV2);
+		g->bindAdjacency();
+
+		state.phase = header.phase;
+		state.totalModularity = header.totalModularity;
+		state.phaseModularity = header.phaseModularity;
+		state.alpha = header.alpha;
+		memcpy(state.randomState,header.randomState,sizeof(state.randomState));
+		state.modularityLog.assign(log.begin(),log.end());
+		state.dendrogram.setLevels(leaves,levelOffsets,parents,levelModularity);
+		return 0;
+	}
+
+};
+
+#endif /* PHASECHECKPOINT_H_ */
@@ -42,12 +42,57 @@
 
 #include "Header.h"
 #include "StringSplitter.h"
+#include "LabelTable.h"
+
+//Edges of a preprocessed input kept in memory, in the layout expected by LoadGraph::loadBipartiteGraphFromEdges
+struct BipartiteEdges
+{
+	std::vector<int> sources;
+	std::vector<int> targets;
+	std::vector<double> weights;
+	int maximumId;
+	int lastIdPartitionV1;
+	bool loaded;
+
+	BipartiteEdges():maximumId(0),lastIdPartitionV1(0),loaded(false){}
+};
 
 class PreProcessInputBipartiteGraph
 {
+	private:
+	static const int BLOCK_SIZE = 64 << 20;		//bytes read from the input file or written to the output files at a time
+
+	//Writes the shortest of %.15g and %.17g that reads back as the same value
+	static void appendWeight(std::string &output,double value)
+	{
+		if((value == (double)(long long)value)&&(fabs(value) < 1e15))
+		{
+			StringSplitter::appendInt(output,(long long)value);
+			return;
+		}
+		char text[32];
+		int length = snprintf(text,sizeof(text),"%.15g",value);
+		if(strtod(text,NULL) != value)
+			length = snprintf(text,sizeof(text),"%.17g",value);
+		output.append(text,length);
+	}
+
+	static void flush(std::ofstream &outputFile,std::string &output,bool force)
+	{
+		if((force)||(output.size() >= (size_t)BLOCK_SIZE))
+		{
+			outputFile.write(output.data(),output.size());
+			output.clear();
+		}
+	}
+
 	public:
 
-	std::tr1::unordered_map<int,std::string> static preProcessingGraphData(const std::string &inputFileName, const std::string &delimiter)
+	//Reads the input once, in blocks. Labels are interned as they appear; once the whole file has been read the labels
+	//seen in the first column get the ids 0.. in order of first appearance and the remaining labels of the second column
+	//follow, as the two passes used before did. When edges is given the graph is also returned in memory so it does not
+	//need to be read back from the bipartite file.
+	std::tr1::unordered_map<int,std::string> static preProcessingGraphData(const std::string &inputFileName, const std::string &delimiter, BipartiteEdges* edges = NULL)
 	{
 		std::tr1::unordered_map<int,std::string> bipartiteOriginalEntities;
 		int pos = inputFileName.find_last_of(".");
@@ -57,79 +102,148 @@ class PreProcessInputBipartiteGraph
 		if(bipartiteFile.is_open()==false)
                 {
                 	printf("\n ::: Reading and Preprocessing Input File...%s  Please Wait... :::",inputFileName.c_str());
-			std::ifstream inputFile(inputFileName.c_str());
-			std::string line = "";
-			while(inputFile.good())
-                        {
-                        	getline(inputFile,line);
-                              	int location = line.find(delimiter);
-                        	if(location == std::string::npos) 
+			std::ifstream inputFile(inputFileName.c_str(),std::ios::in|std::ios::binary);
+			const char separator = delimiter[0];
+			LabelTable labels;
+			std::vector<int> edgeSources;
+			std::vector<int> edgeTargets;
+			std::vector<double> edgeWeights;
+			std::vector<int> sourceOrder;		//labels in order of first appearance in the first column
+			std::vector<int> targetOrder;		//labels in order of first appearance in the second column
+			std::vector<char> isSource;
+			std::vector<char> isTarget;
+			std::vector<char> buffer(BLOCK_SIZE);
+			size_t carried = 0;			//bytes of an incomplete line kept from the previous block
+			bool lastBlock = false;
+			while(!lastBlock)
+			{
+				if(carried == buffer.size())		//a line longer than the block
+					buffer.resize(buffer.size()*2);
+				inputFile.read(&buffer[carried],buffer.size()-carried);
+				size_t size = carried + inputFile.gcount();
+				lastBlock = !inputFile.good();
+				const char* p = buffer.data();
+				const char* end = p + size;
+				while(p < end)
 				{
-					printf("\n ::: Given delimiter doesn't agree with delimiter being used in file :::\n");
-	                                exit(EXIT_FAILURE);
+					const char* lineEnd = (const char*)memchr(p,'\n',end-p);
+					if(lineEnd == NULL)
+					{
+						if(!lastBlock)break;
+						lineEnd = end;
+					}
+					const char* contentEnd = lineEnd;
+					if((contentEnd > p)&&(contentEnd[-1] == '\r'))contentEnd--;
+					if(p < contentEnd)
+					{
+						const char* first = (const char*)memchr(p,separator,contentEnd-p);
+						if(first == NULL)
+						{
+							printf("\n ::: Given delimiter doesn't agree with delimiter being used in file :::\n");
+							exit(EXIT_FAILURE);
+						}
+						const char* second = (const char*)memchr(first+1,separator,contentEnd-(first+1));
+						const char* targetEnd = (second == NULL) ? contentEnd : second;
+						double weight = 1.0;
+						if((second != NULL)&&(memchr(second+1,separator,contentEnd-(second+1)) == NULL))
+							StringSplitter::parseDouble(second+1,contentEnd,weight);
+						int source = labels.intern(p,first-p);
+						int target = labels.intern(first+1,targetEnd-(first+1));
+						isSource.resize(labels.size(),0);
+						isTarget.resize(labels.size(),0);
+						if(!isSource[source])
+						{
+							isSource[source] = 1;
+							sourceOrder.push_back(source);
+						}
+						if(!isTarget[target])
+						{
+							isTarget[target] = 1;
+							targetOrder.push_back(target);
+						}
+						edgeSources.push_back(source);
+						edgeTargets.push_back(target);
+						edgeWeights.push_back(weight);
+					}
+					p = lineEnd + 1;
 				}
-				break;
+				carried = (p < end) ? end - p : 0;
+				if(carried > 0)
+					memmove(buffer.data(),p,carried);
 			}
-			inputFile.clear();
-                        inputFile.seekg(0, std::ios::beg);					
-			std::tr1::unordered_map<std::string,int> bipartiteIds;
+			inputFile.close();
+			std::vector<char>().swap(buffer);
+			std::vector<char>().swap(isSource);
+			std::vector<char>().swap(isTarget);
+			std::vector<int> ids(labels.size(),-1);
+			int cont = 0;
+			for(unsigned int i=0;i<sourceOrder.size();i++)
+				ids[sourceOrder[i]] = cont++;
+			for(unsigned int i=0;i<targetOrder.size();i++)
+				if(ids[targetOrder[i]] == -1)
+					ids[targetOrder[i]] = cont++;
+			std::vector<int> labelOfId(cont);
+			for(int i=0;i<labels.size();i++)
+				labelOfId[ids[i]] = i;
 			std::ofstream bipartiteOFile;
 			std::ofstream dictionaryFile;
-			dictionaryFile.open(dictionaryFileName.c_str(),std::ios::out|std::ios::trunc);
-			bipartiteOFile.open(bipartiteFileName.c_str(),std::ios::out|std::ios::trunc);
-			int cont = 0;
-			std::string *pieces;
-                        int items = 0;
-			std::stringstream entry;	
-			while(inputFile.good())
+			dictionaryFile.open(dictionaryFileName.c_str(),std::ios::out|std::ios::binary|std::ios::trunc);
+			bipartiteOFile.open(bipartiteFileName.c_str(),std::ios::out|std::ios::binary|std::ios::trunc);
+			std::string output;
+			output.reserve(BLOCK_SIZE + 4096);
+			for(int id=0;id<cont;id++)
 			{
-				getline(inputFile,line);
-				if(inputFile.eof())break;
-				pieces = StringSplitter::split(line,delimiter,items);
-				//std::cout<<"\n" << pieces[0] <<"   " << items;
-				if(bipartiteIds.find(pieces[0].c_str()) == bipartiteIds.end())
-				//if(bipartiteOriginalEntities.end() == find_if(bipartiteOriginalEntities.begin(),bipartiteOriginalEntities.end(),[&value](const map_value_type& vt){ return vt.second == pieces[0]}))
-				{
-					bipartiteIds[pieces[0]] = cont;	
-					bipartiteOriginalEntities[cont] = pieces[0];
-					entry.str("");
-					entry << cont << "\t" << pieces[0] << "\n";
-					dictionaryFile << entry.str();
-					cont++;
-				}
+				const char* label = labels.getLabel(labelOfId[id]);
+				int length = labels.getLength(labelOfId[id]);
+				bipartiteOriginalEntities[id] = std::string(label,length);
+				StringSplitter::appendInt(output,id);
+				output.push_back('\t');
+				output.append(label,length);
+				output.push_back('\n');
+				flush(dictionaryFile,output,false);
+			}
+			flush(dictionaryFile,output,true);
+			dictionaryFile.close();
+			if(edges != NULL)
+			{
+				edges->sources.clear();
+				edges->targets.clear();
+				edges->weights.clear();
+				edges->sources.reserve(2*edgeSources.size());
+				edges->targets.reserve(2*edgeSources.size());
+				edges->weights.reserve(2*edgeSources.size());
+				edges->maximumId = 0;
+				edges->lastIdPartitionV1 = 0;
 			}
-			inputFile.clear();
-			inputFile.seekg(0,std::ios::beg);
-			while(inputFile.good())
+			for(unsigned int i=0;i<edgeSources.size();i++)
 			{
-				std::stringstream edge;
-				getline(inputFile,line);
-				if(inputFile.eof())break;
-				pieces = StringSplitter::split(line,delimiter,items);
-				//std::cout<<"\n" << pieces[1];
-				//if(bipartiteOriginalEntities.end() == find_if(bipartiteOriginalEntities.begin(),bipartiteOriginalEntities.end(),[&value](const map_value_type& vt){ return vt.second == pieces[1]}))
-				if(bipartiteIds.find(pieces[1].c_str()) == bipartiteIds.end())
+				int source = ids[edgeSources[i]];
+				int target = ids[edgeTargets[i]];
+				StringSplitter::appendInt(output,source);
+				output.push_back('\t');
+				StringSplitter::appendInt(output,target);
+				output.push_back('\t');
+				appendWeight(output,edgeWeights[i]);
+				output.push_back('\n');
+				flush(bipartiteOFile,output,false);
+				if(edges != NULL)
 				{
-					bipartiteIds[pieces[1]] = cont;
-					bipartiteOriginalEntities[cont] = pieces[1];
-					entry.str("");
-					entry << cont << "\t" << pieces[1] << "\n";
-					dictionaryFile << entry.str();
-					cont++;
+					edges->sources.push_back(source);
+					edges->targets.push_back(target);
+					edges->weights.push_back(edgeWeights[i]);
+					edges->sources.push_back(target);
+					edges->targets.push_back(source);
+					edges->weights.push_back(edgeWeights[i]);
+					if(target > edges->maximumId)
+						edges->maximumId = target;
+					if(source > edges->lastIdPartitionV1)
+						edges->lastIdPartitionV1 = source;
 				}
-				edge.str("");
-				//edge.precision(15);
-				if(items == 3)
-					edge << bipartiteIds[pieces[0]] << "\t" << bipartiteIds[pieces[1]] << "\t" << pieces[2] << "\n";
-				else
-					edge << bipartiteIds[pieces[0]] << "\t" << bipartiteIds[pieces[1]] << "\t1" << "\n";
-				bipartiteOFile << edge.str();
 			}
-			inputFile.close();
-			dictionaryFile.close();
+			flush(bipartiteOFile,output,true);
 			bipartiteOFile.close();
-			bipartiteIds.clear();
-			delete[] pieces;	
+			if(edges != NULL)
+				edges->loaded = true;
 		}
 		else
 			bipartiteOriginalEntities = readDictionaryFile(bipartiteFileName);
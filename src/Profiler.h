@@ -0,0 +1,265 @@
+// **************************************************************************************************
+// biLouvain: A C++ library for bipartite graph community detection
+// Paola Gabriela Pesantez-Cabrera, Ananth Kalyanaraman
+//      (p.pesantezcabrera@wsu.edu, ananth@eecs.wsu.edu)
+// Washington State University
+//
+// For citation, please cite the following paper:
+// Pesantez, Paola and Kalyanaraman, Ananth, "Detecting Communities in Biological
+// Bipartite Networks," Proc. ACM Conference on Bioinformatics, Computational Biology,
+// and Health Informatics (ACM-BCB), Seattle, WA, October 2-5, 2016, In press,
+// DOI: http://dx.doi.org/10.1145/2975167.2975177.
+//
+// **************************************************************************************************
+// Copyright (c) 2016. Washington State University ("WSU"). All Rights Reserved.
+// Permission to use, copy, modify, and distribute this software and its documentation
+// for educational, research, and not-for-profit purposes, without fee, is hereby
+// granted, provided that the above copyright notice, this paragraph and the following
+// two paragraphs appear in all copies, modifications, and distributions. For
+// commercial licensing opportunities, please contact The Office of Commercialization,
+// WSU, 280/286 Lighty, PB Box 641060, Pullman, WA 99164, (509) 335-5526,
+// commercialization@wsu.edu<mailto:commercialization@wsu.edu>, https://commercialization.wsu.edu/
+
+// IN NO EVENT SHALL WSU BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT, SPECIAL, INCIDENTAL,
+// OR CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF
+// THIS SOFTWARE AND ITS DOCUMENTATION, EVEN IF WSU HAS BEEN ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// WSU SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. THE SOFTWARE AND
+// ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS PROVIDED "AS IS". WSU HAS NO
+// OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+// **************************************************************************************************
+
+
+/*
+# Profiler.h
+# Low overhead instrumentation of the biLouvain hot path. Every thread adds counters and clock ticks to its own padded
+# slot; the slots are added up at the end of every step (initialization, iteration, compaction) of a phase and the
+# steps are written as CSV. Everything is compiled out unless BILOUVAIN_PROFILE is defined (see makefile).
+*/
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include "Header.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+enum profileCounter
+{
+	PROFILE_VERTICES_EVALUATED,
+	PROFILE_CANDIDATES_SCORED,
+	PROFILE_CANDIDATES_PRUNED,
+	PROFILE_MOVES_ACCEPTED,
+	PROFILE_CONFLICT_RESCORES,
+	PROFILE_MURATA_EVALUATIONS,
+	PROFILE_NUMBER_COUNTERS
+};
+
+//Nested stages are included in their parent: candidates and gain in scoring, the precalculations and murata in gain
+enum profileStage
+{
+	PROFILE_STAGE_INITIAL_COMMUNITIES,
+	PROFILE_STAGE_NEIGHBOR_COMMUNITIES,
+	PROFILE_STAGE_COCLUSTER_MATES,
+	PROFILE_STAGE_ORDER,
+	PROFILE_STAGE_CANDIDATES,
+	PROFILE_STAGE_GAIN,
+	PROFILE_STAGE_PRECALCULATION_CI,
+	PROFILE_STAGE_PRECALCULATION_CJ,
+	PROFILE_STAGE_PRECALCULATION_D,
+	PROFILE_STAGE_MURATA,
+	PROFILE_STAGE_UPDATE,
+	PROFILE_STAGE_COMPACTION,
+	PROFILE_NUMBER_STAGES
+};
+
+//Monotonic clock: the time stamp counter where available, nanoseconds of CLOCK_MONOTONIC otherwise
+inline unsigned long long profileClock()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC,&now);
+	return (unsigned long long)now.tv_sec*1000000000ULL + now.tv_nsec;
+#endif
+}
+
+inline unsigned long long profileMonotonicNanoseconds()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC,&now);
+	return (unsigned long long)now.tv_sec*1000000000ULL + now.tv_nsec;
+}
+
+//Counters of one thread, padded so threads never share a cache line
+struct alignas(64) profileSlot
+{
+	unsigned long long counters[PROFILE_NUMBER_COUNTERS];
+	unsigned long long ticks[PROFILE_NUMBER_STAGES];
+};
+
+struct profileStep
+{
+	int phase;
+	std::string step;
+	unsigned long long wallTicks;
+	unsigned long long counters[PROFILE_NUMBER_COUNTERS];
+	unsigned long long ticks[PROFILE_NUMBER_STAGES];
+	long long heapBytes;
+};
+
+class Profiler
+{
+	private:
+		std::vector<profileSlot> _slots;
+		std::vector<profileStep> _steps;
+		unsigned long long _totalTicks[PROFILE_NUMBER_STAGES];
+		unsigned long long _startTicks;
+		unsigned long long _startNanoseconds;
+		unsigned long long _stepStartTicks;
+
+		static long long heapBytesInUse()
+		{
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+			struct mallinfo2 info = mallinfo2();
+			return (long long)(info.uordblks + info.hblkhd);
+#else
+			return -1;
+#endif
+		}
+
+	public:
+		Profiler()
+		{
+			reset(1);
+		}
+
+		//Clears the steps and sizes the slots for numberThreads threads
+		void reset(int numberThreads)
+		{
+			_slots.assign(std::max(numberThreads,omp_get_max_threads()),profileSlot());
+			for(unsigned int i=0;i<_slots.size();i++)
+				memset(&_slots[i],0,sizeof(profileSlot));
+			_steps.clear();
+			memset(_totalTicks,0,sizeof(_totalTicks));
+			_startTicks = profileClock();
+			_startNanoseconds = profileMonotonicNanoseconds();
+			_stepStartTicks = _startTicks;
+		}
+
+		void count(profileCounter counter,unsigned long long value)
+		{
+			_slots[omp_get_thread_num()].counters[counter] += value;
+		}
+
+		void addTicks(profileStage stage,unsigned long long ticks)
+		{
+			_slots[omp_get_thread_num()].ticks[stage] += ticks;
+		}
+
+		//Closes the current step: the slots are added up into a new step and cleared
+		void endStep(int phase,const std::string &step)
+		{
+			profileStep result;
+			unsigned long long now = profileClock();
+			result.phase = phase;
+			result.step = step;
+			result.wallTicks = now - _stepStartTicks;
+			memset(result.counters,0,sizeof(result.counters));
+			memset(result.ticks,0,sizeof(result.ticks));
+			for(unsigned int i=0;i<_slots.size();i++)
+			{
+				for(int c=0;c<PROFILE_NUMBER_COUNTERS;c++)
+					result.counters[c] += _slots[i].counters[c];
+				for(int s=0;s<PROFILE_NUMBER_STAGES;s++)
+					result.ticks[s] += _slots[i].ticks[s];
+				memset(&_slots[i],0,sizeof(profileSlot));
+			}
+			for(int s=0;s<PROFILE_NUMBER_STAGES;s++)
+				_totalTicks[s] += result.ticks[s];
+			result.heapBytes = heapBytesInUse();
+			_steps.push_back(result);
+			_stepStartTicks = profileClock();
+		}
+
+		//Clock ticks per second, measured against CLOCK_MONOTONIC since the last reset
+		double ticksPerSecond()
+		{
+#if defined(__x86_64__) || defined(__i386__)
+			unsigned long long ticks = profileClock() - _startTicks;
+			unsigned long long nanoseconds = profileMonotonicNanoseconds() - _startNanoseconds;
+			if(nanoseconds == 0)
+				return 1e9;
+			return (double)ticks*1e9/(double)nanoseconds;
+#else
+			return 1e9;
+#endif
+		}
+
+		int getNumberSteps()
+		{
+			return _steps.size();
+		}
+
+		const profileStep& getStep(int step)
+		{
+			return _steps[step];
+		}
+
+		//Time of a stage over all the steps since the last reset, added up over the threads
+		double stageMicroseconds(profileStage stage)
+		{
+			return (double)_totalTicks[stage]*1e6/ticksPerSecond();
+		}
+
+		bool writeCSV(const std::string &fileName)
+		{
+			static const char* counterNames[PROFILE_NUMBER_COUNTERS] = {"verticesEvaluated","candidatesScored","candidatesPruned","movesAccepted","conflictRescores","murataEvaluations"};
+			static const char* stageNames[PROFILE_NUMBER_STAGES] = {"initialCommunities","neighborCommunities","coClusterMates","order","candidates","gain","precalculationCi","precalculationCj","precalculationD","murata","update","compaction"};
+			FILE* file = fopen(fileName.c_str(),"w");
+			if(file == NULL)
+				return false;
+			double rate = ticksPerSecond();
+			fprintf(file,"phase,step,wallSeconds");
+			for(int c=0;c<PROFILE_NUMBER_COUNTERS;c++)
+				fprintf(file,",%s",counterNames[c]);
+			fprintf(file,",heapBytes");
+			for(int s=0;s<PROFILE_NUMBER_STAGES;s++)
+				fprintf(file,",%sSeconds",stageNames[s]);
+			fprintf(file,"\n");
+			for(unsigned int i=0;i<_steps.size();i++)
+			{
+				profileStep &step = _steps[i];
+				fprintf(file,"%d,%s,%.9f",step.phase,step.step.c_str(),step.wallTicks/rate);
+				for(int c=0;c<PROFILE_NUMBER_COUNTERS;c++)
+					fprintf(file,",%llu",step.counters[c]);
+				fprintf(file,",%lld",step.heapBytes);
+				for(int s=0;s<PROFILE_NUMBER_STAGES;s++)
+					fprintf(file,",%.9f",step.ticks[s]/rate);
+				fprintf(file,"\n");
+			}
+			fclose(file);
+			return true;
+		}
+};
+
+#ifdef BILOUVAIN_PROFILE
+#define PROFILE_COUNT(profiler,counter,value) (profiler).count(counter,value)
+#define PROFILE_START(variable) unsigned long long variable = profileClock()
+#define PROFILE_STOP(profiler,stage,variable) (profiler).addTicks(stage,profileClock()-(variable))
+#define PROFILE_END_STEP(profiler,phase,step) (profiler).endStep(phase,step)
+#else
+#define PROFILE_COUNT(profiler,counter,value) ((void)0)
+#define PROFILE_START(variable) ((void)0)
+#define PROFILE_STOP(profiler,stage,variable) ((void)0)
+#define PROFILE_END_STEP(profiler,phase,step) ((void)0)
+#endif
+
+#endif /* PROFILER_H_ */
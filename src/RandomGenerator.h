@@ -0,0 +1,132 @@
+// **************************************************************************************************
+// biLouvain: A C++ library for bipartite graph community detection
+// Paola Gabriela Pesantez-Cabrera, Ananth Kalyanaraman
+//      (p.pesantezcabrera@wsu.edu, ananth@eecs.wsu.edu)
+// Washington State University
+//
+// For citation, please cite the following paper:
+// Pesantez, Paola and Kalyanaraman, Ananth, "Detecting Communities in Biological
+// Bipartite Networks," Proc. ACM Conference on Bioinformatics, Computational Biology,
+// and Health Informatics (ACM-BCB), Seattle, WA, October 2-5, 2016, In press,
+// DOI: http://dx.doi.org/10.1145/2975167.2975177.
+//
+// **************************************************************************************************
+// Copyright (c) 2016. Washington State University ("WSU"). All Rights Reserved.
+// Permission to use, copy, modify, and distribute this software and its documentation
+// for educational, research, and not-for-profit purposes, without fee, is hereby
+// granted, provided that the above copyright notice, this paragraph and the following
+// two paragraphs appear in all copies, modifications, and distributions. For
+// commercial licensing opportunities, please contact The Office of Commercialization,
+// WSU, 280/286 Lighty, PB Box 641060, Pullman, WA 99164, (509) 335-5526,
+// commercialization@wsu.edu<mailto:commercialization@wsu.edu>, https://commercialization.wsu.edu/
+
+// IN NO EVENT SHALL WSU BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT, SPECIAL, INCIDENTAL,
+// OR CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF
+// THIS SOFTWARE AND ITS DOCUMENTATION, EVEN IF WSU HAS BEEN ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// WSU SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. THE SOFTWARE AND
+// ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS PROVIDED "AS IS". WSU HAS NO
+// OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+// **************************************************************************************************
+
+
+/*
+# RandomGenerator.h
+# Seedable 64-bit pseudo random generator (xoshiro256**, seeded through splitmix64) used for the random node orders.
+# The same seed gives the same sequence on every platform, so runs can be reproduced across releases.
+*/
+
+#ifndef RANDOMGENERATOR_H_
+#define RANDOMGENERATOR_H_
+
+#include "Header.h"
+
+class RandomGenerator
+{
+	private:
+		unsigned long long _state[4];
+
+		static unsigned long long rotateLeft(unsigned long long x,int k)
+		{
+			return (x << k) | (x >> (64 - k));
+		}
+
+	public:
+		RandomGenerator(unsigned long long seed = 1)
+		{
+			setSeed(seed);
+		}
+
+		//Advances x and returns a well mixed 64-bit value from it
+		static unsigned long long splitMix64(unsigned long long &x)
+		{
+			unsigned long long z = (x += 0x9E3779B97F4A7C15ULL);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+			return z ^ (z >> 31);
+		}
+
+		void setSeed(unsigned long long seed)
+		{
+			for(int k=0;k<4;k++)
+				_state[k] = splitMix64(seed);
+		}
+
+		//Saved in the phase checkpoints so a resumed run draws the same orders
+		void getState(unsigned long long state[4]) const
+		{
+			memcpy(state,_state,sizeof(_state));
+		}
+
+		void setState(const unsigned long long state[4])
+		{
+			memcpy(_state,state,sizeof(_state));
+		}
+
+		unsigned long long next()
+		{
+			unsigned long long result = rotateLeft(_state[1]*5,7)*9;
+			unsigned long long t = _state[1] << 17;
+			_state[2] ^= _state[0];
+			_state[3] ^= _state[1];
+			_state[1] ^= _state[2];
+			_state[0] ^= _state[3];
+			_state[2] ^= t;
+			_state[3] = rotateLeft(_state[3],45);
+			return result;
+		}
+
+		//Uniform value in [0,1) with 53 random bits
+		double nextDouble()
+		{
+			return (next() >> 11) * (1.0/9007199254740992.0);
+		}
+
+		//Uniform value in [0,bound) without modulo bias
+		unsigned long long nextBounded(unsigned long long bound)
+		{
+			unsigned __int128 product = (unsigned __int128)next() * bound;
+			unsigned long long low = (unsigned long long)product;
+			if(low < bound)
+			{
+				unsigned long long threshold = -bound % bound;
+				while(low < threshold)
+				{
+					product = (unsigned __int128)next() * bound;
+					low = (unsigned long long)product;
+				}
+			}
+			return (unsigned long long)(product >> 64);
+		}
+
+		//Fisher-Yates shuffle of elements[0,size)
+		void shuffle(int* elements,int size)
+		{
+			for(int i=size-1;i>0;i--)
+				std::swap(elements[i],elements[nextBounded(i+1)]);
+		}
+};
+
+#endif /* RANDOMGENERATOR_H_ */
@@ -0,0 +1,95 @@
+// **************************************************************************************************
+// biLouvain: A C++ library for bipartite graph community detection
+// Paola Gabriela Pesantez-Cabrera, Ananth Kalyanaraman
+//      (p.pesantezcabrera@wsu.edu, ananth@eecs.wsu.edu)
+// Washington State University
+//
+// For citation, please cite the following paper:
+// Pesantez, Paola and Kalyanaraman, Ananth, "Detecting Communities in Biological
+// Bipartite Networks," Proc. ACM Conference on Bioinformatics, Computational Biology,
+// and Health Informatics (ACM-BCB), Seattle, WA, October 2-5, 2016, In press,
+// DOI: http://dx.doi.org/10.1145/2975167.2975177.
+//
+// **************************************************************************************************
+// Copyright (c) 2016. Washington State University ("WSU"). All Rights Reserved.
+// Permission to use, copy, modify, and distribute this software and its documentation
+// for educational, research, and not-for-profit purposes, without fee, is hereby
+// granted, provided that the above copyright notice, this paragraph and the following
+// two paragraphs appear in all copies, modifications, and distributions. For
+// commercial licensing opportunities, please contact The Office of Commercialization,
+// WSU, 280/286 Lighty, PB Box 641060, Pullman, WA 99164, (509) 335-5526,
+// commercialization@wsu.edu<mailto:commercialization@wsu.edu>, https://commercialization.wsu.edu/
+
+// IN NO EVENT SHALL WSU BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT, SPECIAL, INCIDENTAL,
+// OR CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF
+// THIS SOFTWARE AND ITS DOCUMENTATION, EVEN IF WSU HAS BEEN ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// WSU SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. THE SOFTWARE AND
+// ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS PROVIDED "AS IS". WSU HAS NO
+// OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+// **************************************************************************************************
+
+
+/*
+# Range.h
+# Iterable views over storage owned by other classes (CSR rows, sorted entries, maps) that avoid
+# building a new vector on every call. A view is only valid while the storage it refers to is not modified.
+*/
+
+#ifndef RANGE_H_
+#define RANGE_H_
+
+#include "Header.h"
+#include <iterator>
+
+template <typename Iterator>
+class Range
+{
+	private:
+		Iterator _begin;
+		Iterator _end;
+		int _size;
+
+	public:
+		Range():_begin(),_end(),_size(0){}
+		Range(Iterator begin, Iterator end, int size):_begin(begin),_end(end),_size(size){}
+
+		Iterator begin() const {return _begin;}
+		Iterator end() const {return _end;}
+		int size() const {return _size;}
+		bool empty() const {return _size == 0;}
+		//Only available when Iterator is random access
+		typename std::iterator_traits<Iterator>::value_type operator[](int i) const {return _begin[i];}
+};
+
+//Iterates over the keys of a sequence of pairs, e.g. the ids stored in a map or in sorted (id,weight) entries
+template <typename PairIterator>
+class KeyIterator
+{
+	private:
+		PairIterator _it;
+
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef int value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const int* pointer;
+		typedef const int& reference;
+
+		KeyIterator():_it(){}
+		KeyIterator(PairIterator it):_it(it){}
+
+		const int& operator*() const {return _it->first;}
+		const int* operator->() const {return &(_it->first);}
+		const int& operator[](int i) const {return _it[i].first;}
+		KeyIterator& operator++() {++_it; return *this;}
+		KeyIterator operator++(int) {KeyIterator result(*this); ++_it; return result;}
+		bool operator==(const KeyIterator &other) const {return _it == other._it;}
+		bool operator!=(const KeyIterator &other) const {return _it != other._it;}
+};
+
+typedef Range<const int*> IdRange;
+
+#endif /* RANGE_H_ */
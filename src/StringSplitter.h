@@ -91,6 +91,117 @@ class StringSplitter
 			return pieces_str;
 		}
 
+		//Locale-free parsers for numeric fields. They read the number that starts at p, skipping leading blanks, and
+		//return the position right after it. Nothing is allocated, so they can be used on a shared buffer by many threads.
+		static const char* parseInt(const char* p,const char* end,int &value)
+		{
+			while((p < end)&&((*p == ' ')||(*p == '\t')))p++;
+			bool negative = false;
+			if((p < end)&&((*p == '-')||(*p == '+')))
+			{
+				negative = (*p == '-');
+				p++;
+			}
+			long long number = 0;
+			while((p < end)&&(*p >= '0')&&(*p <= '9'))
+			{
+				number = number*10 + (*p - '0');
+				p++;
+			}
+			value = negative ? -number : number;
+			return p;
+		}
+
+		//Plain decimal numbers with up to 19 significant digits and a small exponent are converted exactly with one
+		//multiplication or division by a power of ten; anything else (long mantissas, nan, inf, hexadecimal) goes to strtod.
+		static const char* parseDouble(const char* p,const char* end,double &value)
+		{
+			static const double powersOfTen[] = {1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,1e11,1e12,1e13,1e14,1e15,1e16,1e17,1e18,1e19,1e20,1e21,1e22};
+			while((p < end)&&((*p == ' ')||(*p == '\t')))p++;
+			const char* start = p;
+			bool negative = false;
+			if((p < end)&&((*p == '-')||(*p == '+')))
+			{
+				negative = (*p == '-');
+				p++;
+			}
+			unsigned long long mantissa = 0;
+			int digits = 0;
+			int exponent = 0;
+			bool anyDigit = false;
+			while((p < end)&&(*p >= '0')&&(*p <= '9'))
+			{
+				if((mantissa != 0)||(*p != '0'))
+				{
+					if(digits < 19)mantissa = mantissa*10 + (*p - '0');
+					else exponent++;
+					digits++;
+				}
+				anyDigit = true;
+				p++;
+			}
+			if((p < end)&&(*p == '.'))
+			{
+				p++;
+				while((p < end)&&(*p >= '0')&&(*p <= '9'))
+				{
+					if((mantissa != 0)||(*p != '0'))
+					{
+						if(digits < 19)
+						{
+							mantissa = mantissa*10 + (*p - '0');
+							exponent--;
+						}
+						digits++;
+					}
+					else exponent--;
+					anyDigit = true;
+					p++;
+				}
+			}
+			if(anyDigit&&(p < end)&&((*p == 'e')||(*p == 'E')))
+			{
+				int exponentPart = 0;
+				const char* q = parseInt(p+1,end,exponentPart);
+				if((q > p+1)&&(q[-1] >= '0')&&(q[-1] <= '9'))
+				{
+					exponent += exponentPart;
+					p = q;
+				}
+			}
+			bool exact = anyDigit&&(digits <= 19)&&(mantissa <= (1ULL << 53))&&(exponent >= -22)&&(exponent <= 22);
+			bool alphabetic = (p < end)&&(((*p|0x20) >= 'a')&&((*p|0x20) <= 'z'));
+			if(exact&&!alphabetic)
+			{
+				value = (exponent < 0) ? (double)mantissa / powersOfTen[-exponent] : (double)mantissa * powersOfTen[exponent];
+				if(negative)value = -value;
+				return p;
+			}
+			const char* tokenLimit = start;
+			while((tokenLimit < end)&&(*tokenLimit != '\t')&&(*tokenLimit != '\n')&&(*tokenLimit != '\r')&&(*tokenLimit != ' '))tokenLimit++;
+			std::string token(start,tokenLimit);
+			char* tokenEnd = NULL;
+			value = strtod(token.c_str(),&tokenEnd);
+			return start + (tokenEnd - token.c_str());
+		}
+
+		//Locale-free counterpart of parseInt used by the writers of large outputs
+		static void appendInt(std::string &output,long long value)
+		{
+			char digits[24];
+			int length = 0;
+			unsigned long long number = (value < 0) ? -(unsigned long long)value : value;
+			do
+			{
+				digits[length++] = '0' + number%10;
+				number /= 10;
+			}while(number > 0);
+			if(value < 0)
+				output.push_back('-');
+			while(length > 0)
+				output.push_back(digits[--length]);
+		}
+
 		template <typename T>
 		static void printVector(std::vector<T> _vector)
 		{
@@ -0,0 +1,204 @@
+// **************************************************************************************************
+// biLouvain: A C++ library for bipartite graph community detection
+// Paola Gabriela Pesantez-Cabrera, Ananth Kalyanaraman
+//      (p.pesantezcabrera@wsu.edu, ananth@eecs.wsu.edu)
+// Washington State University
+//
+// For citation, please cite the following paper:
+// Pesantez, Paola and Kalyanaraman, Ananth, "Detecting Communities in Biological
+// Bipartite Networks," Proc. ACM Conference on Bioinformatics, Computational Biology,
+// and Health Informatics (ACM-BCB), Seattle, WA, October 2-5, 2016, In press,
+// DOI: http://dx.doi.org/10.1145/2975167.2975177.
+//
+// **************************************************************************************************
+// Copyright (c) 2016. Washington State University ("WSU"). All Rights Reserved.
+// Permission to use, copy, modify, and distribute this software and its documentation
+// for educational, research, and not-for-profit purposes, without fee, is hereby
+// granted, provided that the above copyright notice, this paragraph and the following
+// two paragraphs appear in all copies, modifications, and distributions. For
+// commercial licensing opportunities, please contact The Office of Commercialization,
+// WSU, 280/286 Lighty, PB Box 641060, Pullman, WA 99164, (509) 335-5526,
+// commercialization@wsu.edu<mailto:commercialization@wsu.edu>, https://commercialization.wsu.edu/
+
+// IN NO EVENT SHALL WSU BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT, SPECIAL, INCIDENTAL,
+// OR CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF
+// THIS SOFTWARE AND ITS DOCUMENTATION, EVEN IF WSU HAS BEEN ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// WSU SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. THE SOFTWARE AND
+// ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS PROVIDED "AS IS". WSU HAS NO
+// OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+// **************************************************************************************************
+
+
+/*
+# SyntheticGraphs.h
+# Generators of bipartite graphs with planted co-clusters used by the benchmark (Benchmark.cpp): stochastic block
+# model, degree corrected block model with power-law degrees, and ring/chain co-cluster structures (block i of V1
+# tied to blocks i and i+1 of V2). Vertex i of V1 belongs to block i % blocks and so does vertex j of V2.
+*/
+
+#ifndef SYNTHETICGRAPHS_H_
+#define SYNTHETICGRAPHS_H_
+
+#include "Header.h"
+#include "RandomGenerator.h"
+#include <tr1/unordered_set>
+
+struct syntheticGraph
+{
+	int numberNodesV1;
+	int numberNodesV2;
+	int numberBlocks;
+	std::vector<int> sources;	//vertex of V1
+	std::vector<int> targets;	//vertex of V2
+};
+
+class SyntheticGraphs
+{
+	private:
+		static int blockSize(int numberNodes,int numberBlocks,int block)
+		{
+			return numberNodes/numberBlocks + ((block < numberNodes%numberBlocks) ? 1 : 0);
+		}
+
+		//Edges between every vertex of V1 in blockV1 and every vertex of V2 in blockV2, each present with probability p.
+		//The cells are visited with geometric jumps, so the cost is proportional to the number of edges.
+		static void addBlockPair(syntheticGraph &graph,int blockV1,int blockV2,double p,RandomGenerator &random)
+		{
+			if(p <= 0.0)
+				return;
+			int b = graph.numberBlocks;
+			long long sizeV1 = blockSize(graph.numberNodesV1,b,blockV1);
+			long long sizeV2 = blockSize(graph.numberNodesV2,b,blockV2);
+			long long cells = sizeV1*sizeV2;
+			double logSkip = (p < 1.0) ? log(1.0-p) : 0.0;
+			for(long long cell=-1;;)
+			{
+				if(p < 1.0)
+					cell += 1 + (long long)floor(log(1.0-random.nextDouble())/logSkip);
+				else
+					cell++;
+				if(cell >= cells)
+					break;
+				graph.sources.push_back(blockV1 + (int)(cell/sizeV2)*b);
+				graph.targets.push_back(blockV2 + (int)(cell%sizeV2)*b);
+			}
+		}
+
+		//Mates of block i of V1 in V2: i for the block model, i and i+1 for the ring (modulo) and the chain (if it exists)
+		static std::vector<int> mateBlocks(int block,int numberBlocks,const std::string &structure)
+		{
+			std::vector<int> mates(1,block);
+			if((structure == "ring")&&(numberBlocks > 1))
+				mates.push_back((block+1)%numberBlocks);
+			else if((structure == "chain")&&(block+1 < numberBlocks))
+				mates.push_back(block+1);
+			return mates;
+		}
+
+	public:
+		static int blockOf(int vertex,int numberBlocks)
+		{
+			return vertex % numberBlocks;
+		}
+
+		//Block model ("sbm"), ring or chain. Vertices of V1 have on average degree edges, a fraction mixing of them to
+		//blocks of V2 that are not mates of their block.
+		static syntheticGraph generateBlockModel(const std::string &structure,int numberNodesV1,int numberNodesV2,int numberBlocks,double degree,double mixing,RandomGenerator &random)
+		{
+			syntheticGraph graph;
+			graph.numberNodesV1 = numberNodesV1;
+			graph.numberNodesV2 = numberNodesV2;
+			graph.numberBlocks = numberBlocks;
+			for(int i=0;i<numberBlocks;i++)
+			{
+				std::vector<int> mates = mateBlocks(i,numberBlocks,structure);
+				long long matesSize = 0;
+				for(unsigned int k=0;k<mates.size();k++)
+					matesSize += blockSize(numberNodesV2,numberBlocks,mates[k]);
+				long long othersSize = numberNodesV2 - matesSize;
+				double pIn = (matesSize > 0) ? std::min(1.0,degree*(1.0-mixing)/matesSize) : 0.0;
+				double pOut = (othersSize > 0) ? std::min(1.0,degree*mixing/othersSize) : 0.0;
+				for(int j=0;j<numberBlocks;j++)
+				{
+					bool mate = (std::find(mates.begin(),mates.end(),j) != mates.end());
+					addBlockPair(graph,i,j,mate ? pIn : pOut,random);
+				}
+			}
+			return graph;
+		}
+
+		//Degree corrected block model: every vertex gets a Pareto weight with exponent gamma and the endpoints of the
+		//numberNodesV1*degree edges are drawn proportionally to it, inside the mate block with probability 1-mixing.
+		//Repeated edges are dropped.
+		static syntheticGraph generatePowerLaw(int numberNodesV1,int numberNodesV2,int numberBlocks,double degree,double mixing,double gamma,RandomGenerator &random)
+		{
+			syntheticGraph graph;
+			graph.numberNodesV1 = numberNodesV1;
+			graph.numberNodesV2 = numberNodesV2;
+			graph.numberBlocks = numberBlocks;
+			//Cumulative weights of V1, and of V2 per block (vertices of block j are j, j+b, j+2b, ...)
+			std::vector<double> cumulativeV1(numberNodesV1);
+			double total = 0.0;
+			for(int i=0;i<numberNodesV1;i++)
+			{
+				total += pow(1.0-random.nextDouble(),-1.0/(gamma-1.0));
+				cumulativeV1[i] = total;
+			}
+			std::vector<std::vector<double> > cumulativeV2(numberBlocks);
+			std::vector<double> blockWeightsV2(numberBlocks,0.0);
+			for(int j=0;j<numberNodesV2;j++)
+			{
+				int block = blockOf(j,numberBlocks);
+				blockWeightsV2[block] += pow(1.0-random.nextDouble(),-1.0/(gamma-1.0));
+				cumulativeV2[block].push_back(blockWeightsV2[block]);
+			}
+			std::vector<double> cumulativeBlocksV2(numberBlocks);
+			double totalV2 = 0.0;
+			for(int j=0;j<numberBlocks;j++)
+			{
+				totalV2 += blockWeightsV2[j];
+				cumulativeBlocksV2[j] = totalV2;
+			}
+			long long numberEdges = (long long)(numberNodesV1*degree);
+			std::tr1::unordered_set<unsigned long long> edges;
+			for(long long e=0;e<numberEdges;e++)
+			{
+				int source = std::lower_bound(cumulativeV1.begin(),cumulativeV1.end(),random.nextDouble()*total) - cumulativeV1.begin();
+				source = std::min(source,numberNodesV1-1);
+				int block = blockOf(source,numberBlocks);
+				if(random.nextDouble() < mixing)
+				{
+					block = std::lower_bound(cumulativeBlocksV2.begin(),cumulativeBlocksV2.end(),random.nextDouble()*totalV2) - cumulativeBlocksV2.begin();
+					block = std::min(block,numberBlocks-1);
+				}
+				std::vector<double> &cumulative = cumulativeV2[block];
+				if(cumulative.empty())
+					continue;
+				int position = std::lower_bound(cumulative.begin(),cumulative.end(),random.nextDouble()*cumulative.back()) - cumulative.begin();
+				int target = block + std::min(position,(int)cumulative.size()-1)*numberBlocks;
+				if(edges.insert(((unsigned long long)source << 32) | (unsigned int)target).second)
+				{
+					graph.sources.push_back(source);
+					graph.targets.push_back(target);
+				}
+			}
+			return graph;
+		}
+
+		//Labelled edge list (U<i> V<j> 1), the same input format accepted by the biLouvain executable
+		static int writeGraph(const syntheticGraph &graph,const std::string &fileName)
+		{
+			FILE* file = fopen(fileName.c_str(),"w");
+			if(file == NULL)
+				return -1;
+			for(unsigned int e=0;e<graph.sources.size();e++)
+				fprintf(file,"U%d\tV%d\t1\n",graph.sources[e],graph.targets[e]);
+			fclose(file);
+			return 0;
+		}
+};
+
+#endif /* SYNTHETICGRAPHS_H_ */
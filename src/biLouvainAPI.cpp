@@ -0,0 +1,128 @@
+// **************************************************************************************************
+// biLouvain: A C++ library for bipartite graph community detection
+// Paola Gabriela Pesantez-Cabrera, Ananth Kalyanaraman
+//      (p.pesantezcabrera@wsu.edu, ananth@eecs.wsu.edu)
+// Washington State University
+//
+// For citation, please cite the following paper:
+// Pesantez, Paola and Kalyanaraman, Ananth, "Detecting Communities in Biological
+// Bipartite Networks," Proc. ACM Conference on Bioinformatics, Computational Biology,
+// and Health Informatics (ACM-BCB), Seattle, WA, October 2-5, 2016, In press,
+// DOI: http://dx.doi.org/10.1145/2975167.2975177.
+//
+// **************************************************************************************************
+// Copyright (c) 2016. Washington State University ("WSU"). All Rights Reserved.
+// Permission to use, copy, modify, and distribute this software and its documentation
+// for educational, research, and not-for-profit purposes, without fee, is hereby
+// granted, provided that the above copyright notice, this paragraph and the following
+// two paragraphs appear in all copies, modifications, and distributions. For
+// commercial licensing opportunities, please contact The Office of Commercialization,
+// WSU, 280/286 Lighty, PB Box 641060, Pullman, WA 99164, (509) 335-5526,
+// commercialization@wsu.edu<mailto:commercialization@wsu.edu>, https://commercialization.wsu.edu/
+
+// IN NO EVENT SHALL WSU BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT, SPECIAL, INCIDENTAL,
+// OR CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF
+// THIS SOFTWARE AND ITS DOCUMENTATION, EVEN IF WSU HAS BEEN ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// WSU SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. THE SOFTWARE AND
+// ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS PROVIDED "AS IS". WSU HAS NO
+// OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+// **************************************************************************************************
+
+
+#include "biLouvainAPI.h"
+#include "Graph.h"
+#include "LoadGraph.h"
+#include "LoadSimilarityMatrix.h"
+#include "FuseMethod.h"
+#include "biLouvainMethod.h"
+#include "biLouvainMethodMurataPN.h"
+
+int biLouvainCommunities(const biLouvainConfig &config,int numberNodesV1,int numberNodesV2,const std::vector<int> &sourcesV1,const std::vector<int> &targetsV2,const std::vector<double> &weights,biLouvainResults &results,const biLouvainSimilarity* similarityV1,const biLouvainSimilarity* similarityV2)
+{
+	if((numberNodesV1 <= 0)||(numberNodesV2 <= 0)||(sourcesV1.size() != targetsV2.size())||(sourcesV1.size() != weights.size()))
+		return -1;
+	//Both directions of every edge, V2 ids after those of V1, as LoadGraph::parseEdges leaves them
+	std::vector<int> sources, targets;
+	std::vector<double> edgeWeights;
+	sources.reserve(2*sourcesV1.size());
+	targets.reserve(2*sourcesV1.size());
+	edgeWeights.reserve(2*sourcesV1.size());
+	for(unsigned int k=0;k<sourcesV1.size();k++)
+	{
+		if((sourcesV1[k] < 0)||(sourcesV1[k] >= numberNodesV1)||(targetsV2[k] < 0)||(targetsV2[k] >= numberNodesV2))
+			return -1;
+		sources.push_back(sourcesV1[k]);
+		targets.push_back(numberNodesV1 + targetsV2[k]);
+		edgeWeights.push_back(weights[k]);
+		sources.push_back(numberNodesV1 + targetsV2[k]);
+		targets.push_back(sourcesV1[k]);
+		edgeWeights.push_back(weights[k]);
+	}
+	Graph* graph;
+	if(LoadGraph::loadBipartiteGraphFromEdges(graph,sources,targets,edgeWeights,numberNodesV1+numberNodesV2-1,numberNodesV1-1) != 0)
+		return -1;
+
+	//As in Main, alpha falls back to 1 when no similarity matrix is given. With only one of them the modularity of the
+	//other set would divide by a zero similarity, so that is refused.
+	double alpha = config.alpha;
+	if(alpha != 1.0)
+	{
+		int numberMatrices = 0;
+		const biLouvainSimilarity* similarities[2] = {similarityV1,similarityV2};
+		if((similarityV1 == NULL) != (similarityV2 == NULL))
+		{
+			graph->destroyGraph();
+			delete graph;
+			return -1;
+		}
+		for(int p=0;p<2;p++)
+		{
+			if(similarities[p] == NULL)
+				continue;
+			if(LoadSimilarityMatrix::loadSimilarityMatrixFromEntries(*graph,p == 1,similarities[p]->expectedSimilarity,similarities[p]->rows,similarities[p]->columns,similarities[p]->similarities) != 0)
+			{
+				graph->destroyGraph();
+				delete graph;
+				return -1;
+			}
+			numberMatrices++;
+		}
+		if(numberMatrices == 0)
+			alpha = 1.0;
+	}
+
+	bool writeResults = (config.outputFileName.empty() == false);
+	FuseMethod f;
+	f.setNumberThreads(config.numberThreads);
+	f.setCompensatedSummation(config.compensatedSummation);
+	f.setVerbose(config.verbose);
+	f.setWriteResults(false);
+	if(config.fuse == 1)
+		f.fuseMethodMemory(*graph,alpha,config.cutoffFuse);
+	biLouvainMethodMurataPN biLouvain;
+	biLouvain.setNumberThreads(config.numberThreads);
+	biLouvain.setBatchSize(config.batchSize);
+	biLouvain.setCompensatedSummation(config.compensatedSummation);
+	biLouvain.setSeed(config.seed);
+	biLouvain.setActiveSet(config.activeSet,config.activeTolerance);
+	biLouvain.setVerbose(config.verbose);
+	biLouvain.setWriteResults(writeResults);
+	biLouvain.setBinaryResults(config.binaryResults);
+	std::tr1::unordered_map<int,std::string> entities;
+	if(alpha != 0.0)
+		biLouvain.biLouvainMethodAlgorithm(*graph,config.cutoffIterations,config.cutoffPhases,config.order,entities,config.outputFileName,config.outputFileName,alpha);
+	else
+		biLouvain.biLouvainMethodAlgorithmIntraType(*graph,config.cutoffIterations,config.cutoffPhases,config.order,entities,config.outputFileName,config.outputFileName);
+	graph->destroyGraph();
+	delete graph;
+
+	results.community = biLouvain.getMembership();
+	results.coClusters = biLouvain.getCoClusters();
+	results.modularity = biLouvain.getFinalModularity();
+	results.numberPhases = biLouvain.getNumberPhases();
+	results.dendrogram = biLouvain.getDendrogram();
+	return 0;
+}
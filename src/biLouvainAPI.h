@@ -0,0 +1,105 @@
+// **************************************************************************************************
+// biLouvain: A C++ library for bipartite graph community detection
+// Paola Gabriela Pesantez-Cabrera, Ananth Kalyanaraman
+//      (p.pesantezcabrera@wsu.edu, ananth@eecs.wsu.edu)
+// Washington State University
+//
+// For citation, please cite the following paper:
+// Pesantez, Paola and Kalyanaraman, Ananth, "Detecting Communities in Biological
+// Bipartite Networks," Proc. ACM Conference on Bioinformatics, Computational Biology,
+// and Health Informatics (ACM-BCB), Seattle, WA, October 2-5, 2016, In press,
+// DOI: http://dx.doi.org/10.1145/2975167.2975177.
+//
+// **************************************************************************************************
+// Copyright (c) 2016. Washington State University ("WSU"). All Rights Reserved.
+// Permission to use, copy, modify, and distribute this software and its documentation
+// for educational, research, and not-for-profit purposes, without fee, is hereby
+// granted, provided that the above copyright notice, this paragraph and the following
+// two paragraphs appear in all copies, modifications, and distributions. For
+// commercial licensing opportunities, please contact The Office of Commercialization,
+// WSU, 280/286 Lighty, PB Box 641060, Pullman, WA 99164, (509) 335-5526,
+// commercialization@wsu.edu<mailto:commercialization@wsu.edu>, https://commercialization.wsu.edu/
+
+// IN NO EVENT SHALL WSU BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT, SPECIAL, INCIDENTAL,
+// OR CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF
+// THIS SOFTWARE AND ITS DOCUMENTATION, EVEN IF WSU HAS BEEN ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// WSU SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. THE SOFTWARE AND
+// ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS PROVIDED "AS IS". WSU HAS NO
+// OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+// **************************************************************************************************
+
+
+/*
+# biLouvainAPI.h
+# In-memory entry point for programs that embed biLouvain (libbiLouvain.a): the bipartite graph, and optionally the
+# similarity matrices, are given as arrays and the communities, co-clusters and modularity are returned in memory.
+# Nothing is printed and no file is read or written unless the configuration asks for it.
+*/
+
+#ifndef BILOUVAINAPI_H_
+#define BILOUVAINAPI_H_
+
+#include "Header.h"
+#include "Dendrogram.h"
+
+//Options of a run, the same as those of the biLouvain executable
+struct biLouvainConfig
+{
+	double alpha;			//weight of the inter-type modularity, 1 without similarity matrices
+	double cutoffIterations;
+	double cutoffPhases;
+	double cutoffFuse;
+	int order;			//processing order of the nodes (see biLouvainMethod::nodesOrderToProcess)
+	int fuse;			//0/1, fuse the initial communities that share co-cluster mates
+	int numberThreads;
+	int batchSize;
+	bool compensatedSummation;
+	unsigned long long seed;
+	bool activeSet;
+	double activeTolerance;
+	bool verbose;			//progress messages on stdout
+	std::string outputFileName;	//when not empty the _Results*.txt files are written with this prefix
+	bool binaryResults;		//with outputFileName, also write _Results.bin (see BinaryResults.h)
+
+	biLouvainConfig()
+		:alpha(1.0),cutoffIterations(0.01),cutoffPhases(0.0),cutoffFuse(1.0),order(3),fuse(1),numberThreads(1),batchSize(1024),compensatedSummation(true),seed(1),activeSet(false),activeTolerance(1.0),verbose(false),binaryResults(false){}
+};
+
+//Sparse similarity matrix of one set of vertices: (row,column,similarity) entries with ids local to the set
+struct biLouvainSimilarity
+{
+	double expectedSimilarity;
+	std::vector<int> rows;
+	std::vector<int> columns;
+	std::vector<double> similarities;
+
+	biLouvainSimilarity():expectedSimilarity(0.0){}
+};
+
+struct biLouvainResults
+{
+	//Community id of every vertex, the vertices of V1 first: community[i] for vertex i of V1, community[numberNodesV1+j]
+	//for vertex j of V2
+	std::vector<int> community;
+	//(community,co-cluster mate community) pairs
+	std::vector<std::pair<int,int> > coClusters;
+	double modularity;
+	int numberPhases;
+	//Community of every vertex, indexed like community, at every phase (see Dendrogram.h); the communities of each
+	//level are numbered from 0
+	Dendrogram dendrogram;
+
+	biLouvainResults():modularity(0.0),numberPhases(0){}
+};
+
+//Detects the communities of the bipartite graph with numberNodesV1 and numberNodesV2 vertices and the edges
+//(sourcesV1[k],targetsV2[k]) of weight weights[k]; ids are local to each set. similarityV1 and similarityV2 are used
+//when config.alpha != 1, both or none. Returns 0, or -1 when an edge or a similarity entry refers to a vertex that
+//does not exist, a similarity entry repeats a (row,column) pair or has no (column,row) entry with the same similarity,
+//or only one similarity matrix is given.
+int biLouvainCommunities(const biLouvainConfig &config,int numberNodesV1,int numberNodesV2,const std::vector<int> &sourcesV1,const std::vector<int> &targetsV2,const std::vector<double> &weights,biLouvainResults &results,const biLouvainSimilarity* similarityV1 = NULL,const biLouvainSimilarity* similarityV2 = NULL);
+
+#endif /* BILOUVAINAPI_H_ */
@@ -47,19 +47,188 @@ biLouvainMethod::biLouvainMethod()
 	precalculationCjTime = 0.0;
 	precalculationDTime = 0.0;
 	premurataTime = 0.0;
+	_numberThreads = 1;
+	_batchSize = 1024;
+	_epoch = 0;
+	_compensatedSummation = true;
+	_activeSet = false;
+	_activeTolerance = 1.0;
+	_resume = false;
+	_verbose = true;
+	_writeResults = true;
+	_binaryResults = false;
+	_writeDendrogram = false;
+	_finalModularity = 0.0;
+	_numberPhases = 0;
 }
 
 biLouvainMethod::~biLouvainMethod(){}
 
+void biLouvainMethod::setNumberThreads(int numberThreads)
+{
+	_numberThreads = numberThreads;
+#ifdef BILOUVAIN_PROFILE
+	_profiler.reset(numberThreads);	//fuse runs before biLouvainMethodAlgorithm sizes the slots
+#endif
+}
+
+void biLouvainMethod::setBatchSize(int batchSize)
+{
+	if(batchSize > 0)
+		_batchSize = batchSize;
+}
+
+void biLouvainMethod::setCompensatedSummation(bool compensatedSummation)
+{
+	_compensatedSummation = compensatedSummation;
+}
+
+void biLouvainMethod::setSeed(unsigned long long seed)
+{
+	_random.setSeed(seed);
+}
+
+//tolerance: change in the modularity contribution of a community, without a change of its co-cluster mates,
+//above which its members are scored again
+void biLouvainMethod::setActiveSet(bool activeSet,double tolerance)
+{
+	_activeSet = activeSet;
+	_activeTolerance = tolerance;
+}
+
+Profiler& biLouvainMethod::getProfiler()
+{
+	return _profiler;
+}
+
+void biLouvainMethod::setCheckpoint(const std::string &checkpointFileName)
+{
+	_checkpointFileName = checkpointFileName;
+}
+
+//The graph given to biLouvainMethodAlgorithm must be the one loaded from the same checkpoint
+void biLouvainMethod::resumeFromCheckpoint(const phaseCheckpointState &state)
+{
+	_resume = true;
+	_resumeState = state;
+}
+
+void biLouvainMethod::setVerbose(bool verbose)
+{
+	_verbose = verbose;
+}
+
+//Without the result files only the in-memory results (getMembership, getCoClusters, ...) are produced
+void biLouvainMethod::setWriteResults(bool writeResults)
+{
+	_writeResults = writeResults;
+}
+
+void biLouvainMethod::setBinaryResults(bool binaryResults)
+{
+	_binaryResults = binaryResults;
+}
+
+void biLouvainMethod::setWriteDendrogram(bool writeDendrogram)
+{
+	_writeDendrogram = writeDendrogram;
+}
+
+const std::vector<int>& biLouvainMethod::getMembership()
+{
+	return _membership;
+}
+
+const std::vector<std::pair<int,int> >& biLouvainMethod::getCoClusters()
+{
+	return _coClusters;
+}
+
+double biLouvainMethod::getFinalModularity()
+{
+	return _finalModularity;
+}
+
+int biLouvainMethod::getNumberPhases()
+{
+	return _numberPhases;
+}
+
+const Dendrogram& biLouvainMethod::getDendrogram()
+{
+	return _dendrogram;
+}
+
+//Random permutation of nodes[0,numberNodes). Small arrays use a Fisher-Yates shuffle; large ones are scattered into
+//buckets picked by a hash of (draw,position) and every bucket is shuffled with its own generator. The chunks and
+//buckets are fixed, so the permutation depends only on the seed and never on the number of threads.
+void biLouvainMethod::shuffleNodes(int* nodes,int numberNodes)
+{
+	const int parallelShuffleSize = 1 << 20;
+	if(numberNodes < parallelShuffleSize)
+	{
+		_random.shuffle(nodes,numberNodes);
+		return;
+	}
+	const int numberBuckets = 256;
+	const int numberChunks = 64;
+	const unsigned long long draw = _random.next();
+	long long chunkSize = ((long long)numberNodes + numberChunks - 1) / numberChunks;
+	std::vector<unsigned char> bucketOf(numberNodes);
+	std::vector<long long> counts((size_t)numberChunks*numberBuckets,0);
+	#pragma omp parallel for schedule(static) num_threads(_numberThreads) if(_numberThreads > 1)
+	for(int c=0;c<numberChunks;c++)
+	{
+		long long end = std::min((long long)numberNodes,(c+1)*chunkSize);
+		for(long long i=c*chunkSize;i<end;i++)
+		{
+			unsigned long long x = draw ^ (unsigned long long)i;
+			bucketOf[i] = (unsigned char)(RandomGenerator::splitMix64(x) >> 56);
+			counts[(size_t)bucketOf[i]*numberChunks+c]++;
+		}
+	}
+	//Bucket major, chunk minor, so every bucket keeps its elements in position order
+	std::vector<long long> bucketOffsets(numberBuckets+1,0);
+	long long total = 0;
+	for(int b=0;b<numberBuckets;b++)
+	{
+		bucketOffsets[b] = total;
+		for(int c=0;c<numberChunks;c++)
+		{
+			long long count = counts[(size_t)b*numberChunks+c];
+			counts[(size_t)b*numberChunks+c] = total;
+			total += count;
+		}
+	}
+	bucketOffsets[numberBuckets] = total;
+	std::vector<int> scattered(numberNodes);
+	#pragma omp parallel for schedule(static) num_threads(_numberThreads) if(_numberThreads > 1)
+	for(int c=0;c<numberChunks;c++)
+	{
+		long long end = std::min((long long)numberNodes,(c+1)*chunkSize);
+		for(long long i=c*chunkSize;i<end;i++)
+			scattered[counts[(size_t)bucketOf[i]*numberChunks+c]++] = nodes[i];
+	}
+	#pragma omp parallel for schedule(dynamic,4) num_threads(_numberThreads) if(_numberThreads > 1)
+	for(int b=0;b<numberBuckets;b++)
+	{
+		unsigned long long x = draw + (unsigned long long)b;
+		RandomGenerator bucketRandom(RandomGenerator::splitMix64(x));
+		bucketRandom.shuffle(&scattered[bucketOffsets[b]],(int)(bucketOffsets[b+1]-bucketOffsets[b]));
+	}
+	std::copy(scattered.begin(),scattered.end(),nodes);
+}
+
 /* AUXILIAR FUNCTIONS AND PROCEDURES */
 int biLouvainMethod::findCommunityContainingNode(int nodeId)
 {
 	int result = -1;
 	for(int i=0;i<_numberCommunities;i++)
 	{
-		for (int j = 0; j < _communities[i].getNumberNodes(); j++)
+		MemberIdRange members = _communities[i].getNodesRange();
+		for(auto it=members.begin();it!=members.end();++it)
 		{
-			if(_communities[i].getNodes()[j]==nodeId)
+			if(*it==nodeId)
 			{
 				result = i;
 				break;
@@ -86,14 +255,17 @@ int biLouvainMethod::isRepeated(const std::vector<int> &elements, int newElement
 int biLouvainMethod::calculateEdgesBetweenCommunities(Graph &g,int communityCId, int communityDId)
 {
 	int result = 0;
-	for(int i=0;i<_communities[communityCId].getNumberNodes();i++)
+	MemberIdRange membersC = _communities[communityCId].getNodesRange();
+	MemberIdRange membersD = _communities[communityDId].getNodesRange();
+	for(auto itC=membersC.begin();itC!=membersC.end();++itC)
 	{
-		int temp = _communities[communityCId].getNodes()[i];
-		for(int j=0;j<_communities[communityDId].getNumberNodes();j++)
+		int temp = *itC;
+		for(auto itD=membersD.begin();itD!=membersD.end();++itD)
 		{
-			for(int k=0;k<g._graph[_communities[communityDId].getNodes()[j]].getNumberNeighbors();k++)
+			IdRange neighbors = g._graph[*itD].getNeighborsRange();
+			for(auto k=neighbors.begin();k!=neighbors.end();++k)
 			{
-				if(g._graph[_communities[communityDId].getNodes()[j]].getNeighbors()[k] == temp)
+				if(*k == temp)
 					result++;
 			}
 		}
@@ -101,12 +273,9 @@ int biLouvainMethod::calculateEdgesBetweenCommunities(Graph &g,int communityCId,
 	return result;
 }
 
-double biLouvainMethod::calculateEdgesBetweenCommunitiesMap(Graph &g,int communityCId, int communityDId)
+double biLouvainMethod::calculateEdgesBetweenCommunitiesMap(int communityCId, int communityDId)
 {
-	double result = 0.0;
-	for(int i=0;i<_communities[communityCId].getNumberNodes();i++)
-		result +=  g._graph[_communities[communityCId].getNodes()[i]].getWeightEdgesToNeighborCommunity(communityDId);
-	return result;
+	return _communities[communityCId].getWeightEdgesToNeighborCommunity(communityDId);
 }
 
 int biLouvainMethod::findPositionNode(Graph &g,int nodeId)
@@ -128,11 +297,13 @@ std::vector<int> biLouvainMethod::findNeighborCommunities(Graph &g,int community
 	std::vector<int> neighborCommunities;
 	int communityContainingNodeId = 0;
 	int is_repeated = 0;
-	for(int j=0;j<_communities[communityId].getNumberNodes();j++)
+	MemberIdRange members = _communities[communityId].getNodesRange();
+	for(auto it=members.begin();it!=members.end();++it)
 	{
-		for(int k=0;k<g._graph[_communities[communityId].getNodes()[j]].getNumberNeighbors();k++)
+		IdRange neighbors = g._graph[*it].getNeighborsRange();
+		for(auto k=neighbors.begin();k!=neighbors.end();++k)
 		{
-			communityContainingNodeId = findCommunityContainingNode(g._graph[_communities[communityId].getNodes()[j]].getNeighbors()[k]);
+			communityContainingNodeId = findCommunityContainingNode(*k);
 			is_repeated = isRepeated(neighborCommunities,communityContainingNodeId);
 			if(is_repeated == 0)
 				neighborCommunities.push_back(communityContainingNodeId);
@@ -141,32 +312,41 @@ std::vector<int> biLouvainMethod::findNeighborCommunities(Graph &g,int community
 	return neighborCommunities;
 }
 
-std::vector<int> biLouvainMethod::findNeighborCommunitiesMap(Graph &g,int communityId)
+//The neighbor communities are the keys of the community level index, which counts the edges to every neighbor
+//community and is kept up to date on every move
+std::vector<int> biLouvainMethod::findNeighborCommunitiesMap(int communityId)
 {
-	std::vector<int> neighborCommunities;
-	std::vector<int> temp;
-
-	for(int i=0;i<_communities[communityId].getNumberNodes();i++)
-	{
-		temp =  g._graph[_communities[communityId].getNodes()[i]].getNeighborCommunities();
-		neighborCommunities.insert(neighborCommunities.end(),temp.begin(),temp.end());
-		sort(neighborCommunities.begin(),neighborCommunities.end());
-		neighborCommunities.erase(unique( neighborCommunities.begin(), neighborCommunities.end()),neighborCommunities.end());
-	}
+	NeighborCommunityIdRange temp = _communities[communityId].getNeighborCommunitiesRange();
+	std::vector<int> neighborCommunities(temp.begin(),temp.end());
+	sort(neighborCommunities.begin(),neighborCommunities.end());
 	return neighborCommunities;
 }
 
+//A neighbor community is dropped when all the edges the community has to it come from nodeId
 std::vector<int> biLouvainMethod::findNeighborCommunitiesWithoutNodeMap(Graph &g,int communityId, int nodeId)
 {
-	std::vector<int> neighborCommunities;
-	std::vector<int> temp;
-
-	for(int i=0;i<_communities[communityId].getNumberNodes()-1;i++)
+	if(_communities[communityId].getNumberNodes() <= 1)
+		return std::vector<int>();
+	std::vector<int> neighborCommunities = findNeighborCommunitiesMap(communityId);
+	std::vector<int> nodeNeighborCommunities;
+	const int* neighbors = g._graph[nodeId].getNeighborIds();
+	nodeNeighborCommunities.reserve(g._graph[nodeId].getNumberNeighbors());
+	for(int i=0;i<g._graph[nodeId].getNumberNeighbors();i++)
+		nodeNeighborCommunities.push_back(g._graph[neighbors[i]].getCommunityId());
+	sort(nodeNeighborCommunities.begin(),nodeNeighborCommunities.end());
+	std::vector<int> onlyThroughNode;
+	for(unsigned int i=0;i<nodeNeighborCommunities.size();)
+	{
+		unsigned int j = i;
+		while((j < nodeNeighborCommunities.size())&&(nodeNeighborCommunities[j] == nodeNeighborCommunities[i]))j++;
+		if(_communities[communityId].getNumberEdgesToNeighborCommunity(nodeNeighborCommunities[i]) <= (int)(j-i))
+			onlyThroughNode.push_back(nodeNeighborCommunities[i]);
+		i = j;
+	}
+	if(onlyThroughNode.size() > 0)
 	{
-		temp = g._graph[_communities[communityId].getNodesWithoutNode(nodeId)[i]].getNeighborCommunities();
-		neighborCommunities.insert(neighborCommunities.end(), temp.begin(), temp.end() );
-		sort(neighborCommunities.begin(),neighborCommunities.end());
-		neighborCommunities.erase(unique( neighborCommunities.begin(), neighborCommunities.end()),neighborCommunities.end());
+		std::vector<int>::iterator it = set_difference(neighborCommunities.begin(),neighborCommunities.end(),onlyThroughNode.begin(),onlyThroughNode.end(),neighborCommunities.begin());
+		neighborCommunities.erase(it,neighborCommunities.end());
 	}
 	return neighborCommunities;
 }
@@ -205,13 +385,13 @@ std::vector<int> biLouvainMethod::getDifferentNeighborCommunities(Graph &g,int c
 	return result;
 }
 
-std::vector<int> biLouvainMethod::getDifferentNeighborCommunitiesMap(Graph &g,int communityId1, int communityId2)
+std::vector<int> biLouvainMethod::getDifferentNeighborCommunitiesMap(int communityId1, int communityId2)
 {
 	std::vector<int> neighborsCommunity1;
 	std::vector<int> neighborsCommunity2;
 	std::vector<int>::iterator it;
-	neighborsCommunity1 = findNeighborCommunitiesMap(g,communityId1);
-	neighborsCommunity2 = findNeighborCommunitiesMap(g,communityId2);
+	neighborsCommunity1 = findNeighborCommunitiesMap(communityId1);
+	neighborsCommunity2 = findNeighborCommunitiesMap(communityId2);
 	std::vector<int> result(neighborsCommunity1.size()+neighborsCommunity2.size());
 	sort(neighborsCommunity1.begin(),neighborsCommunity1.end());
 	sort(neighborsCommunity2.begin(),neighborsCommunity2.end());
@@ -264,19 +444,20 @@ void biLouvainMethod::initialCommunityDefinitionWithIntraType(Graph &g)
 void biLouvainMethod::initialCommunityNeighborsDefinition(Graph &g)
 {
 	int key =0;
-	std::tr1::unordered_map<int,double> neighborCommunities;
+	for(unsigned int i=0;i<_communities.size();i++)
+		_communities[i].clearNeighborCommunities();
 	for(int i=0;i<g._numberNodes;i++)
 	{
+		const int* neighbors = g._graph[i].getNeighborIds();
+		const double* weights = g._graph[i].getNeighborWeights();
+		Community &community = _communities[g._graph[i].getCommunityId()];
+		g._graph[i].clearNeighborCommunities();
 		for(int j=0;j<g._graph[i].getNumberNeighbors();j++)
 		{
-			key = g._graph[g._graph[i].getNeighbors()[j]].getCommunityId();
-			if(neighborCommunities.find(key)!= neighborCommunities.end())
-				neighborCommunities[key] += g._graph[i].getWeightNeighbor(g._graph[g._graph[i].getNeighbors()[j]].getId());
-			else
-				neighborCommunities[key] = g._graph[i].getWeightNeighbor(g._graph[g._graph[i].getNeighbors()[j]].getId());
+			key = g._graph[neighbors[j]].getCommunityId();
+			g._graph[i].addNeighborCommunityWeight(key,weights[j]);
+			community.addNeighborCommunityWeight(key,weights[j]);
 		}
-		g._graph[i].setNeighborCommunities(neighborCommunities);
-		neighborCommunities.clear();
 	}
 }
 
@@ -285,20 +466,19 @@ void biLouvainMethod::initialCommunityNeighborsDefinition(Graph &g)
 void biLouvainMethod::initialIntraTypeCommunityNeighborsDefinition(Graph &g)
 {
         int key =0;
-        std::tr1::unordered_map<int,double> intraTypeNeighborCommunities;
 	for(int i=0;i<g._numberNodes;i++)
         {
+		const int* intraTypeNeighbors = g._graph[i].getIntraTypeNeighborIds();
+		const double* similarities = g._graph[i].getIntraTypeNeighborWeights();
+		g._graph[i].clearIntraTypeNeighborCommunities();
                	for(int j=0;j<g._graph[i].getNumberIntraTypeNeighbors();j++)
                	{	
-                       	key = g._graph[g._graph[i].getIntraTypeNeighbors()[j]].getCommunityId();
-	                if(intraTypeNeighborCommunities.find(key)!= intraTypeNeighborCommunities.end())
-                                intraTypeNeighborCommunities[key] += g._graph[i].getSimilarityIntraTypeNeighbor(g._graph[g._graph[i].getIntraTypeNeighbors()[j]].getId());
-               	        else
-                       	        intraTypeNeighborCommunities[key] = g._graph[i].getSimilarityIntraTypeNeighbor(g._graph[g._graph[i].getIntraTypeNeighbors()[j]].getId());
+                       	key = g._graph[intraTypeNeighbors[j]].getCommunityId();
+			g._graph[i].addIntraTypeNeighborCommunitySimilarity(key,similarities[j]);
 	        }	
-                g._graph[i].setIntraTypeNeighborCommunities(intraTypeNeighborCommunities);
-               	intraTypeNeighborCommunities.clear();
 	}	
+	for(unsigned int i=0;i<_communities.size();i++)
+		_communities[i].invalidateInternalSimilarity();
 }
 
 
@@ -324,94 +504,50 @@ void biLouvainMethod::updateNodeIntraTypeCommunity(Graph &g,int nodeId, int oldC
 
 
 //When i moves it has an impact on the communities whose neighbors were CiOld or CiNew. The move could have change the cocluster mate and the contribution
-void biLouvainMethod::updateCoClusterMateCommunities(const std::string &changes)
-{
-	int numberPieces = 0;
-	int communityId = 0;
-	int pos =  0;
-	int aux = 0;
-	double contribution = 0.0;
-	std::vector<int> coClusterMateCommunities;
-	std::string* communities = StringSplitter::split(changes,"$",numberPieces);
-	//std::cout << "\n Changes: " << changes << std::endl;
-	for(int i = 0;i<numberPieces;i++)
+void biLouvainMethod::updateCoClusterMateCommunities(CommunityChanges &changes)
+{
+	//Changes are applied in the order they were recorded, so a later record for the same community wins
+	for(int i=0;i<changes.getNumberChanges();i++)
 	{
-		//printf("%s \n",communities[i].c_str());
-		pos =  communities[i].find(":");
-		communityId = stoi(communities[i].substr(0,pos));
-
-		//Set the new cocluster mate
-		pos =  communities[i].find(",");
-		if(pos > -1)
-		{
-			aux =  communities[i].find(":")+1;
-			while(pos != std::string::npos)
-			{
-				//std::cout << "\nCommunity: " << stoi(communities[i].substr(aux,pos)) << std::endl;
-				coClusterMateCommunities.push_back(stoi(communities[i].substr(aux,pos)));
-				aux = pos + 1;
-				pos =  communities[i].find(",",aux);
-			}
-			pos =  communities[i].find(":");
-			coClusterMateCommunities.push_back(stoi(communities[i].substr(aux,pos)));
-		}
-		else
-		{
-			pos =  communities[i].find(":");
-			aux =  communities[i].find("#");
-			coClusterMateCommunities.push_back(stoi(communities[i].substr(pos+1,aux)));
-		}
-
-		_communities[communityId].setCoClusterMateCommunityId(coClusterMateCommunities);
-		coClusterMateCommunities.clear();
-
-		//Set the new contribution to modularity
-		pos =  communities[i].find("#");
-		contribution = stod(communities[i].substr(pos+1,communities[i].length()));
-		_communities[communityId].setModularityContribution(contribution);
-		//printf("Community ID:%d  Contribution:%f \n" , communityId,contribution);
+		int communityId = changes.getCommunityId(i);
+		_communities[communityId].setCoClusterMateCommunityId(changes.getCoClusterMateCommunityIdRange(i));
+		_communities[communityId].setModularityContribution(changes.getModularityContribution(i));
 	}
 }
 
-//When i moves it changes the neighbors of CiOld and CiNew as well
+//When i moves it changes the neighbors of CiOld and CiNew as well, and the edge weights between those communities and the communities of its neighbors
 void biLouvainMethod::updateNeighborCommunities(Graph &g,int nodeId, int oldCommunityId,int newCommunityId)
 {
+	const int* neighbors = g._graph[nodeId].getNeighborIds();
+	const double* weights = g._graph[nodeId].getNeighborWeights();
 	for(int i=0;i<g._graph[nodeId].getNumberNeighbors();i++)
 	{
-		g._graph[g._graph[nodeId].getNeighbors()[i]].deleteNeighborCommunityWeight(oldCommunityId,g._graph[nodeId].getWeightNeighbor(g._graph[nodeId].getNeighbors()[i]));
-		g._graph[g._graph[nodeId].getNeighbors()[i]].addNeighborCommunityWeight(newCommunityId,g._graph[nodeId].getWeightNeighbor(g._graph[nodeId].getNeighbors()[i]));
+		int neighborCommunityId = g._graph[neighbors[i]].getCommunityId();
+		g._graph[neighbors[i]].deleteNeighborCommunityWeight(oldCommunityId,weights[i]);
+		g._graph[neighbors[i]].addNeighborCommunityWeight(newCommunityId,weights[i]);
+		_communities[oldCommunityId].deleteNeighborCommunityWeight(neighborCommunityId,weights[i]);
+		_communities[newCommunityId].addNeighborCommunityWeight(neighborCommunityId,weights[i]);
+		_communities[neighborCommunityId].deleteNeighborCommunityWeight(oldCommunityId,weights[i]);
+		_communities[neighborCommunityId].addNeighborCommunityWeight(newCommunityId,weights[i]);
 	}
 }
 
 //When i moves it changes the beta factor of CiOld and CiNew as well
 void biLouvainMethod::updateIntraTypeNeighborCommunities(Graph &g,int nodeId, int oldCommunityId,int newCommunityId)
 {
+	const int* intraTypeNeighbors = g._graph[nodeId].getIntraTypeNeighborIds();
+	const double* similarities = g._graph[nodeId].getIntraTypeNeighborWeights();
 	for(int i=0;i<g._graph[nodeId].getNumberIntraTypeNeighbors();i++)
         {
-		g._graph[g._graph[nodeId].getIntraTypeNeighbors()[i]].deleteIntraTypeNeighborCommunitySimilarity(oldCommunityId,g._graph[nodeId].getSimilarityIntraTypeNeighbor(g._graph[nodeId].getIntraTypeNeighbors()[i]));
-	        g._graph[g._graph[nodeId].getIntraTypeNeighbors()[i]].addIntraTypeNeighborCommunitySimilarity(newCommunityId,g._graph[nodeId].getSimilarityIntraTypeNeighbor(g._graph[nodeId].getIntraTypeNeighbors()[i]));
+		g._graph[intraTypeNeighbors[i]].deleteIntraTypeNeighborCommunitySimilarity(oldCommunityId,similarities[i]);
+	        g._graph[intraTypeNeighbors[i]].addIntraTypeNeighborCommunitySimilarity(newCommunityId,similarities[i]);
+		_communities[g._graph[intraTypeNeighbors[i]].getCommunityId()].invalidateInternalSimilarity();
 	}
 }
 
 
 //Methods for Graph compaction at the end of each Phase. It helps to go out of local maximum
 
-std::tr1::unordered_map<int,int> biLouvainMethod::dictionaryCommunitiesNewId()
-{
-	std::tr1::unordered_map<int,int> dictionaryCommunities;
-	int id = 0;
-	for(int i=0;i<_numberCommunities;i++)
-	{
-		if(_communities[i].getNumberNodes()>0)
-		{
-			dictionaryCommunities[_communities[i].getId()] = id;
-			 //printf("\nCommunity: %d      Dic: %d", i,id);
-			id++;
-		}
-	}
-	return dictionaryCommunities;
-}
-
 int biLouvainMethod::numberCommunitiesNonEmpty()
 {
 	int result = 0;
@@ -423,122 +559,138 @@ int biLouvainMethod::numberCommunitiesNonEmpty()
 	return result;
 }
 
-std::tr1::unordered_map<int,double> biLouvainMethod::compactMetaNodeNeighbors(Graph &g,int &communityId, std::tr1::unordered_map<int,int> &dictionaryCommunities)
+//Adds up the edges (or the similarities) from the members of a community to every community of the compacted graph.
+//Members and edges are visited in the same order whatever the number of threads, so the weights do not depend on it.
+//The row is appended sorted by neighbor id; returns its length.
+int biLouvainMethod::compactCommunityRow(Graph &g,int communityId,const std::vector<int> &newIds,bool intraType,rowAccumulator &accumulator,std::vector<int> &rowNeighbors,std::vector<double> &rowWeights)
 {
- 	std::tr1::unordered_map<int,long double> neighborsTemp;
-        std::tr1::unordered_map<int,long double> errorCalculation;
-	std::tr1::unordered_map<int,double> neighbors;
- 	for(int j=0; j<_communities[communityId].getNumberNodes();j++)
-        {
-		std::vector<Node> temp = g._graph[_communities[communityId].getNodes()[j]].getNodes();
-                nodes.insert(nodes.end(),temp.begin(),temp.end());
-                //std::cout << "Community: " << _communities[communityId].getId()<<" Node: "<<_communities[i].getNodes()[j]<<" #Nei: "<<g._graph[_communities[communityId].getNodes()[j]].getNumberNeighbors()<<std::endl;
-	        long double y = 0.0, t = 0.0;
-        	for(int k=0; k<g._graph[_communities[communityId].getNodes()[j]].getNumberNeighbors();k++)
-        	{
-        		int idNeighbor = dictionaryCommunities[g._graph[g._graph[_communities[communityId].getNodes()[j]].getNeighbors()[k]].getCommunityId()]; 
-                	if(neighborsTemp.find(idNeighbor)!= neighborsTemp.end())
-                	{
-                		y= g._graph[_communities[communityId].getNodes()[j]].getWeightNeighbor(g._graph[_communities[communityId].getNodes()[j]].getNeighbors()[k])-errorCalculation[idNeighbor];
-                        	t = neighborsTemp[idNeighbor] + y;
-                        	errorCalculation[idNeighbor] = (t - neighborsTemp[idNeighbor]) - y;
-                     	   	neighborsTemp[idNeighbor] = t;
-                	}
-                	else
-                	{
-                		neighborsTemp[idNeighbor] = g._graph[_communities[communityId].getNodes()[j]].getWeightNeighbor(g._graph[_communities[communityId].getNodes()[j]].getNeighbors()[k]);
-                        	errorCalculation[idNeighbor] = 0.0;
-                	}
-        	}
+	accumulator.epoch++;
+	accumulator.touched.clear();
+	MemberIdRange members = _communities[communityId].getNodesRange();
+	for(auto it=members.begin();it!=members.end();++it)
+	{
+		MetaNode &member = g._graph[*it];
+		const int* memberNeighbors = intraType ? member.getIntraTypeNeighborIds() : member.getNeighborIds();
+		const double* memberWeights = intraType ? member.getIntraTypeNeighborWeights() : member.getNeighborWeights();
+		int numberNeighbors = intraType ? member.getNumberIntraTypeNeighbors() : member.getNumberNeighbors();
+		for(int k=0;k<numberNeighbors;k++)
+		{
+			int idNeighbor = newIds[g._graph[memberNeighbors[k]].getCommunityId()];
+			if(accumulator.marks[idNeighbor] != accumulator.epoch)
+			{
+				accumulator.marks[idNeighbor] = accumulator.epoch;
+				accumulator.touched.push_back(idNeighbor);
+				accumulator.sums[idNeighbor] = memberWeights[k];
+				accumulator.errors[idNeighbor] = 0.0;
+			}
+			else if(_compensatedSummation)
+			{
+				long double y = memberWeights[k] - accumulator.errors[idNeighbor];
+				long double t = accumulator.sums[idNeighbor] + y;
+				accumulator.errors[idNeighbor] = (t - accumulator.sums[idNeighbor]) - y;
+				accumulator.sums[idNeighbor] = t;
+			}
+			else
+				accumulator.sums[idNeighbor] += memberWeights[k];
+		}
 	}
-       	//errorCalculation.clear();
-        //std::stringstream line;
-        //line.precision(64);
-        //std::cout<<"\nCommunity: " << id;
-	for(auto it=neighborsTemp.begin();it!=neighborsTemp.end();++it)
-        	neighbors[it->first] = (double)it->second;
-        /*      line << "N: " << it->first <<"\t Weight: " << it->second << std::endl;
-                std::cout << line.str();
-                line.str("");
-        }*/
-	return neighbors;
-}
-
-
-std::tr1::unordered_map<int,double> biLouvainMethod::compactMetaNodeIntraTypeNeighbors(Graph &g,int &communityId, std::tr1::unordered_map<int,int> &dictionaryCommunities)
-{
-        std::tr1::unordered_map<int,long double> neighborsTemp;
-	std::tr1::unordered_map<int,double> neighbors;
-        std::tr1::unordered_map<int,long double> errorCalculation;
-        for(int j=0; j<_communities[communityId].getNumberNodes();j++)
-        {
-                long double y = 0.0, t = 0.0;
-                for(int k=0; k<g._graph[_communities[communityId].getNodes()[j]].getNumberIntraTypeNeighbors();k++)
-                {
-                        int idNeighbor = dictionaryCommunities[g._graph[g._graph[_communities[communityId].getNodes()[j]].getIntraTypeNeighbors()[k]].getCommunityId()];
-                        if(neighborsTemp.find(idNeighbor)!= neighborsTemp.end())
-                        {
-                                y= g._graph[_communities[communityId].getNodes()[j]].getSimilarityIntraTypeNeighbor(g._graph[_communities[communityId].getNodes()[j]].getIntraTypeNeighbors()[k])-errorCalculation[idNeighbor];
-                                t = neighborsTemp[idNeighbor] + y;
-                                errorCalculation[idNeighbor] = (t - neighborsTemp[idNeighbor]) - y;
-                                neighborsTemp[idNeighbor] = t;
-                        }
-                        else
-                        {
-                                neighborsTemp[idNeighbor] = g._graph[_communities[communityId].getNodes()[j]].getSimilarityIntraTypeNeighbor(g._graph[_communities[communityId].getNodes()[j]].getIntraTypeNeighbors()[k]);
-                                errorCalculation[idNeighbor] = 0.0;
-                        }
-                }
-        }
-	for(auto it=neighborsTemp.begin();it!=neighborsTemp.end();++it)
-        	neighbors[it->first] = (double)it->second;
-        return neighbors;
+	sort(accumulator.touched.begin(),accumulator.touched.end());
+	for(unsigned int i=0;i<accumulator.touched.size();i++)
+	{
+		rowNeighbors.push_back(accumulator.touched[i]);
+		rowWeights.push_back((double)accumulator.sums[accumulator.touched[i]]);
+	}
+	return accumulator.touched.size();
 }
 
+//The non-empty communities become the metanodes of the compacted graph, numbered in community order. Blocks of
+//consecutive metanodes are compacted in parallel, each into its own buffer, and the buffers are then copied into the
+//CSR arrays at the offsets given by the prefix sum of the row lengths.
 void biLouvainMethod::fromCommunitiesToNodes(Graph &g)
 {
 	int lastIdPartitionV1 = -1;
-	std::tr1::unordered_map<int,int> dictionaryCommunities = dictionaryCommunitiesNewId();
-	int numberNodes = dictionaryCommunities.size();
-	MetaNode*_newGraph = new MetaNode[numberNodes];
-	std::tr1::unordered_map<int,double> neighbors;
-	//std::cout << "\nPrint del from: "<< numberNodes << "\t " << dictionaryCommunities.size() << std::endl;
-	int id =0;
+	std::vector<int> newIds(_numberCommunities,-1);
+	std::vector<int> communityIds;
 	for(int i=0;i<_numberCommunities;i++)
 	{
 		if(_communities[i].getNumberNodes()>0)
 		{
-			neighbors = compactMetaNodeNeighbors(g,i,dictionaryCommunities);
-			MetaNode metanode(id,_communities[i].getDescription(),nodes,neighbors,-1);
-			_newGraph[id] = metanode;
-			if(_alpha != 1.0)
+			newIds[i] = communityIds.size();
+			communityIds.push_back(i);
+			if(_communities[i].getDescription()=="V1")
+				lastIdPartitionV1++;
+		}
+	}
+	int numberNodes = communityIds.size();
+	MetaNode*_newGraph = new MetaNode[numberNodes];
+	bool intraType = (_alpha != 1.0);
+	int numberThreads = std::max(_numberThreads,1);
+	int numberBlocks = std::min(numberNodes,numberThreads*8);
+	std::vector<rowAccumulator> accumulators(numberThreads);
+	for(int t=0;t<numberThreads;t++)
+	{
+		accumulators[t].sums.assign(numberNodes,0.0);
+		accumulators[t].errors.assign(numberNodes,0.0);
+		accumulators[t].marks.assign(numberNodes,0);
+		accumulators[t].epoch = 0;
+	}
+	std::vector<std::vector<int> > blockNeighbors(numberBlocks), blockIntraTypeNeighbors(numberBlocks);
+	std::vector<std::vector<double> > blockWeights(numberBlocks), blockSimilarities(numberBlocks);
+	std::vector<int> offsets(numberNodes+1,0), intraTypeOffsets(numberNodes+1,0);
+	#pragma omp parallel for schedule(dynamic,1) num_threads(numberThreads)
+	for(int b=0;b<numberBlocks;b++)
+	{
+		rowAccumulator &accumulator = accumulators[omp_get_thread_num()];
+		std::vector<Node> nodes;
+		for(int id=(long long)numberNodes*b/numberBlocks;id<(long long)numberNodes*(b+1)/numberBlocks;id++)
+		{
+			int communityId = communityIds[id];
+			MemberIdRange members = _communities[communityId].getNodesRange();
+			for(auto it=members.begin();it!=members.end();++it)
 			{
-				neighbors.clear();
-				neighbors = compactMetaNodeIntraTypeNeighbors(g,i,dictionaryCommunities);
-				_newGraph[id].setIntraTypeNeighbors(neighbors);
-			//	printf("\nPrint del from:::Community: %d    BF: %f ",i,_communities[i].getBetaFactor());
+				const std::vector<Node> &temp = g._graph[*it].getNodesReference();
+				nodes.insert(nodes.end(),temp.begin(),temp.end());
 			}
-			if(metanode.getType()=="V1")
-				lastIdPartitionV1++;
-			id++;
+			_newGraph[id] = MetaNode(id,_communities[communityId].getDescription(),nodes,-1);
 			nodes.clear();
-			neighbors.clear();
+			offsets[id+1] = compactCommunityRow(g,communityId,newIds,false,accumulator,blockNeighbors[b],blockWeights[b]);
+			if(intraType)
+				intraTypeOffsets[id+1] = compactCommunityRow(g,communityId,newIds,true,accumulator,blockIntraTypeNeighbors[b],blockSimilarities[b]);
 		}
 	}
-	Graph compactedGraph(_newGraph,numberNodes,g._numberEdges,g._weightEdges,g._weightEdgesV1,g._weightEdgesV2,lastIdPartitionV1);
-	if(_alpha != 1.0)
+	std::vector<rowAccumulator>().swap(accumulators);
+	for(int i=0;i<numberNodes;i++)
+	{
+		offsets[i+1] += offsets[i];
+		intraTypeOffsets[i+1] += intraTypeOffsets[i];
+	}
+	std::vector<int> neighbors(offsets[numberNodes]), intraTypeNeighbors(intraTypeOffsets[numberNodes]);
+	std::vector<double> weights(offsets[numberNodes]), similarities(intraTypeOffsets[numberNodes]);
+	#pragma omp parallel for schedule(dynamic,1) num_threads(numberThreads)
+	for(int b=0;b<numberBlocks;b++)
 	{
-		compactedGraph.setLambdaV1(g._lambdaV1);
-		compactedGraph.setLambdaV2(g._lambdaV2);
-		compactedGraph.setSimilarityV1(g._sumSimilarityV1);
-		compactedGraph.setSimilarityV2(g._sumSimilarityV2);
+		int first = (long long)numberNodes*b/numberBlocks;
+		std::copy(blockNeighbors[b].begin(),blockNeighbors[b].end(),neighbors.begin()+offsets[first]);
+		std::copy(blockWeights[b].begin(),blockWeights[b].end(),weights.begin()+offsets[first]);
+		std::copy(blockIntraTypeNeighbors[b].begin(),blockIntraTypeNeighbors[b].end(),intraTypeNeighbors.begin()+intraTypeOffsets[first]);
+		std::copy(blockSimilarities[b].begin(),blockSimilarities[b].end(),similarities.begin()+intraTypeOffsets[first]);
+		std::vector<int>().swap(blockNeighbors[b]);
+		std::vector<double>().swap(blockWeights[b]);
+		std::vector<int>().swap(blockIntraTypeNeighbors[b]);
+		std::vector<double>().swap(blockSimilarities[b]);
 	}
-	g.destroyGraph();
-	g = compactedGraph;
-	dictionaryCommunities.clear();
+	//The old rows are read until here; they are released when compactedAdjacency goes out of scope
+	CSRAdjacency compactedAdjacency(numberNodes);
+	compactedAdjacency.setNeighborRows(numberNodes,offsets,neighbors,weights);
+	if(intraType)
+		compactedAdjacency.setIntraTypeNeighborRows(intraTypeOffsets,intraTypeNeighbors,similarities);
+	g._adjacency->swap(compactedAdjacency);
+	delete[] g._graph;
+	g._graph = _newGraph;
+	g._numberNodes = numberNodes;
+	g._lastIdPartitionV1 = lastIdPartitionV1;
+	g.bindAdjacency();
 	_communities.clear();
-	//for(int i=0;i<g._numberNodes;i++)
-	//	std::cout << g._graph[i].getId() << "  " << g._graph[i].getNumberNodes() << std::endl;
 }
 
 
@@ -548,6 +700,7 @@ void biLouvainMethod::fromCommunitiesToNodes(Graph &g)
 int* biLouvainMethod::nodesOrderToProcess(Graph &g,int optionOrder)
 {
 	int* nodesOrder = new int[g._numberNodes];
+	_colorClassOffsets.clear();
 	switch(optionOrder){
 		case 1:
 		{
@@ -616,25 +769,43 @@ int* biLouvainMethod::nodesOrderToProcess(Graph &g,int optionOrder)
 		}
 		case 3:
 		{
-			//srand(time(NULL));
-			int positions[g._numberNodes];
-			for(int i=0;i<g._numberNodes;i++)   //Initialize array elements to 0
-				positions[i] = 0;
-			for(int i=0;i<g._numberNodes;i++)   //Select the order randomly with the same seed for rand
-			{
-				bool band = true;
-				int number = 0;
-				while(band)
-				{
-					number = rand() % g._numberNodes;
-					if(positions[number] == 0)
-					{
-						positions[number] = 1;
-						band = false;
-						nodesOrder[i] = number;
-					}
-				}
-			}
+			for(int i=0;i<g._numberNodes;i++)
+				nodesOrder[i] = i;
+			shuffleNodes(nodesOrder,g._numberNodes);
+			break;
+		}
+		case 4:
+		{
+			//Color classes one after the other, nodes of the same class in id order
+			int numberColors = g.colorGraph();
+			_colorClassOffsets.assign(numberColors+1,0);
+			for(int i=0;i<g._numberNodes;i++)
+				_colorClassOffsets[g._graph[i].getColor()+1]++;
+			for(int c=0;c<numberColors;c++)
+				_colorClassOffsets[c+1] += _colorClassOffsets[c];
+			std::vector<int> position(_colorClassOffsets.begin(),_colorClassOffsets.end()-1);
+			for(int i=0;i<g._numberNodes;i++)
+				nodesOrder[position[g._graph[i].getColor()]++] = i;
+			break;
+		}
+		case 5:
+		{
+			//Highest degree first, ties in id order
+			for(int i=0;i<g._numberNodes;i++)
+				nodesOrder[i] = i;
+			std::vector<double> degrees(g._numberNodes);
+			for(int i=0;i<g._numberNodes;i++)
+				degrees[i] = g._graph[i].getDegreeNode();
+			std::stable_sort(nodesOrder,nodesOrder+g._numberNodes,degreeDescending(degrees));
+			break;
+		}
+		case 6:
+		{
+			//Nodes of V1 in random order followed by the nodes of V2 in random order
+			for(int i=0;i<g._numberNodes;i++)
+				nodesOrder[i] = i;
+			shuffleNodes(nodesOrder,g._lastIdPartitionV1+1);
+			shuffleNodes(nodesOrder+g._lastIdPartitionV1+1,g._numberNodes-(g._lastIdPartitionV1+1));
 			break;
 		}
 	}
@@ -654,182 +825,350 @@ newDataCommunity biLouvainMethod::calculateDeltaGainModularity(Graph &g,MetaNode
         return newCalculationModulatiry;
 }
 
-double biLouvainMethod::calculateMaxModularityGainIteration(Graph &g,int* &nodesOrderExecution)
+//Finds the best move for node nodeId against the current state of the communities without modifying it,
+//so several nodes can be scored at the same time
+void biLouvainMethod::scoreNodeMove(Graph &g,int nodeId,moveProposal &proposal,bool collectDependencies)
 {
-	struct timeval t1,t2,t3,t4,t5,t6;
-	double maxModularityGainIteration = 0.0;  
-	std::vector<int> candidates;
+	std::vector<int> &candidates = proposal.candidates;
+	CommunityChanges &changes = proposal.changes;
+	CommunityChanges &candidateChanges = proposal.candidateChanges;
+	CommunityChanges &maxChangesCandidate = proposal.maxChangesCandidate;
+	MetaNode &node = g._graph[nodeId];
 	double lambda = 0.0;
 	double lambdaD = 0.0;
-	double betaFactorCurrentCommunity = 0.0;
+	double gainDoble = 0.0;
+	newDataCommunity deltaModularityGain;
+	double maxDeltaModularityGain = -1.0;
+	double totalDeltaModularityGain = 0.0;
 	double betaFactorCandidateCommunity = 0.0;
-	for(int i=0;i<g._numberNodes;i++)
+	int currentCommunity = node.getCommunityId();
+	proposal.nodeId = nodeId;
+	proposal.currentCommunity = currentCommunity;
+	if(_alpha != 1.0)
 	{
-		std::stringstream gainString;
-		double gainDoble = 0.0;
-		std::stringstream changes;
-		newDataCommunity deltaModularityGain;
-		double maxDeltaModularityGain = -1.0;
-		double totalDeltaModularityGain = 0.0;
-		int currentCommunity = g._graph[nodesOrderExecution[i]].getCommunityId();
-		if(_alpha != 1.0)
+		if(_communities[currentCommunity].getDescription()=="V1")
 		{
-			if(_communities[currentCommunity].getDescription()=="V1")
-			{
-				lambda = g._lambdaV1;
-				lambdaD = g._lambdaV2;
-			}
-			else
-			{
-				lambda = g._lambdaV2;
-				lambdaD = g._lambdaV1;
-			}
+			lambda = g._lambdaV1;
+			lambdaD = g._lambdaV2;
 		}
-		//Find CANDIDATE COMMUNITIES to which node i can move to
-		gettimeofday(&t1,NULL);
-		std::vector<int> temp;
-		if(_alpha != 0.0)
+		else
+		{
+			lambda = g._lambdaV2;
+			lambdaD = g._lambdaV1;
+		}
+	}
+	//Find CANDIDATE COMMUNITIES to which node i can move to
+	PROFILE_COUNT(_profiler,PROFILE_VERTICES_EVALUATED,1);
+	PROFILE_START(candidatesStart);
+	candidates.clear();
+	if(_alpha != 0.0)
+	{
+		IdRange neighbors = node.getNeighborsRange();
+		for(auto it=neighbors.begin();it!=neighbors.end();++it)
 		{
-			for(int j=0;j<g._graph[nodesOrderExecution[i]].getNumberNeighbors();j++)
+			CommunityIdRange temp = g._graph[*it].getNeighborCommunitiesRange();
+			candidates.insert(candidates.end(),temp.begin(),temp.end());
+		}
+	}
+	if(_alpha != 1.0) 
+	{
+		CommunityIdRange temp = node.getIntraTypeNeighborCommunitiesRange();
+                candidates.insert(candidates.end(),temp.begin(),temp.end());
+	}	
+	sort(candidates.begin(),candidates.end());
+	candidates.erase(unique(candidates.begin(),candidates.end()),candidates.end());
+	std::vector<int>::iterator position = find(candidates.begin(),candidates.end(),currentCommunity);
+	if (position != candidates.end()) candidates.erase(position);
+	if(collectDependencies)
+		collectMoveDependencies(proposal);
+	PROFILE_STOP(_profiler,PROFILE_STAGE_CANDIDATES,candidatesStart);
+
+	//Calculate the GAIN IN MODULARITY of the new setup of the structure if node i actually moves
+	PROFILE_START(gainStart);
+	PROFILE_COUNT(_profiler,PROFILE_CANDIDATES_SCORED,candidates.size());
+	changes.clear();
+        //Calculate Delta QB for the community to which i belongs to (Ci)
+	deltaModularityGain = calculateDeltaGainModularity(g,node,currentCommunity,0,1);
+	proposal.betaFactorCurrentCommunity = deltaModularityGain.newBetaFactor;
+	gainDoble = deltaModularityGain.newModularityContribution + _communities[currentCommunity].getModularityContribution();
+	changes.addChange(deltaModularityGain,gainDoble);
+	totalDeltaModularityGain += deltaModularityGain.newModularityContribution;
+	//Calculate Delta QB for the set of candidate communities (Cj)
+	int candidateCommunity = -1;
+	maxChangesCandidate.clear();
+	if(candidates.size()>0)
+	{
+		double betaF = 0.0;
+		double candidateDeltaModularityGain = 0.0;
+		betaFactorCandidateCommunity = _communities[currentCommunity].getBetaFactor();
+		for(unsigned int j=0;j<candidates.size();j++)
+		{
+			candidateDeltaModularityGain = 0.0;				
+			betaF = 0.0;
+			candidateChanges.clear();
+			deltaModularityGain = calculateDeltaGainModularity(g,node,candidates[j],currentCommunity,2);
+			betaF = deltaModularityGain.newBetaFactor;
+			gainDoble = deltaModularityGain.newModularityContribution + _communities[candidates[j]].getModularityContribution();
+			candidateChanges.addChange(deltaModularityGain,gainDoble);
+			 candidateDeltaModularityGain += deltaModularityGain.newModularityContribution;
+			//Calculate Delta QB for neighbors of candidate communities (Dj)
+			if((betaF >= lambda)&&(betaF > betaFactorCandidateCommunity))
 			{
-				temp = g._graph[g._graph[nodesOrderExecution[i]].getNeighbors()[j]].getNeighborCommunities();
-				candidates.insert(candidates.end(),temp.begin(),temp.end());
-				temp.clear();
+				std::vector<int>neighborCommunities = findNeighborCommunitiesMap(candidates[j]);
+				//A candidate whose bound cannot beat the best one so far can not be chosen, so its neighbor communities are not scored
+				if((_alpha != 0.0)&&(candidateDeltaModularityGain + neighborCommunitiesGainBound(g,node,candidates[j],neighborCommunities) <= maxDeltaModularityGain))
+				{
+					PROFILE_COUNT(_profiler,PROFILE_CANDIDATES_PRUNED,1);
+					continue;
+				}
+				for(unsigned int k=0;k<neighborCommunities.size();k++)
+				{	
+					deltaModularityGain = calculateDeltaGainModularity(g,node,neighborCommunities[k],candidates[j],4);
+					gainDoble = deltaModularityGain.newModularityContribution + _communities[neighborCommunities[k]].getModularityContribution();
+					candidateChanges.addChange(deltaModularityGain,gainDoble);
+					candidateDeltaModularityGain += deltaModularityGain.newModularityContribution;
+				}
+				if((candidateDeltaModularityGain > maxDeltaModularityGain)&&(betaF > _communities[currentCommunity].getBetaFactor()))
+				{
+					maxDeltaModularityGain = candidateDeltaModularityGain;
+					candidateCommunity = candidates[j];
+					maxChangesCandidate.swap(candidateChanges);
+					if(_alpha != 1.0)
+						betaFactorCandidateCommunity = betaF;
+				}
 			}
 		}
-		if(_alpha != 1.0) 
+		changes.addChanges(maxChangesCandidate);
+		totalDeltaModularityGain += maxDeltaModularityGain;
+	}
+	proposal.candidateCommunity = -1;
+	if((candidateCommunity != -1)&&(betaFactorCandidateCommunity >= lambda))
+	{	
+		//Calculate Delta QB for the neighbors of Ci (Di)		
+		std::vector<int> differentNeighborCommunities = getDifferentNeighborCommunitiesMap(currentCommunity,candidateCommunity);
+		for(unsigned int j=0;j<differentNeighborCommunities.size();j++)
 		{
-			temp = g._graph[nodesOrderExecution[i]].getIntraTypeNeighborCommunities();
-                        candidates.insert(candidates.end(),temp.begin(),temp.end());
-                        temp.clear();
-		}	
-		sort(candidates.begin(),candidates.end());
-		candidates.erase(unique(candidates.begin(),candidates.end()),candidates.end());
-		std::vector<int>::iterator position = find(candidates.begin(),candidates.end(),currentCommunity);
-		if (position != candidates.end()) candidates.erase(position);
-		gettimeofday(&t2,NULL);
-
-		/*printf("\n Node: %d \n",_graph[nodesOrderExecution[i]].getId());
-		StringSplitter::printVector(candidates);
-		printf("\n");*/
-
-		//Calculate the GAIN IN MODULARITY of the new setup of the structure if node i actually moves
-		gettimeofday(&t3,NULL);
-		changes.str("");
-		//changes.precision(64);
-		//printf("1 \n");
-                //Calculate Delta QB for the community to which i belongs to (Ci)
-		deltaModularityGain = calculateDeltaGainModularity(g,g._graph[nodesOrderExecution[i]],currentCommunity,0,1);
-		betaFactorCurrentCommunity = deltaModularityGain.newBetaFactor;
-		gainDoble = deltaModularityGain.newModularityContribution + _communities[currentCommunity].getModularityContribution();
-		changes << deltaModularityGain.coClusterMateCommunityId << "#" << gainDoble << "$";
-		//gainString << gainDoble;
-		//totalDeltaModularityGain += deltaModularityGain.newModularityContribution - (gainDoble - stof(gainString.str()));
-		totalDeltaModularityGain += deltaModularityGain.newModularityContribution;
-		//Calculate Delta QB for the set of candidate communities (Cj)
-		int candidateCommunity = -1;
-		std::stringstream maxChangesCandidate;
-		if(candidates.size()>0)
+			deltaModularityGain = calculateDeltaGainModularity(g,node,differentNeighborCommunities[j],candidateCommunity,3);
+			gainDoble = deltaModularityGain.newModularityContribution + _communities[differentNeighborCommunities[j]].getModularityContribution();
+			changes.addChange(deltaModularityGain,gainDoble);
+			totalDeltaModularityGain += deltaModularityGain.newModularityContribution;
+		}
+		proposal.candidateCommunity = candidateCommunity;
+	}
+	PROFILE_STOP(_profiler,PROFILE_STAGE_GAIN,gainStart);
+	proposal.betaFactorCandidateCommunity = betaFactorCandidateCommunity;
+	proposal.totalDeltaModularityGain = totalDeltaModularityGain;
+}
+
+//Commits the move found by scoreNodeMove if it increases the modularity. Returns true if the node moved
+bool biLouvainMethod::applyNodeMove(Graph &g,moveProposal &proposal)
+{
+	if((proposal.candidateCommunity == -1)||(proposal.totalDeltaModularityGain <= 0.0))
+		return false;
+	int nodeId = proposal.nodeId;
+	int currentCommunity = proposal.currentCommunity;
+	int candidateCommunity = proposal.candidateCommunity;
+	PROFILE_START(updateStart);
+	if(_activeSet)
+		activateMoveNeighborhood(g,proposal);
+	updateNodeCommunity(g,g._graph[nodeId].getId(),currentCommunity,candidateCommunity);
+	updateCoClusterMateCommunities(proposal.changes);
+	updateNeighborCommunities(g,g._graph[nodeId].getId(),currentCommunity,candidateCommunity);
+	if(_alpha != 1.0)
+	{
+	    _communities[candidateCommunity].setBetaFactor(proposal.betaFactorCandidateCommunity);
+	    _communities[currentCommunity].setBetaFactor(proposal.betaFactorCurrentCommunity);
+	    updateNodeIntraTypeCommunity(g,g._graph[nodeId].getId(),currentCommunity,candidateCommunity);
+	    updateIntraTypeNeighborCommunities(g,g._graph[nodeId].getId(),currentCommunity,candidateCommunity);
+	}
+	if(_verbose)
+		printf("\n Node: %d  From Community: %d  To Community: %d  Maximum Modularity Gain: %.15lf",g._graph[nodeId].getId(), currentCommunity,candidateCommunity,proposal.totalDeltaModularityGain);
+	PROFILE_STOP(_profiler,PROFILE_STAGE_UPDATE,updateStart);
+	PROFILE_COUNT(_profiler,PROFILE_MOVES_ACCEPTED,1);
+	return true;
+}
+
+//Communities whose state is read while scoring a move: the current community, the candidates and their neighbor communities.
+//The co-cluster mates evaluated for them are one more hop away, which is covered by markMoveConflicts marking one hop further.
+void biLouvainMethod::collectMoveDependencies(moveProposal &proposal)
+{
+	std::vector<int> &dependencies = proposal.dependencies;
+	dependencies.clear();
+	dependencies.push_back(proposal.currentCommunity);
+	dependencies.insert(dependencies.end(),proposal.candidates.begin(),proposal.candidates.end());
+	int numberDirect = dependencies.size();
+	for(int i=0;i<numberDirect;i++)
+	{
+		NeighborCommunityIdRange neighbors = _communities[dependencies[i]].getNeighborCommunitiesRange();
+		dependencies.insert(dependencies.end(),neighbors.begin(),neighbors.end());
+	}
+}
+
+bool biLouvainMethod::hasMoveConflicts(moveProposal &proposal)
+{
+	for(unsigned int i=0;i<proposal.dependencies.size();i++)
+	{
+		if(_conflictEpoch[proposal.dependencies[i]] == _epoch)
+			return true;
+	}
+	return false;
+}
+
+//Marks the communities written by a committed move, plus their neighbor communities, as modified in the current batch
+void biLouvainMethod::markMoveConflicts(Graph &g,moveProposal &proposal)
+{
+	std::vector<int> &modified = proposal.candidates;
+	modified.clear();
+	modified.push_back(proposal.currentCommunity);
+	modified.push_back(proposal.candidateCommunity);
+	for(int i=0;i<proposal.changes.getNumberChanges();i++)
+		modified.push_back(proposal.changes.getCommunityId(i));
+	if(_alpha != 1.0)
+	{
+		//Their cached internal similarity was invalidated by the move
+		IdRange intraTypeNeighbors = g._graph[proposal.nodeId].getIntraTypeNeighborsRange();
+		for(auto it=intraTypeNeighbors.begin();it!=intraTypeNeighbors.end();++it)
+			modified.push_back(g._graph[*it].getCommunityId());
+	}
+	for(unsigned int i=0;i<modified.size();i++)
+	{
+		if(modified[i] < 0) continue;
+		_conflictEpoch[modified[i]] = _epoch;
+		NeighborCommunityIdRange neighbors = _communities[modified[i]].getNeighborCommunitiesRange();
+		for(auto it=neighbors.begin();it!=neighbors.end();++it)
+			_conflictEpoch[*it] = _epoch;
+	}
+}
+
+//Nodes later in the current sweep are scored in it, the others in the next one
+void biLouvainMethod::activateNode(int nodeId)
+{
+	_activeNodes[nodeId] = 1;
+	_nextActiveNodes[nodeId] = 1;
+}
+
+//Activates the nodes whose best move may have changed because of a committed move: the node, its neighbors and the
+//members of the communities whose co-cluster mates changed or whose contribution changed by more than the tolerance.
+//It has to be called before the changes of the move are applied.
+void biLouvainMethod::activateMoveNeighborhood(Graph &g,moveProposal &proposal)
+{
+	activateNode(proposal.nodeId);
+	IdRange neighbors = g._graph[proposal.nodeId].getNeighborsRange();
+	for(auto it=neighbors.begin();it!=neighbors.end();++it)
+		activateNode(*it);
+	if(_alpha != 1.0)
+	{
+		IdRange intraTypeNeighbors = g._graph[proposal.nodeId].getIntraTypeNeighborsRange();
+		for(auto it=intraTypeNeighbors.begin();it!=intraTypeNeighbors.end();++it)
+			activateNode(*it);
+	}
+	CommunityChanges &changes = proposal.changes;
+	for(int i=0;i<changes.getNumberChanges();i++)
+	{
+		Community &community = _communities[changes.getCommunityId(i)];
+		IdRange oldMates = community.getCoClusterMateCommunityIdRange();
+		IdRange newMates = changes.getCoClusterMateCommunityIdRange(i);
+		bool changed = (oldMates.size() != newMates.size())||(!std::equal(oldMates.begin(),oldMates.end(),newMates.begin()));
+		if(!changed && (fabs(changes.getModularityContribution(i)-community.getModularityContribution()) <= _activeTolerance))
+			continue;
+		MemberIdRange members = community.getNodesRange();
+		for(auto it=members.begin();it!=members.end();++it)
+			activateNode(*it);
+	}
+}
+
+void biLouvainMethod::nextActiveSweep()
+{
+	_activeNodes.swap(_nextActiveNodes);
+	std::fill(_nextActiveNodes.begin(),_nextActiveNodes.end(),0);
+}
+
+double biLouvainMethod::calculateMaxModularityGainIteration(Graph &g,int* &nodesOrderExecution)
+{
+	double maxModularityGainIteration = 0.0;  
+	if(_numberThreads <= 1)
+	{
+		moveProposal proposal;
+		for(int i=0;i<g._numberNodes;i++)
 		{
-			std::stringstream temp;
-			double betaF = 0.0;
-			double candidateDeltaModularityGain = 0.0;
-			//betaFactorCandidateCommunity = 0.0;
-			betaFactorCandidateCommunity = _communities[currentCommunity].getBetaFactor();
-			for(unsigned int j=0;j<candidates.size();j++)
+			if(_activeSet && !_activeNodes[nodesOrderExecution[i]])
+				continue;
+			scoreNodeMove(g,nodesOrderExecution[i],proposal,false);
+			if(applyNodeMove(g,proposal))
+				maxModularityGainIteration += proposal.totalDeltaModularityGain;
+		}
+		if(_activeSet)
+			nextActiveSweep();
+		return maxModularityGainIteration;
+	}
+
+	//Parallel mode: a batch of nodes is scored concurrently against the same state and the moves are then committed in
+	//processing order. A proposal whose dependencies were modified by an earlier commit of the same batch is scored again
+	//before committing, so every move is decided on the same state as in the sequential mode and the result does not
+	//depend on the number of threads.
+	//With the color order the batches of a color class at least a batch long stay inside it: nodes of such a batch share
+	//no neighbors, so the neighbor community maps they read are not touched by each other's moves and only community
+	//level changes cause re-scoring. The greedy coloring leaves many small classes; they are gathered into full batches,
+	//where a move changing a map read by a later node of the batch marks the node's old community, which that node
+	//depends on, and the node is scored again.
+	std::vector<moveProposal> proposals(std::min(_batchSize,g._numberNodes));
+	_conflictEpoch.assign(_numberCommunities,0);
+	_epoch = 0;
+	int numberColors = _colorClassOffsets.empty() ? 0 : _colorClassOffsets.size()-1;
+	for(int start=0,colorClass=1;start<g._numberNodes;)
+	{
+		int end = std::min(start+_batchSize,g._numberNodes);
+		if(numberColors > 0)
+		{
+			while(_colorClassOffsets[colorClass] <= start)
+				colorClass++;
+			if(_colorClassOffsets[colorClass]-_colorClassOffsets[colorClass-1] >= _batchSize)
+				end = std::min(end,_colorClassOffsets[colorClass]);
+			else
 			{
-				candidateDeltaModularityGain = 0.0;				
-				betaF = 0.0;
-				temp.str("");
-				//temp.precision(64);
-				//printf("2 \n"); 
-				deltaModularityGain = calculateDeltaGainModularity(g,g._graph[nodesOrderExecution[i]],candidates[j],currentCommunity,2);
-				betaF = deltaModularityGain.newBetaFactor;
-				gainDoble = deltaModularityGain.newModularityContribution + _communities[candidates[j]].getModularityContribution();
-				temp << deltaModularityGain.coClusterMateCommunityId << "#" << gainDoble << "$";
-                                //gainString << gainDoble;
-				//candidateDeltaModularityGain += deltaModularityGain.newModularityContribution-(gainDoble - stof(gainString.str()));
-				 candidateDeltaModularityGain += deltaModularityGain.newModularityContribution;
-				//Calculate Delta QB for neighbors of candidate communities (Dj)
-				//printf("4 \n");
-				if((betaF >= lambda)&&(betaF > betaFactorCandidateCommunity))
+				//Small classes up to the next class at least a batch long
+				for(int c=colorClass;(c<numberColors)&&(_colorClassOffsets[c]<end);c++)
 				{
-					std::vector<int>neighborCommunities = findNeighborCommunitiesMap(g,candidates[j]);
-					for(unsigned int k=0;k<neighborCommunities.size();k++)
-					{	
-						deltaModularityGain = calculateDeltaGainModularity(g,g._graph[nodesOrderExecution[i]],neighborCommunities[k],candidates[j],4);
-						gainDoble = deltaModularityGain.newModularityContribution + _communities[neighborCommunities[k]].getModularityContribution();
-						temp << deltaModularityGain.coClusterMateCommunityId << "#" << gainDoble << "$";
-						//gainString.str("");
-						//gainString << gainDoble;
-					        //candidateDeltaModularityGain += deltaModularityGain.newModularityContribution-(gainDoble - stof(gainString.str()));
-						candidateDeltaModularityGain += deltaModularityGain.newModularityContribution;
-					}
-					if((candidateDeltaModularityGain > maxDeltaModularityGain)&&(betaF > _communities[currentCommunity].getBetaFactor()))
+					if(_colorClassOffsets[c+1]-_colorClassOffsets[c] >= _batchSize)
 					{
-						maxDeltaModularityGain = candidateDeltaModularityGain;
-						candidateCommunity = candidates[j];
-						maxChangesCandidate.str("");
-						maxChangesCandidate << temp.str();
-						if(_alpha != 1.0)
-							betaFactorCandidateCommunity = betaF;
+						end = _colorClassOffsets[c];
+						break;
 					}
 				}
 			}
-			candidates.clear();
-			changes << maxChangesCandidate.str();
-			maxChangesCandidate.str("");
-			totalDeltaModularityGain += maxDeltaModularityGain;
 		}
-		if((candidateCommunity != -1)&&(betaFactorCandidateCommunity >= lambda))
-		{	
-			//Calculate Delta QB for the neighbors of Ci (Di)		
-			std::vector<int> differentNeighborCommunities = getDifferentNeighborCommunitiesMap(g,currentCommunity,candidateCommunity);
-			if(differentNeighborCommunities.size()>0)
+		_epoch++;
+		#pragma omp parallel for schedule(dynamic,16) num_threads(_numberThreads)
+		for(int i=start;i<end;i++)
+		{
+			//Inactive nodes are left unscored (nodeId -1) and scored at commit time if an earlier move activated them
+			if(_activeSet && !_activeNodes[nodesOrderExecution[i]])
+				proposals[i-start].nodeId = -1;
+			else
+				scoreNodeMove(g,nodesOrderExecution[i],proposals[i-start],true);
+		}
+		for(int i=start;i<end;i++)
+		{
+			moveProposal &proposal = proposals[i-start];
+			if(_activeSet && !_activeNodes[nodesOrderExecution[i]])
+				continue;
+			if(proposal.nodeId == -1)
+				scoreNodeMove(g,nodesOrderExecution[i],proposal,false);
+			else if(hasMoveConflicts(proposal))
 			{
-				//printf("3 \n");
-				for(unsigned int j=0;j<differentNeighborCommunities.size();j++)
-				{
-					deltaModularityGain = calculateDeltaGainModularity(g,g._graph[nodesOrderExecution[i]],differentNeighborCommunities[j],candidateCommunity,3);
-					//printf("  Delta Modularity Gain: %f \n", deltaModularityGain);
-					gainDoble = deltaModularityGain.newModularityContribution + _communities[differentNeighborCommunities[j]].getModularityContribution();
-					changes << deltaModularityGain.coClusterMateCommunityId << "#" << gainDoble << "$";
-	                                //gainString << gainDoble;
-	        	       	        //totalDeltaModularityGain += deltaModularityGain.newModularityContribution - (gainDoble- stof(gainString.str()));
-					totalDeltaModularityGain += deltaModularityGain.newModularityContribution;
-				}
+				PROFILE_COUNT(_profiler,PROFILE_CONFLICT_RESCORES,1);
+				scoreNodeMove(g,nodesOrderExecution[i],proposal,false);
 			}
-			changes.str(changes.str().substr(0,changes.str().length()-1));
-			std::string changesMade = changes.str();
-			//printf("Delta Modularity Gain: %f  Changes: %s \n", totalDeltaModularityGain, changesMade.c_str());
-			gettimeofday(&t4,NULL);
-
-			//If the Gain in modularity
-			gettimeofday(&t5,NULL);
-			if(totalDeltaModularityGain > 0.0)
+			if(applyNodeMove(g,proposal))
 			{
-				updateNodeCommunity(g,g._graph[nodesOrderExecution[i]].getId(),currentCommunity,candidateCommunity);
-				updateCoClusterMateCommunities(changesMade);
-				updateNeighborCommunities(g,g._graph[nodesOrderExecution[i]].getId(),currentCommunity,candidateCommunity);
-				if(_alpha != 1.0)
-				{
-				    _communities[candidateCommunity].setBetaFactor(betaFactorCandidateCommunity);
-				    _communities[currentCommunity].setBetaFactor(betaFactorCurrentCommunity);
-				    updateNodeIntraTypeCommunity(g,g._graph[nodesOrderExecution[i]].getId(),currentCommunity,candidateCommunity);
-				    updateIntraTypeNeighborCommunities(g,g._graph[nodesOrderExecution[i]].getId(),currentCommunity,candidateCommunity);
-				}
-				printf("\n Node: %d  From Community: %d  To Community: %d  Maximum Modularity Gain: %.15lf",g._graph[nodesOrderExecution[i]].getId(), currentCommunity,candidateCommunity,totalDeltaModularityGain);
-				maxModularityGainIteration += totalDeltaModularityGain;
-				//printCommunitiesContributionModularity();
+				maxModularityGainIteration += proposal.totalDeltaModularityGain;
+				markMoveConflicts(g,proposal);
 			}
-			gettimeofday(&t6,NULL);
-			candidatesTime += (t2.tv_sec - t1.tv_sec)*1000000 + (t2.tv_usec - t1.tv_usec);
-			modularityGainTime += (t4.tv_sec - t3.tv_sec)*1000000 + (t4.tv_usec - t3.tv_usec);
-			updateTime += (t6.tv_sec - t5.tv_sec)*1000000 + (t6.tv_usec - t5.tv_usec);
 		}
-		double nodeTime = (t6.tv_sec - t1.tv_sec)*1000000 + (t6.tv_usec - t1.tv_usec);
-	   //}
+		start = end;
 	}
+	if(_activeSet)
+		nextActiveSweep();
 	return maxModularityGainIteration;
 }
 
@@ -838,7 +1177,6 @@ double biLouvainMethod::calculateMaxModularityGainIteration(Graph &g,int* &nodes
 
 double biLouvainMethod::calculateMaxModularityGainIterationIntraType(Graph &g,int* &nodesOrderExecution)
 {
-        struct timeval t1,t2,t3,t4,t5,t6;
         double maxModularityGainIteration = 0.0;
         std::vector<int> candidates;
         double lambda = 0.0;
@@ -865,14 +1203,17 @@ double biLouvainMethod::calculateMaxModularityGainIterationIntraType(Graph &g,in
                         lambdaD = g._lambdaV1;
                 }
                 //Find CANDIDATE COMMUNITIES to which node i can move to
-                gettimeofday(&t1,NULL);
-                candidates = g._graph[nodesOrderExecution[i]].getIntraTypeNeighborCommunities();
+                PROFILE_COUNT(_profiler,PROFILE_VERTICES_EVALUATED,1);
+                PROFILE_START(candidatesStart);
+                CommunityIdRange intraTypeCandidates = g._graph[nodesOrderExecution[i]].getIntraTypeNeighborCommunitiesRange();
+                candidates.assign(intraTypeCandidates.begin(),intraTypeCandidates.end());
                 sort(candidates.begin(),candidates.end());
                 std::vector<int>::iterator position = find(candidates.begin(),candidates.end(),currentCommunity);
                 if (position != candidates.end()) candidates.erase(position);
-                gettimeofday(&t2,NULL);
+                PROFILE_STOP(_profiler,PROFILE_STAGE_CANDIDATES,candidatesStart);
                 //Calculate the GAIN IN MODULARITY of the new setup of the structure if node i actually moves
-                gettimeofday(&t3,NULL);
+                PROFILE_START(gainStart);
+                PROFILE_COUNT(_profiler,PROFILE_CANDIDATES_SCORED,candidates.size());
                 //Calculate Delta QB for the community to which i belongs to (Ci)
                 deltaModularityGain = calculateDeltaGainModularity(g,g._graph[nodesOrderExecution[i]],currentCommunity,0,1);
                 betaFactorCurrentCommunity = deltaModularityGain.newBetaFactor;
@@ -904,13 +1245,13 @@ double biLouvainMethod::calculateMaxModularityGainIterationIntraType(Graph &g,in
 			candidates.clear();
                         totalDeltaModularityGain += maxDeltaModularityGain;
                 }
+                PROFILE_STOP(_profiler,PROFILE_STAGE_GAIN,gainStart);
                 if((candidateCommunity != -1)&&(betaFactorCandidateCommunity >= lambda))
                 {
-			gettimeofday(&t4,NULL);
                         //If the Gain in modularity
-                        gettimeofday(&t5,NULL);
                         if(totalDeltaModularityGain > 0.0)
                         {
+                             PROFILE_START(updateStart);
                              updateNodeCommunity(g,g._graph[nodesOrderExecution[i]].getId(),currentCommunity,candidateCommunity);
                              updateNeighborCommunities(g,g._graph[nodesOrderExecution[i]].getId(),currentCommunity,candidateCommunity);
 			     _communities[candidateCommunity].setBetaFactor(betaFactorCandidateCommunity);
@@ -919,17 +1260,14 @@ double biLouvainMethod::calculateMaxModularityGainIterationIntraType(Graph &g,in
                              _communities[currentCommunity].setModularityContribution(newContributionCurrentCommunity);	
                              updateNodeIntraTypeCommunity(g,g._graph[nodesOrderExecution[i]].getId(),currentCommunity,candidateCommunity);
                              updateIntraTypeNeighborCommunities(g,g._graph[nodesOrderExecution[i]].getId(),currentCommunity,candidateCommunity);
-                             printf("\n Node: %d  From Community: %d  To Community: %d  Maximum Modularity Gain: %.15lf",g._graph[nodesOrderExecution[i]].getId(), currentCommunity,candidateCommunity,totalDeltaModularityGain);
+                             if(_verbose)
+                                     printf("\n Node: %d  From Community: %d  To Community: %d  Maximum Modularity Gain: %.15lf",g._graph[nodesOrderExecution[i]].getId(), currentCommunity,candidateCommunity,totalDeltaModularityGain);
 			     maxModularityGainIteration += totalDeltaModularityGain;
+                             PROFILE_STOP(_profiler,PROFILE_STAGE_UPDATE,updateStart);
+                             PROFILE_COUNT(_profiler,PROFILE_MOVES_ACCEPTED,1);
                              //printCommunitiesContributionModularity();
                         }
-                        gettimeofday(&t6,NULL);
-                        candidatesTime += (t2.tv_sec - t1.tv_sec)*1000000 + (t2.tv_usec - t1.tv_usec);
-                        modularityGainTime += (t4.tv_sec - t3.tv_sec)*1000000 + (t4.tv_usec - t3.tv_usec);
-                        updateTime += (t6.tv_sec - t5.tv_sec)*1000000 + (t6.tv_usec - t5.tv_usec);
                 }
-                double nodeTime = (t6.tv_sec - t1.tv_sec)*1000000 + (t6.tv_usec - t1.tv_usec);
-           //}
         }
         return maxModularityGainIteration;
 }
@@ -954,7 +1292,9 @@ void biLouvainMethod::biLouvainMethodAlgorithm(Graph &g,double cutoffIterations,
 	}	
         std::string outputModularityGain = _outputFileName + "_ResultsModularity.txt";
 	std::ofstream outfileMG;
-	outfileMG.open(outputModularityGain.c_str(),std::ios::out|std::ios::trunc);
+	//When the results are not written the stream stays closed and the lines sent to it are dropped
+	if(_writeResults)
+		outfileMG.open(outputModularityGain.c_str(),std::ios::out|std::ios::trunc);
 
 	initialCommunityTime = 0.0;
 	initialCommunityNeighborsTime = 0.0;
@@ -965,76 +1305,146 @@ void biLouvainMethod::biLouvainMethodAlgorithm(Graph &g,double cutoffIterations,
 	precalculationCiTime = 0.0;
 	precalculationCjTime = 0.0;
 	precalculationDTime = 0.0;
+	premurataTime = 0.0;
+#ifdef BILOUVAIN_PROFILE
+	_profiler.reset(_numberThreads);
+#endif
 	struct timeval t7,t8,t9,t10,t11,t12;
 	std::stringstream line;
 	double totalModularity = 0.0;
 	double phaseModularity = 1;
 	int phases = 1;
 	int* nodesOrderExecution = NULL;
+	//Lines of the modularity file, kept for the checkpoints
+	std::string modularityLog;
+	if(_resume)
+	{
+		phases = _resumeState.phase;
+		totalModularity = _resumeState.totalModularity;
+		phaseModularity = _resumeState.phaseModularity;
+		modularityLog = _resumeState.modularityLog;
+		outfileMG << modularityLog;
+		_random.setState(_resumeState.randomState);
+		_dendrogram = _resumeState.dendrogram;
+		_resume = false;
+		if(_verbose)
+			printf("\n\n ::: Resuming from the checkpoint of phase %d :::",phases-1);
+	}
+	else
+	{
+		_dendrogram.clear();
+		_dendrogram.setLeaves(nodeOfInputNodes(g));
+	}
 
 	//PHASE
 	while((phaseModularity-totalModularity) > cutoffPhase)
 	{
 		//INITIALIZATION STEPS
 		gettimeofday(&t7,NULL);
+		PROFILE_START(stageStart);
 		if(alpha != 1.0)
 			initialCommunityDefinitionWithIntraType(g);
 		else
 			initialCommunityDefinition(g);
 		gettimeofday(&t8,NULL);
 		initialCommunityTime += (t8.tv_sec - t7.tv_sec)*1000000 + (t8.tv_usec - t7.tv_usec);
+		PROFILE_STOP(_profiler,PROFILE_STAGE_INITIAL_COMMUNITIES,stageStart);
 		gettimeofday(&t9,NULL);
+		PROFILE_START(neighborsStart);
 		initialCommunityNeighborsDefinition(g);
 		if(alpha != 1.0)
 			initialIntraTypeCommunityNeighborsDefinition(g);
 		gettimeofday(&t10,NULL);
 		initialCommunityNeighborsTime += (t10.tv_sec - t9.tv_sec)*1000000 + (t10.tv_usec - t9.tv_usec);
+		PROFILE_STOP(_profiler,PROFILE_STAGE_NEIGHBOR_COMMUNITIES,neighborsStart);
 		gettimeofday(&t11,NULL);
+		PROFILE_START(coClusterStart);
 		totalModularity = CoClusterMateDefinitionAllCommunities(g,0,_numberCommunities);
 		phaseModularity = totalModularity;
 		gettimeofday(&t12,NULL);
 		initialCoClusterMateTime += (t12.tv_sec - t11.tv_sec)*1000000 + (t12.tv_usec - t11.tv_usec);
+		PROFILE_STOP(_profiler,PROFILE_STAGE_COCLUSTER_MATES,coClusterStart);
 
-		printf("\n\n ::: Phase %d :::", phases);
+		if(_verbose)
+			printf("\n\n ::: Phase %d :::", phases);
 		line.str("");
 		line << "--- Phase: " <<  phases << "\n";
 		outfileMG << line.str();
-		printf("\n Initial Total partitioning modularity: %.15lf", totalModularity);
+		modularityLog += line.str();
+		if(_verbose)
+			printf("\n Initial Total partitioning modularity: %.15lf", totalModularity);
 		line.str("");
 		line.precision(15);
 		line << "Initial Total Modularity: " <<  totalModularity << "\n";
 		outfileMG << line.str();
-		printf("\n\n ::: Initial Communities :::");
-		printCommunities(g);
+		modularityLog += line.str();
+		if(_verbose)
+		{
+			printf("\n\n ::: Initial Communities :::");
+			printCommunities(g);
+		}
 		//printCommunitiesContributionModularity();
 		int iterations = 1;
 		double _cutoffIterations = 2.0;
 
+		PROFILE_START(orderStart);
+		delete[] nodesOrderExecution;
 		nodesOrderExecution = nodesOrderToProcess(g,optionOrder);
+		PROFILE_STOP(_profiler,PROFILE_STAGE_ORDER,orderStart);
+		if(_activeSet)
+		{
+			_activeNodes.assign(g._numberNodes,1);
+			_nextActiveNodes.assign(g._numberNodes,0);
+		}
 		//for(int i=0;i<g._numberNodes;i++)
 		//{
 		//	printf("%d \t %d \n",i,nodesOrderExecution[i]);
 		//}
 
+		PROFILE_END_STEP(_profiler,phases,"init");
+
 		//ITERATION		
 		while(_cutoffIterations > cutoffIterations)
 		{
-			printf("\n\n ::: Iteration: %d Start :::",iterations);
+			if(_verbose)
+				printf("\n\n ::: Iteration: %d Start :::",iterations);
+			if(_verbose&&_activeSet)
+				printf("\n Active nodes: %d of %d",(int)std::count(_activeNodes.begin(),_activeNodes.end(),1),g._numberNodes);
 			double maxModularityGainIteration = calculateMaxModularityGainIteration(g,nodesOrderExecution);
 			calculateCommunitiesModulatiryContribution();
-			printf("\n\n ::: Iteration: %d End  :::  Maximum Modularity Gain: %.15lf", iterations,maxModularityGainIteration);
+			if(_verbose)
+				printf("\n\n ::: Iteration: %d End  :::  Maximum Modularity Gain: %.15lf", iterations,maxModularityGainIteration);
 			line.str("");
 			line.precision(15);
 			line << "Iteration: " <<  iterations << " - Maximum Modularity Gain: " << maxModularityGainIteration << "\n";
 			outfileMG << line.str();
+			modularityLog += line.str();
 			_cutoffIterations = maxModularityGainIteration;
 			phaseModularity += maxModularityGainIteration;
+			PROFILE_END_STEP(_profiler,phases,std::to_string(iterations));
 			iterations++;
 		}
 		if((phaseModularity-totalModularity) > cutoffPhase)
 		{
 			//printCommunitiesContributionModularity();
+			PROFILE_START(compactionStart);
+			_dendrogram.addLevel(listedCommunityOfNodes(g),_totalPartitioningModularity);
 			fromCommunitiesToNodes(g);
+			PROFILE_STOP(_profiler,PROFILE_STAGE_COMPACTION,compactionStart);
+			if(_checkpointFileName.empty() == false)
+			{
+				phaseCheckpointState state;
+				state.phase = phases+1;
+				state.totalModularity = totalModularity;
+				state.phaseModularity = phaseModularity;
+				state.alpha = _alpha;
+				_random.getState(state.randomState);
+				state.modularityLog = modularityLog;
+				state.dendrogram = _dendrogram;
+				if(PhaseCheckpoint::writePhaseCheckpoint(g,state,_checkpointFileName) != 0)
+					printf("\n ::: Warning: Checkpoint %s could not be written. :::",_checkpointFileName.c_str());
+			}
+			PROFILE_END_STEP(_profiler,phases,"compaction");
 			//printCommunitiesContributionModularity();
 			phases++;
 		}
@@ -1044,12 +1454,41 @@ void biLouvainMethod::biLouvainMethodAlgorithm(Graph &g,double cutoffIterations,
 	line << "\n--- Final Murata+ Modularity: " <<  totalModularity;
 	outfileMG <<line.str();
 	outfileMG.close();
-	printAllCommunityNodeswithSingletons(g,bipartiteOriginalEntities);
-	printCoClusterCommunitiesFile();
+	_dendrogram.addLevel(listedCommunityOfNodes(g),_totalPartitioningModularity);
+	if(_writeResults)
+	{
+		printAllCommunityNodeswithSingletons(g,bipartiteOriginalEntities);
+		printCoClusterCommunitiesFile();
+		if(_binaryResults)
+			printBinaryResultsFile(g,totalModularity,alpha);
+		std::string outputDendrogram = _outputFileName + "_ResultsDendrogram.bin";
+		if(_writeDendrogram&&(_dendrogram.writeDendrogram(outputDendrogram) != 0))
+			printf("\n ::: Warning: Dendrogram %s could not be written. :::",outputDendrogram.c_str());
+	}
+	collectResults(g,totalModularity,phases);
+	PROFILE_END_STEP(_profiler,phases,"output");
+	writeProfile();
 	_communities.clear();
 	delete[] nodesOrderExecution;
 }
 
+//The hot path is only timed by the profiler, its totals feed the stage times of printTimes
+void biLouvainMethod::writeProfile()
+{
+#ifdef BILOUVAIN_PROFILE
+	candidatesTime = _profiler.stageMicroseconds(PROFILE_STAGE_CANDIDATES);
+	modularityGainTime = _profiler.stageMicroseconds(PROFILE_STAGE_GAIN);
+	updateTime = _profiler.stageMicroseconds(PROFILE_STAGE_UPDATE);
+	precalculationCiTime = _profiler.stageMicroseconds(PROFILE_STAGE_PRECALCULATION_CI);
+	precalculationCjTime = _profiler.stageMicroseconds(PROFILE_STAGE_PRECALCULATION_CJ);
+	precalculationDTime = _profiler.stageMicroseconds(PROFILE_STAGE_PRECALCULATION_D);
+	premurataTime = _profiler.stageMicroseconds(PROFILE_STAGE_MURATA);
+	std::string outputProfile = _outputFileName + "_ResultsProfile.csv";
+	if(_writeResults&&!_profiler.writeCSV(outputProfile))
+		printf("\n ::: Warning: Profile %s could not be written. :::",outputProfile.c_str());
+#endif
+}
+
 
 
 void biLouvainMethod::biLouvainMethodAlgorithmIntraType(Graph &g,double cutoffIterations, double cutoffPhase, int optionOrder,std::tr1::unordered_map<int,std::string> &bipartiteOriginalEntities,const std::string &inputFileName,const std::string &outputFileName)
@@ -1069,7 +1508,8 @@ void biLouvainMethod::biLouvainMethodAlgorithmIntraType(Graph &g,double cutoffIt
         }
         std::string outputModularityGain = _outputFileName + "_ResultsModularity.txt";
         std::ofstream outfileMG;
-        outfileMG.open(outputModularityGain.c_str(),std::ios::out|std::ios::trunc);
+        if(_writeResults)
+                outfileMG.open(outputModularityGain.c_str(),std::ios::out|std::ios::trunc);
 
         initialCommunityTime = 0.0;
         initialCommunityNeighborsTime = 0.0;
@@ -1080,72 +1520,133 @@ void biLouvainMethod::biLouvainMethodAlgorithmIntraType(Graph &g,double cutoffIt
         precalculationCiTime = 0.0;
         precalculationCjTime = 0.0;
         precalculationDTime = 0.0;
+        premurataTime = 0.0;
+#ifdef BILOUVAIN_PROFILE
+        _profiler.reset(_numberThreads);
+#endif
         struct timeval t7,t8,t9,t10,t11,t12;
         std::stringstream line;
         double totalModularity = 0.0;
         double phaseModularity = 1;
         int phases = 1;
         int* nodesOrderExecution = NULL;
+        //Lines of the modularity file, kept for the checkpoints
+        std::string modularityLog;
+        if(_resume)
+        {
+                phases = _resumeState.phase;
+                totalModularity = _resumeState.totalModularity;
+                phaseModularity = _resumeState.phaseModularity;
+                modularityLog = _resumeState.modularityLog;
+                outfileMG << modularityLog;
+                _random.setState(_resumeState.randomState);
+                _dendrogram = _resumeState.dendrogram;
+                _resume = false;
+                if(_verbose)
+                        printf("\n\n ::: Resuming from the checkpoint of phase %d :::",phases-1);
+        }
+        else
+        {
+                _dendrogram.clear();
+                _dendrogram.setLeaves(nodeOfInputNodes(g));
+        }
 
         //PHASE
         while((phaseModularity-totalModularity) > cutoffPhase)
         {
                 //INITIALIZATION STEPS
                 gettimeofday(&t7,NULL);
+                PROFILE_START(stageStart);
                 initialCommunityDefinitionWithIntraType(g);
                 gettimeofday(&t8,NULL);
                 initialCommunityTime += (t8.tv_sec - t7.tv_sec)*1000000 + (t8.tv_usec - t7.tv_usec);
+                PROFILE_STOP(_profiler,PROFILE_STAGE_INITIAL_COMMUNITIES,stageStart);
                 gettimeofday(&t9,NULL);
+                PROFILE_START(neighborsStart);
                 initialCommunityNeighborsDefinition(g);
                 initialIntraTypeCommunityNeighborsDefinition(g);
                 gettimeofday(&t10,NULL);
                 initialCommunityNeighborsTime += (t10.tv_sec - t9.tv_sec)*1000000 + (t10.tv_usec - t9.tv_usec);
+                PROFILE_STOP(_profiler,PROFILE_STAGE_NEIGHBOR_COMMUNITIES,neighborsStart);
                 gettimeofday(&t11,NULL);
+                PROFILE_START(coClusterStart);
                 totalModularity = IntraTypeDefinitionAllCommunities(g,0,_numberCommunities);
                 phaseModularity = totalModularity;
                 gettimeofday(&t12,NULL);
                 initialCoClusterMateTime += (t12.tv_sec - t11.tv_sec)*1000000 + (t12.tv_usec - t11.tv_usec);
+                PROFILE_STOP(_profiler,PROFILE_STAGE_COCLUSTER_MATES,coClusterStart);
 
-                printf("\n\n ::: Phase %d :::", phases);
+                if(_verbose)
+                        printf("\n\n ::: Phase %d :::", phases);
                 line.str("");
                 line << "--- Phase: " <<  phases << "\n";
                 outfileMG << line.str();
-                printf("\n Initial Total partitioning modularity: %.15lf", totalModularity);
+                modularityLog += line.str();
+                if(_verbose)
+                        printf("\n Initial Total partitioning modularity: %.15lf", totalModularity);
                 line.str("");
                 line.precision(15);
                 line << "Initial Total Modularity: " <<  totalModularity << "\n";
                 outfileMG << line.str();
-                printf("\n\n ::: Initial Communities :::");
+                modularityLog += line.str();
+                if(_verbose)
+                        printf("\n\n ::: Initial Communities :::");
                 //printCommunities(g);
                 //printCommunitiesContributionModularity();
                 int iterations = 1;
                 double _cutoffIterations = 2.0;
 
+                PROFILE_START(orderStart);
+                delete[] nodesOrderExecution;
                 nodesOrderExecution = nodesOrderToProcess(g,optionOrder);
+                PROFILE_STOP(_profiler,PROFILE_STAGE_ORDER,orderStart);
                 //for(int i=0;i<g._numberNodes;i++)
                 //{
                 //      printf("%d \t %d \n",i,nodesOrderExecution[i]);
                 //}
 
+                PROFILE_END_STEP(_profiler,phases,"init");
+
                 //ITERATION             
                 while(_cutoffIterations > cutoffIterations)
                 {
-                        printf("\n\n ::: Iteration: %d Start :::",iterations);
+                        if(_verbose)
+                                printf("\n\n ::: Iteration: %d Start :::",iterations);
                         double maxModularityGainIteration = calculateMaxModularityGainIterationIntraType(g,nodesOrderExecution);
                         calculateCommunitiesModulatiryContribution();
-                        printf("\n\n ::: Iteration: %d End  :::  Maximum Modularity Gain: %.15lf", iterations,maxModularityGainIteration);
+                        if(_verbose)
+                                printf("\n\n ::: Iteration: %d End  :::  Maximum Modularity Gain: %.15lf", iterations,maxModularityGainIteration);
                         line.str("");
                         line.precision(15);
                         line << "Iteration: " <<  iterations << " - Maximum Modularity Gain: " << maxModularityGainIteration << "\n";
                         outfileMG << line.str();
+                        modularityLog += line.str();
                         _cutoffIterations = maxModularityGainIteration;
                         phaseModularity += maxModularityGainIteration;
+                        PROFILE_END_STEP(_profiler,phases,std::to_string(iterations));
                         iterations++;
                 }
                 if((phaseModularity-totalModularity) > cutoffPhase)
                 {
                         //printCommunitiesContributionModularity();
+                        PROFILE_START(compactionStart);
+                        _dendrogram.addLevel(listedCommunityOfNodes(g),_totalPartitioningModularity);
                         fromCommunitiesToNodes(g);
+                        PROFILE_STOP(_profiler,PROFILE_STAGE_COMPACTION,compactionStart);
+                        if(_checkpointFileName.empty() == false)
+                        {
+                                phaseCheckpointState state;
+                                state.phase = phases+1;
+                                state.totalModularity = totalModularity;
+                                state.phaseModularity = phaseModularity;
+                                state.alpha = _alpha;
+                                _random.getState(state.randomState);
+                                state.modularityLog = modularityLog;
+                                state.dendrogram = _dendrogram;
+                                if(PhaseCheckpoint::writePhaseCheckpoint(g,state,_checkpointFileName) != 0)
+                                        printf("\n ::: Warning: Checkpoint %s could not be written. :::",_checkpointFileName.c_str());
+                        }
+                        PROFILE_END_STEP(_profiler,phases,"compaction");
 		        phases++;
                 }
         }
@@ -1154,7 +1655,19 @@ void biLouvainMethod::biLouvainMethodAlgorithmIntraType(Graph &g,double cutoffIt
         line << "\n--- Final Murata+ Modularity: " <<  totalModularity;
         outfileMG <<line.str();
         outfileMG.close();
-        printAllCommunityNodeswithSingletons(g,bipartiteOriginalEntities);
+        _dendrogram.addLevel(listedCommunityOfNodes(g),_totalPartitioningModularity);
+        if(_writeResults)
+        {
+                printAllCommunityNodeswithSingletons(g,bipartiteOriginalEntities);
+                if(_binaryResults)
+                        printBinaryResultsFile(g,totalModularity,_alpha);
+                std::string outputDendrogram = _outputFileName + "_ResultsDendrogram.bin";
+                if(_writeDendrogram&&(_dendrogram.writeDendrogram(outputDendrogram) != 0))
+                        printf("\n ::: Warning: Dendrogram %s could not be written. :::",outputDendrogram.c_str());
+        }
+        collectResults(g,totalModularity,phases);
+        PROFILE_END_STEP(_profiler,phases,"output");
+        writeProfile();
         _communities.clear();
         delete[] nodesOrderExecution;
 }
@@ -1166,8 +1679,9 @@ int biLouvainMethod::numberNodesInsideCommunity(Graph &g,int communityId)
 	int result = 0;
 	if(_communities[communityId].getNumberNodes()>0)
 	{
-		for(int i=0; i<_communities[communityId].getNumberNodes();i++)
-			result += g._graph[_communities[communityId].getNodes()[i]].getNumberNodes();
+		MemberIdRange members = _communities[communityId].getNodesRange();
+		for(auto it=members.begin();it!=members.end();++it)
+			result += g._graph[*it].getNumberNodes();
 	}
 	return result;
 }
@@ -1193,32 +1707,114 @@ void biLouvainMethod::printCommunities(Graph &g)
 	for(int i=0;i<_numberCommunities;i++)
 	{
 		printf("\nCommunity ID: %d #Nodes: %d  Correspondent Community ID:", _communities[i].getId(),numberNodesInsideCommunity(g,_communities[i].getId()));
-		for(unsigned int j=0;j<_communities[i].getCoClusterMateCommunityId().size();j++)
-			printf("  %d",_communities[i].getCoClusterMateCommunityId()[j]);
+		IdRange mates = _communities[i].getCoClusterMateCommunityIdRange();
+		for(auto it=mates.begin();it!=mates.end();++it)
+			printf("  %d",*it);
 	}
 }
 
 
 void biLouvainMethod::printCoClusterCommunitiesFile()
 {
-	int countCoClusters = 0;
-	std::stringstream line;
 	std::string outputCoclusters = _outputFileName + "_ResultsCoClusterCommunities.txt";
 	std::ofstream outfileCCC;
-	outfileCCC.open(outputCoclusters.c_str(),std::ios::out|std::ios::trunc);
+	outfileCCC.open(outputCoclusters.c_str(),std::ios::out|std::ios::trunc|std::ios::binary);
+	std::string output, line;
 	for(int i=0;i<_numberCommunities;i++)
 	{
-		countCoClusters++;
-		line.str("");
-		//line <<"\nCommunity ID: " << _communities[i].getId() << "\t#Nodes: " << numberNodesInsideCommunity(_communities[i].getId()) << "\tCorrespondent Community ID: ";
-		line << "\nCoCluster " << countCoClusters << ":"<< _communities[i].getDescription() << "(" << _communities[i].getId() << ")-";
-		for(unsigned int j=0;j<_communities[i].getCoClusterMateCommunityId().size();j++)
-			line << _communities[i].getCoClusterMateCommunityId()[j] << "  ";
-		outfileCCC << line.str().substr(0,line.str().length()-2);
+		line = "\nCoCluster ";
+		StringSplitter::appendInt(line,i+1);
+		line.push_back(':');
+		line.append(_communities[i].getDescription());
+		line.push_back('(');
+		StringSplitter::appendInt(line,_communities[i].getId());
+		line.append(")-");
+		IdRange mates = _communities[i].getCoClusterMateCommunityIdRange();
+		for(auto it=mates.begin();it!=mates.end();++it)
+		{
+			StringSplitter::appendInt(line,*it);
+			line.append("  ");
+		}
+		//The last two characters of the line are dropped: the separator after the last mate, or ")-" without mates
+		output.append(line,0,line.size()-2);
+		if(output.size() >= (1 << 20))
+		{
+			outfileCCC.write(output.data(),output.size());
+			output.clear();
+		}
 	}
+	outfileCCC.write(output.data(),output.size());
 	outfileCCC.close();
 }
 
+//The communities are numbered as in _ResultsCommunities.txt, only the ones with members are kept
+void biLouvainMethod::printBinaryResultsFile(Graph &g,double modularity,double alpha)
+{
+	std::vector<int> listedPosition(_numberCommunities,-1);
+	std::tr1::unordered_map<int,int> listedId;
+	std::vector<signed char> partition;
+	std::vector<int> communityId;
+	std::vector<double> contribution;
+	for(int i=0;i<_numberCommunities;i++)
+	{
+		if(_communities[i].getNodesRange().empty())
+			continue;
+		listedPosition[i] = partition.size();
+		listedId[_communities[i].getId()] = partition.size();
+		partition.push_back(_communities[i].getDescription() == "V1" ? 0 : 1);
+		communityId.push_back(_communities[i].getId());
+		contribution.push_back(_communities[i].getModularityContribution());
+	}
+	std::vector<int> mateOffsets(1,0);
+	std::vector<int> mates;
+	for(int i=0;i<_numberCommunities;i++)
+	{
+		if(listedPosition[i] < 0)
+			continue;
+		IdRange range = _communities[i].getCoClusterMateCommunityIdRange();
+		for(auto it=range.begin();it!=range.end();++it)
+		{
+			std::tr1::unordered_map<int,int>::const_iterator mate = listedId.find(*it);
+			if(mate != listedId.end())
+				mates.push_back(mate->second);
+		}
+		mateOffsets.push_back(mates.size());
+	}
+	std::vector<int> membership = communityOfInputNodes(g);
+	for(unsigned int id=0;id<membership.size();id++)
+		if(membership[id] >= 0)
+			membership[id] = listedPosition[membership[id]];
+	std::string outputBinary = _outputFileName + "_Results.bin";
+	if(BinaryResults::writeBinaryResults(outputBinary,modularity,alpha,membership,partition,communityId,mateOffsets,mates,contribution) != 0)
+		printf("\n ::: Warning: Binary results %s could not be written. :::",outputBinary.c_str());
+}
+
+//Keeps the communities of the last phase in memory: the community id of every input node (the ids of
+//_ResultsCoClusterCommunities.txt) and the (community,co-cluster mate) pairs
+void biLouvainMethod::collectResults(Graph &g,double finalModularity,int phases)
+{
+	int numberInputNodes = 0;
+	for(int i=0;i<g._numberNodes;i++)
+		numberInputNodes += g._graph[i].getNumberNodes();
+	_membership.assign(numberInputNodes,-1);
+	_coClusters.clear();
+	for(int i=0;i<_numberCommunities;i++)
+	{
+		MemberIdRange members = _communities[i].getNodesRange();
+		for(auto it=members.begin();it!=members.end();++it)
+		{
+			const std::vector<Node> &nodes = g._graph[*it].getNodesReference();
+			for(unsigned int k=0;k<nodes.size();k++)
+				_membership[nodes[k].getIdInput()] = _communities[i].getId();
+		}
+		IdRange mates = _communities[i].getCoClusterMateCommunityIdRange();
+		for(auto it=mates.begin();it!=mates.end();++it)
+			_coClusters.push_back(std::make_pair(_communities[i].getId(),*it));
+	}
+	_finalModularity = finalModularity;
+	_numberPhases = phases;
+}
+
 void biLouvainMethod::printAllCommunityNodes(Graph &g)
 {
 	std::string outputCommunities = _outputFileName + "_ResultsCommunities.txt";
@@ -1230,15 +1826,16 @@ void biLouvainMethod::printAllCommunityNodes(Graph &g)
 	std::stringstream line;
 	for(int i=0;i<_numberCommunities;i++)
 	{
-		if (!_communities[i].getNodes().empty())
+		if (!_communities[i].getNodesRange().empty())
 		{
 			if(_communities[i].getNumberNodes()==1)
 			{
-				if(g._graph[_communities[i].getNodes()[0]].getNumberNodes()==1)
+				MetaNode &member = g._graph[*_communities[i].getNodesRange().begin()];
+				if(member.getNumberNodes()==1)
 				{
 					if(_communities[i].getDescription() == "V1") singletonsV1++;
 					else singletonsV2++;
-					std::cout << "Singleton: " << g._graph[_communities[i].getNodes()[0]].getNodes()[0].getIdInput() << std::endl;
+					std::cout << "Singleton: " << member.getNodesReference()[0].getIdInput() << std::endl;
 				}
 				else
 				{
@@ -1246,8 +1843,9 @@ void biLouvainMethod::printAllCommunityNodes(Graph &g)
 					line << "Community " << cont++ << "[" << _communities[i].getDescription() << "]: ";
 					outfileC << line.str();
 					line.str("");
-					for(int k=0;k<g._graph[_communities[i].getNodes()[0]].getNumberNodes();k++)
-						line << g._graph[_communities[i].getNodes()[0]].getNodesSorted()[k].getIdInput() << ",";
+					std::vector<Node> sorted = member.getNodesSorted();
+					for(unsigned int k=0;k<sorted.size();k++)
+						line << sorted[k].getIdInput() << ",";
 					outfileC << line.str().substr(0,line.str().length()-1) << "\n";
 				}
 			}
@@ -1257,10 +1855,12 @@ void biLouvainMethod::printAllCommunityNodes(Graph &g)
 				line << "Community " << cont++ << "[" << _communities[i].getDescription() << "]: ";
 				outfileC << line.str();
 				line.str("");
-				for(int j=0;j<_communities[i].getNumberNodes();j++)
+				MemberIdRange members = _communities[i].getNodesRange();
+				for(auto it=members.begin();it!=members.end();++it)
 				{
-					for(int k=0;k< g._graph[_communities[i].getNodes()[j]].getNumberNodes();k++)
-						line << g._graph[_communities[i].getNodes()[j]].getNodesSorted()[k].getIdInput() << ",";
+					std::vector<Node> sorted = g._graph[*it].getNodesSorted();
+					for(unsigned int k=0;k<sorted.size();k++)
+						line << sorted[k].getIdInput() << ",";
 				}
 				outfileC << line.str().substr(0,line.str().length()-1) << "\n";
 			}
@@ -1275,105 +1875,200 @@ void biLouvainMethod::printAllCommunityNodes(Graph &g)
 	outfileC.close();
 }
 
-std::string biLouvainMethod::listNodesCommunities(Graph &g)
+//Position in _communities of the community of every input node, -1 for ids that are not in the graph
+std::vector<int> biLouvainMethod::communityOfInputNodes(Graph &g)
 {
-	std::stringstream line;
-	std::tr1::unordered_map<int,int> nodes;
-	line.str("");
+	int maximumId = -1;
+	for(int i=0;i<g._numberNodes;i++)
+	{
+		const std::vector<Node> &nodes = g._graph[i].getNodesReference();
+		for(unsigned int k=0;k<nodes.size();k++)
+			maximumId = std::max(maximumId,nodes[k].getIdInput());
+	}
+	std::vector<int> community(maximumId+1,-1);
+	#pragma omp parallel for schedule(dynamic,64) num_threads(_numberThreads) if(_numberThreads > 1)
 	for(int i=0;i<_numberCommunities;i++)
 	{
-		for(int j=0;j<_communities[i].getNumberNodes();j++)
+		MemberIdRange members = _communities[i].getNodesRange();
+		for(auto it=members.begin();it!=members.end();++it)
 		{
-			for(int k=0;k< g._graph[_communities[i].getNodes()[j]].getNumberNodes();k++)
-				nodes[g._graph[_communities[i].getNodes()[j]].getNodesSorted()[k].getIdInput()]=i;
+			const std::vector<Node> &memberNodes = g._graph[*it].getNodesReference();
+			for(unsigned int k=0;k<memberNodes.size();k++)
+				community[memberNodes[k].getIdInput()] = i;
 		}
 	}
-	std::map<int,int> ordered(nodes.begin(),nodes.end());
-	for(auto it=ordered.begin();it!=ordered.end();++it)
-		line << it->second << ",";
-	return line.str().substr(0,line.str().length()-1);
+	return community;
 }
 
-void biLouvainMethod::printAllCommunityNodeswithSingletons(Graph &g,std::tr1::unordered_map<int,std::string> &bipartiteOriginalEntities)
+//Node of the graph (level 0 of the dendrogram) of every input node, -1 for ids that are not in the graph
+std::vector<int> biLouvainMethod::nodeOfInputNodes(Graph &g)
 {
-	std::string outputCommunities = _outputFileName + "_ResultsCommunities.txt";
-	std::ofstream outfileC;
-	outfileC.open(outputCommunities.c_str(),std::ios::out|std::ios::trunc);
-	int singletonsV1 = 0 ;
-	int singletonsV2 = 0 ;
-	int cont = 0;
-	std::stringstream line;
+	int maximumId = -1;
+	for(int i=0;i<g._numberNodes;i++)
+	{
+		const std::vector<Node> &nodes = g._graph[i].getNodesReference();
+		for(unsigned int k=0;k<nodes.size();k++)
+			maximumId = std::max(maximumId,nodes[k].getIdInput());
+	}
+	std::vector<int> node(maximumId+1,-1);
+	for(int i=0;i<g._numberNodes;i++)
+	{
+		const std::vector<Node> &nodes = g._graph[i].getNodesReference();
+		for(unsigned int k=0;k<nodes.size();k++)
+			node[nodes[k].getIdInput()] = i;
+	}
+	return node;
+}
+
+//Community of every node among the communities with members, in community order: the metanode it becomes in
+//fromCommunitiesToNodes, or its number in _ResultsCommunities.txt after the last phase
+std::vector<int> biLouvainMethod::listedCommunityOfNodes(Graph &g)
+{
+	std::vector<int> community(g._numberNodes,-1);
+	int listed = 0;
 	for(int i=0;i<_numberCommunities;i++)
 	{
-		if (!_communities[i].getNodes().empty())
+		if(_communities[i].getNumberNodes() == 0)
+			continue;
+		MemberIdRange members = _communities[i].getNodesRange();
+		for(auto it=members.begin();it!=members.end();++it)
+			community[*it] = listed;
+		listed++;
+	}
+	return community;
+}
+
+std::string biLouvainMethod::listNodesCommunities(Graph &g)
+{
+	std::vector<int> community = communityOfInputNodes(g);
+	std::string line;
+	for(unsigned int id=0;id<community.size();id++)
+	{
+		if(community[id] < 0)
+			continue;
+		StringSplitter::appendInt(line,community[id]);
+		line.push_back(',');
+	}
+	if(line.empty() == false)
+		line.resize(line.size()-1);
+	return line;
+}
+
+//Appends the lines of the communities listed[first,last) of _ResultsCommunities.txt, numbered from first: the input nodes
+//of every member metanode, sorted by id, or their entity names. Singletons are counted per partition.
+void biLouvainMethod::formatCommunities(Graph &g,const std::vector<int> &listed,int first,int last,const std::tr1::unordered_map<int,std::string> &bipartiteOriginalEntities,std::string &output,int &singletonsV1,int &singletonsV2)
+{
+	std::vector<int> ids;
+	for(int c=first;c<last;c++)
+	{
+		Community &community = _communities[listed[c]];
+		std::string description = community.getDescription();
+		MemberIdRange members = community.getNodesRange();
+		if((community.getNumberNodes() == 1)&&(g._graph[*members.begin()].getNumberNodes() == 1))
 		{
-			if(_communities[i].getNumberNodes()==1)
+			if(description == "V1") singletonsV1++;
+			else singletonsV2++;
+		}
+		output.append("Community ");
+		StringSplitter::appendInt(output,c);
+		output.push_back('[');
+		output.append(description);
+		output.append("]: ");
+		bool firstNode = true;
+		for(auto it=members.begin();it!=members.end();++it)
+		{
+			const std::vector<Node> &nodes = g._graph[*it].getNodesReference();
+			ids.clear();
+			for(unsigned int k=0;k<nodes.size();k++)
+				ids.push_back(nodes[k].getIdInput());
+			std::sort(ids.begin(),ids.end());
+			for(unsigned int k=0;k<ids.size();k++)
 			{
-				if(g._graph[_communities[i].getNodes()[0]].getNumberNodes()==1)
+				if(firstNode == false)
+					output.push_back(',');
+				firstNode = false;
+				if(bipartiteOriginalEntities.size() > 0)
 				{
-					if(_communities[i].getDescription() == "V1") singletonsV1++;
-					else singletonsV2++;
-					line.str("");
-					if(bipartiteOriginalEntities.size()>0)                                     
-						line << "Community " << cont++ << "[" << _communities[i].getDescription() << "]: " << bipartiteOriginalEntities[g._graph[_communities[i].getNodes()[0]].getNodes()[0].getIdInput()] << "\n";
-					else
-						line << "Community " << cont++ << "[" << _communities[i].getDescription() << "]: " << g._graph[_communities[i].getNodes()[0]].getNodes()[0].getIdInput() << "\n";
-						
-					outfileC << line.str();
+					std::tr1::unordered_map<int,std::string>::const_iterator entity = bipartiteOriginalEntities.find(ids[k]);
+					if(entity != bipartiteOriginalEntities.end())
+						output.append(entity->second);
 				}
 				else
-				{
-					line.str("");
-					line << "Community " << cont++ << "[" << _communities[i].getDescription() << "]: ";
-					outfileC << line.str();
-					line.str("");
-					if(bipartiteOriginalEntities.size()>0)
-					{
-						for(int k=0;k<g._graph[_communities[i].getNodes()[0]].getNumberNodes();k++)
-							line << bipartiteOriginalEntities[g._graph[_communities[i].getNodes()[0]].getNodesSorted()[k].getIdInput()] << ",";
-					}
-					else
-					{
-						for(int k=0;k<g._graph[_communities[i].getNodes()[0]].getNumberNodes();k++)
-                                                        line << g._graph[_communities[i].getNodes()[0]].getNodesSorted()[k].getIdInput() << ",";
-					}
-					outfileC << line.str().substr(0,line.str().length()-1) << "\n";
-				}
+					StringSplitter::appendInt(output,ids[k]);
 			}
-			else
-			{
-				line.str("");
-				line << "Community " << cont++ << "[" << _communities[i].getDescription() << "]: ";
-				outfileC << line.str();
-				line.str("");
-				if(bipartiteOriginalEntities.size()>0)
-				{
-					for(int j=0;j<_communities[i].getNumberNodes();j++)
-					{
-						for(int k=0;k<g._graph[_communities[i].getNodes()[j]].getNumberNodes();k++)
-							line << bipartiteOriginalEntities[g._graph[_communities[i].getNodes()[j]].getNodesSorted()[k].getIdInput()] << ",";
-					}
-				}
-				else
-				{
-					for(int j=0;j<_communities[i].getNumberNodes();j++)
-                                        {
-                                                for(int k=0;k<g._graph[_communities[i].getNodes()[j]].getNumberNodes();k++)
-                                                        line << g._graph[_communities[i].getNodes()[j]].getNodesSorted()[k].getIdInput() << ",";
-                                        }
+		}
+		output.push_back('\n');
+	}
+}
 
-				}
-				outfileC << line.str().substr(0,line.str().length()-1) << "\n";
+//The communities are formatted by blocks in parallel, a round of blocks at a time, and every round is written in order
+//with one write per block
+void biLouvainMethod::printAllCommunityNodeswithSingletons(Graph &g,std::tr1::unordered_map<int,std::string> &bipartiteOriginalEntities)
+{
+	static const int COMMUNITIES_PER_BLOCK = 1024;
+	static const int NODES_PER_BLOCK = 1 << 16;
+	std::string outputCommunities = _outputFileName + "_ResultsCommunities.txt";
+	std::ofstream outfileC;
+	outfileC.open(outputCommunities.c_str(),std::ios::out|std::ios::trunc|std::ios::binary);
+	int numberThreads = std::max(_numberThreads,1);
+	std::vector<int> listed;
+	for(int i=0;i<_numberCommunities;i++)
+		if(!_communities[i].getNodesRange().empty())
+			listed.push_back(i);
+	std::vector<std::string> buffers(numberThreads*4);
+	int singletonsV1 = 0;
+	int singletonsV2 = 0;
+	int numberBlocks = (listed.size() + COMMUNITIES_PER_BLOCK - 1)/COMMUNITIES_PER_BLOCK;
+	for(int round=0;round<numberBlocks;round+=buffers.size())
+	{
+		int blocks = std::min((int)buffers.size(),numberBlocks-round);
+		#pragma omp parallel for schedule(dynamic,1) num_threads(numberThreads) reduction(+:singletonsV1,singletonsV2) if(numberThreads > 1)
+		for(int b=0;b<blocks;b++)
+		{
+			int first = (round+b)*COMMUNITIES_PER_BLOCK;
+			buffers[b].clear();
+			formatCommunities(g,listed,first,std::min(first+COMMUNITIES_PER_BLOCK,(int)listed.size()),bipartiteOriginalEntities,buffers[b],singletonsV1,singletonsV2);
+		}
+		for(int b=0;b<blocks;b++)
+			outfileC.write(buffers[b].data(),buffers[b].size());
+	}
+	std::string line = "\nSingletons Partition V1: ";
+	StringSplitter::appendInt(line,singletonsV1);
+	line.append("\nSingletons Partition V2: ");
+	StringSplitter::appendInt(line,singletonsV2);
+	line.push_back('\n');
+	outfileC.write(line.data(),line.size());
+
+	//Community of every input node in id order, "," separated; the comma before the first one is not written
+	std::vector<int> community = communityOfInputNodes(g);
+	numberBlocks = (community.size() + NODES_PER_BLOCK - 1)/NODES_PER_BLOCK;
+	bool firstWritten = false;
+	for(int round=0;round<numberBlocks;round+=buffers.size())
+	{
+		int blocks = std::min((int)buffers.size(),numberBlocks-round);
+		#pragma omp parallel for schedule(dynamic,1) num_threads(numberThreads) if(numberThreads > 1)
+		for(int b=0;b<blocks;b++)
+		{
+			int first = (round+b)*NODES_PER_BLOCK;
+			int last = std::min(first+NODES_PER_BLOCK,(int)community.size());
+			buffers[b].clear();
+			for(int id=first;id<last;id++)
+			{
+				if(community[id] < 0)
+					continue;
+				buffers[b].push_back(',');
+				StringSplitter::appendInt(buffers[b],community[id]);
 			}
 		}
+		for(int b=0;b<blocks;b++)
+		{
+			if(buffers[b].empty())
+				continue;
+			int skip = firstWritten ? 0 : 1;
+			outfileC.write(buffers[b].data()+skip,buffers[b].size()-skip);
+			firstWritten = true;
+		}
 	}
-	line.str("");
-	line << "\nSingletons Partition V1: " << singletonsV1;
-	outfileC << line.str();
-	line.str("");
-	line << "\nSingletons Partition V2: " << singletonsV2 << "\n";
-	outfileC << line.str();
-	outfileC << listNodesCommunities(g);
 	outfileC.close();
 }
 
@@ -1386,11 +2081,12 @@ void biLouvainMethod::printCommunityNodes(int communityId)
 		if(_communities[i].getId()==communityId)
 		{
 			band = true;
-			if (!_communities[i].getNodes().empty())
+			if (!_communities[i].getNodesRange().empty())
 			{
 				printf("\nCommunity ID: %d \n", _communities[i].getId());
-				for (int j = 0; j < _communities[i].getNumberNodes(); j++)
-					printf("\nNode: %d",_communities[i].getNodes()[j]);
+				MemberIdRange members = _communities[i].getNodesRange();
+				for(auto it=members.begin();it!=members.end();++it)
+					printf("\nNode: %d",*it);
 			}
 			break;
 		}
@@ -1407,17 +2103,19 @@ void biLouvainMethod::printCommunityNodesNeighbors(Graph &g,int communityId)
 		if(_communities[i].getId()==communityId)
 		{
 			band = true;
-			if (~_communities[i].getNodes().empty())
+			if (~_communities[i].getNodesRange().empty())
 			{
-				for (int j = 0; j < _communities[i].getNumberNodes(); j++)
+				MemberIdRange members = _communities[i].getNodesRange();
+				for(auto it=members.begin();it!=members.end();++it)
 				{
-					printf("\nCommunity ID: %d Node: %d \n", _communities[i].getId(),_communities[i].getNodes()[j]);
-					if(g._graph[_communities[i].getNodes()[j]].getNeighbors().empty())
+					printf("\nCommunity ID: %d Node: %d \n", _communities[i].getId(),*it);
+					IdRange neighbors = g._graph[*it].getNeighborsRange();
+					if(neighbors.empty())
 						printf("Node %d doesn't have neighbors \n", communityId);
 					else
 					{
-						for (int k = 0; k <g. _graph[_communities[i].getNodes()[j]].getNumberNeighbors(); k++)
-							printf("Neighbor: %d \n", g._graph[_communities[i].getNodes()[j]].getNeighbors()[k]);
+						for(auto k=neighbors.begin();k!=neighbors.end();++k)
+							printf("Neighbor: %d \n", *k);
 					}
 				}
 			}
@@ -1441,6 +2139,8 @@ void biLouvainMethod::printTimes(double biLouvainTime, double loadGraphTime, dou
 	outfileTime << "\nInitial Community Time: " + timeConverter(initialCommunityTime);
 	outfileTime << "\nInitial Community Neighbors Time: " + timeConverter(initialCommunityNeighborsTime);
 	outfileTime << "\nInitial CoCluster Time: " + timeConverter(initialCoClusterMateTime);
+#ifdef BILOUVAIN_PROFILE
+	//The hot path stages are only timed by the profiler, they are left out when it is compiled out
 	outfileTime << "\n\n::: biLouvain Times :::";
 	outfileTime << "\nbiLouvain Targets Time: " + timeConverter(candidatesTime);
 	outfileTime << "\nbiLouvain Modularity Gain Time: " + timeConverter(modularityGainTime);
@@ -1450,6 +2150,7 @@ void biLouvainMethod::printTimes(double biLouvainTime, double loadGraphTime, dou
 	outfileTime << "\nbiLouvain Gain Time PC Cj: " + timeConverter(precalculationCjTime);
 	outfileTime << "\nbiLouvain Gain Time PC D: " + timeConverter(precalculationDTime);
 	outfileTime << "\nPre Murata Time: " + timeConverter(premurataTime);
+#endif
 	outfileTime.close();
 	/*printf("\n\n ::: Total Time: %s ::: %f microseconds\n",timeConverter(biLouvainTime+loadGraphTime).c_str(),biLouvainTime+loadGraphTime);
 	printf("\n\n ::: Load Graph Total Time: %s ::: %f microseconds\n",timeConverter(loadGraphTime).c_str(),loadGraphTime);
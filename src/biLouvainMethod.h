@@ -45,12 +45,73 @@
 #include "MetaNode.h"
 #include "Node.h"
 #include "Community.h"
+#include "CommunityChanges.h"
 #include "Timer.h"
+#include "RandomGenerator.h"
+#include "Profiler.h"
+#include "PhaseCheckpoint.h"
+#include "BinaryResults.h"
+#include "Dendrogram.h"
+
+//Sparse accumulator used to add up the edges of the members of a community when the graph is compacted. Entries are
+//valid only when their mark equals the current epoch, so the arrays are not cleared between rows.
+struct rowAccumulator
+{
+	std::vector<long double> sums;
+	std::vector<long double> errors;
+	std::vector<int> marks;
+	std::vector<int> touched;
+	int epoch;
+};
+
+//Orders node ids by decreasing degree, used by the degree descending processing order
+struct degreeDescending
+{
+	const std::vector<double> &degrees;
+	degreeDescending(const std::vector<double> &nodeDegrees) : degrees(nodeDegrees) {}
+	bool operator()(int i, int j) const {return (degrees[i] > degrees[j]);}
+};
 
 class biLouvainMethod
 {
 	protected:
 		double _alpha;	
+		//Parallel move evaluation (see calculateMaxModularityGainIteration)
+		int _numberThreads;
+		int _batchSize;
+		std::vector<int> _conflictEpoch;
+		int _epoch;
+		//Start of every color class in the processing order when optionOrder is 4, empty otherwise
+		std::vector<int> _colorClassOffsets;
+		//Kahan summation of the edge weights added up by fromCommunitiesToNodes
+		bool _compensatedSummation;
+		//Source of the random orders (3 and 6), seeded once so the whole run can be reproduced from the seed
+		RandomGenerator _random;
+		//Counters and stage times of the hot path, written to _ResultsProfile.csv when built with BILOUVAIN_PROFILE
+		Profiler _profiler;
+		//Active set mode: after the first sweep of a phase only the nodes whose neighborhood changed are scored again
+		//(see activateMoveNeighborhood). _nextActiveNodes collects the nodes of the following sweep
+		bool _activeSet;
+		double _activeTolerance;
+		std::vector<char> _activeNodes;
+		std::vector<char> _nextActiveNodes;
+		//Checkpoint written after every compaction (empty: none), and the state of the checkpoint a run resumes from
+		std::string _checkpointFileName;
+		bool _resume;
+		phaseCheckpointState _resumeState;
+		//Console messages and result files can be turned off when the algorithm is embedded (see biLouvainAPI.h)
+		bool _verbose;
+		bool _writeResults;
+		//Binary copy of the results (_Results.bin, see BinaryResults.h) written next to the text files
+		bool _binaryResults;
+		//Community hierarchy of the run, kept in every phase checkpoint and written to _ResultsDendrogram.bin on request
+		Dendrogram _dendrogram;
+		bool _writeDendrogram;
+		//Results of the last run kept in memory: community id of every input node, (community,co-cluster mate) pairs
+		std::vector<int> _membership;
+		std::vector<std::pair<int,int> > _coClusters;
+		double _finalModularity;
+		int _numberPhases;
 		double _totalPartitioningModularity;	
 		int _numberCommunities;
 		int _numberCommunitesV1;
@@ -58,19 +119,18 @@ class biLouvainMethod
 		std::vector<Community> _communities;
 		std::string _outputFileName;
 		//std::vector<double> _communitiesBetaFactor;
-		std::vector<Node> nodes;
 
 		/*Auxiliar Functions and Procedures*/
 		int findCommunityContainingNode(int nodeId);
 		int isRepeated(const std::vector<int> &elements, int newElement);
 		int calculateEdgesBetweenCommunities(Graph &g,int communityCId, int communityDId);
 		int findPositionNode(Graph &g,int node_id);
-		double calculateEdgesBetweenCommunitiesMap(Graph &g,int communityCId, int communityDId);
+		double calculateEdgesBetweenCommunitiesMap(int communityCId, int communityDId);
 		std::vector<int> findNeighborCommunities(Graph &g,int communityId);
-		std::vector<int> findNeighborCommunitiesMap(Graph &g,int communityId);
+		std::vector<int> findNeighborCommunitiesMap(int communityId);
 		std::vector<int> findNeighborCommunitiesWithoutNodeMap(Graph &g,int communityId, int nodeId);
 		std::vector<int> getDifferentNeighborCommunities(Graph &g,int communityId1, int communityId2);
-		std::vector<int> getDifferentNeighborCommunitiesMap(Graph &g,int communityId1, int communityId2);
+		std::vector<int> getDifferentNeighborCommunitiesMap(int communityId1, int communityId2);
 		void calculateCommunitiesModulatiryContribution();
 
 		/*Main Functions and Procedures*/
@@ -81,14 +141,12 @@ class biLouvainMethod
 		void initialIntraTypeCommunityNeighborsDefinition(Graph &g);
 		void updateNodeCommunity(Graph &g,int nodeId, int oldCommunityId, int newCommunityId);
 		void updateNodeIntraTypeCommunity(Graph &g,int nodeId, int oldCommunityId, int newCommunityId);
-		void updateCoClusterMateCommunities(const std::string &changes);
+		void updateCoClusterMateCommunities(CommunityChanges &changes);
 		void updateNeighborCommunities(Graph &g,int nodeId, int oldCommunityId,int newCommunityId);
 		void updateIntraTypeNeighborCommunities(Graph &g,int nodeId, int oldCommunityId,int newCommunityId);
-		std::tr1::unordered_map<int,double> compactMetaNodeNeighbors(Graph &g,int &communityId, std::tr1::unordered_map<int,int> &dictionaryCommunities);
-		std::tr1::unordered_map<int,double> compactMetaNodeIntraTypeNeighbors(Graph &g,int &communityId, std::tr1::unordered_map<int,int> &dictionaryCommunities);
+		int compactCommunityRow(Graph &g,int communityId,const std::vector<int> &newIds,bool intraType,rowAccumulator &accumulator,std::vector<int> &rowNeighbors,std::vector<double> &rowWeights);
 		void fromCommunitiesToNodes(Graph &g);
 		int numberCommunitiesNonEmpty();
-		std::tr1::unordered_map<int,int> dictionaryCommunitiesNewId();
 		virtual double murataModularityArgMax(Graph &g,int &communityId, int possibleCoClusterMateId)=0;
 		virtual double* murataModularityWithChanges(Graph &g,MetaNode &node, int &communityId, int possibleCoClusterMateId,int &newCommunityId,int &option)=0;
 		virtual double CoClusterMateDefinitionAllCommunities(Graph &g,int start, int end)=0;
@@ -96,10 +154,20 @@ class biLouvainMethod
 		virtual newDataCommunity CoClusterMateDefinitionPrecalculation(Graph &g,MetaNode &node, int &communityId, int &newCommunityId,int &option)=0;
 		virtual double calculateCommunityBetaFactor(Graph &g,std::string communityType,double similarity)=0;
                 virtual double calculateCommunitySimilarity(Graph &g,int &communityId)=0;
+		virtual double neighborCommunitiesGainBound(Graph &g,MetaNode &node,int candidateCommunityId,const std::vector<int> &neighborCommunities)=0;
+		void scoreNodeMove(Graph &g,int nodeId,moveProposal &proposal,bool collectDependencies);
+		bool applyNodeMove(Graph &g,moveProposal &proposal);
+		void collectMoveDependencies(moveProposal &proposal);
+		bool hasMoveConflicts(moveProposal &proposal);
+		void markMoveConflicts(Graph &g,moveProposal &proposal);
+		void activateNode(int nodeId);
+		void activateMoveNeighborhood(Graph &g,moveProposal &proposal);
+		void nextActiveSweep();
 		double calculateMaxModularityGainIteration(Graph &g,int* &nodesOrderExecution);
 		double calculateMaxModularityGainIterationIntraType(Graph &g,int* &nodesOrderExecution);
 		newDataCommunity calculateDeltaGainModularity(Graph &g,MetaNode &node, int &communityId, int newCommunityId,int option);
 		int* nodesOrderToProcess(Graph &g,int optionOrder);
+		void shuffleNodes(int* nodes,int numberNodes);
 
 	public:
 		double initialCommunityTime;
@@ -115,21 +183,45 @@ class biLouvainMethod
 
 		biLouvainMethod();
 		~biLouvainMethod();
+		void setNumberThreads(int numberThreads);
+		void setBatchSize(int batchSize);
+		void setCompensatedSummation(bool compensatedSummation);
+		void setSeed(unsigned long long seed);
+		void setActiveSet(bool activeSet,double tolerance);
+		Profiler& getProfiler();
+		void setCheckpoint(const std::string &checkpointFileName);
+		void resumeFromCheckpoint(const phaseCheckpointState &state);
+		void setVerbose(bool verbose);
+		void setWriteResults(bool writeResults);
+		void setBinaryResults(bool binaryResults);
+		void setWriteDendrogram(bool writeDendrogram);
+		const std::vector<int>& getMembership();
+		const std::vector<std::pair<int,int> >& getCoClusters();
+		double getFinalModularity();
+		int getNumberPhases();
+		const Dendrogram& getDendrogram();
 		/*biLouvain Method*/
 		void biLouvainMethodAlgorithm(Graph &g,double cutoffIterations, double cutoffPhase, int optionOrder,std::tr1::unordered_map<int,std::string> &bipartiteOriginalEntities,const std::string &inputFileName,const std::string &outputFileName,double &alpha);
 		void biLouvainMethodAlgorithmIntraType(Graph &g,double cutoffIterations, double cutoffPhase, int optionOrder,std::tr1::unordered_map<int,std::string> &bipartiteOriginalEntities,const std::string &inputFileName,const std::string &outputFileName);
 
 		/*Printing and storing results*/
 		int numberNodesInsideCommunity(Graph &g,int communityId);
+		std::vector<int> communityOfInputNodes(Graph &g);
+		std::vector<int> nodeOfInputNodes(Graph &g);
+		std::vector<int> listedCommunityOfNodes(Graph &g);
 		std::string listNodesCommunities(Graph &g);
+		void formatCommunities(Graph &g,const std::vector<int> &listed,int first,int last,const std::tr1::unordered_map<int,std::string> &bipartiteOriginalEntities,std::string &output,int &singletonsV1,int &singletonsV2);
 		void generateOutputFile(std::string text, std::string fileName);
 		void printCommunitiesContributionModularity();
 		void printCommunities(Graph &g);
 		void printCoClusterCommunitiesFile();
+		void printBinaryResultsFile(Graph &g,double modularity,double alpha);
+		void collectResults(Graph &g,double finalModularity,int phases);
 		void printAllCommunityNodes(Graph &g);
 		void printAllCommunityNodeswithSingletons(Graph &g,std::tr1::unordered_map<int,std::string> &bipartiteOriginalEntities);
 		void printCommunityNodes(int communityId);
 		void printCommunityNodesNeighbors(Graph &g,int communityId);
+		void writeProfile();
 		void printTimes(double totalTime, double loadGraphTime,double mergingTime);
 };
 
@@ -43,8 +43,9 @@ biLouvainMethodMurataPN::~biLouvainMethodMurataPN(){}
 int biLouvainMethodMurataPN::calculateNumberNodesBetaFactor(Graph &g,int &communityId, MetaNode &node, int option)
 {
 	int numberNodes = 0;
-	for(int i=0;i<_communities[communityId].getNumberNodes();i++)
-                        numberNodes += g._graph[_communities[communityId].getNodes()[i]].getNumberNodes();
+	MemberIdRange members = _communities[communityId].getNodesRange();
+	for(auto it=members.begin();it!=members.end();++it)
+                        numberNodes += g._graph[*it].getNumberNodes();
 	if(option ==2)
 		numberNodes += node.getNumberNodes();
 	else
@@ -67,9 +68,15 @@ double biLouvainMethodMurataPN::calculateCommunityBetaFactor(Graph &g,std::strin
 
 double biLouvainMethodMurataPN::calculateCommunitySimilarity(Graph &g,int &communityId)
 {
+        if(_communities[communityId].hasInternalSimilarity())
+		return _communities[communityId].getInternalSimilarity();
         double similarity = 0.0;
-        for(int i=0;i<_communities[communityId].getNumberNodes();i++)
-		similarity += g._graph[_communities[communityId].getNodes()[i]].getSimilarityToIntraTypeNeighborCommunity(communityId);
+        MemberIdRange members = _communities[communityId].getNodesRange();
+        for(auto it=members.begin();it!=members.end();++it)
+		similarity += g._graph[*it].getSimilarityToIntraTypeNeighborCommunity(communityId);
+	//Scoring threads only read the communities, so the cache is filled outside parallel regions
+	if(!omp_in_parallel())
+		_communities[communityId].setInternalSimilarity(similarity);
 	return similarity;
 }
 
@@ -100,7 +107,7 @@ double biLouvainMethodMurataPN::murataModularityArgMax(Graph &g,int &communityId
 		}
 	}
 
-	double elm = ((double)1/(2*g._weightEdges)) * calculateEdgesBetweenCommunitiesMap(g,communityId,possibleCoClusterMateId);
+	double elm = ((double)1/(2*g._weightEdges)) * calculateEdgesBetweenCommunitiesMap(communityId,possibleCoClusterMateId);
 	if(_alpha != 1.0)
 		betaFactorCommunity = _communities[communityId].getBetaFactor();
 	murataModularity = ((_alpha*elm)+((1-_alpha)*betaFactorCommunity))-((_alpha*al*am)+((1-_alpha)*(sl*sl)));
@@ -131,7 +138,7 @@ double* biLouvainMethodMurataPN::murataModularityWithChanges(Graph &g,MetaNode &
 			{
 				al = _communities[communityId].getDegreeCommunityWithoutNode(node.getId());
 				am = _communities[possibleCoClusterMateId].getDegreeCommunity();
-				elm = ((double)1/(2*g._weightEdges)) * (calculateEdgesBetweenCommunitiesMap(g,communityId,possibleCoClusterMateId)-node.getWeightEdgesToNeighborCommunity(possibleCoClusterMateId));
+				elm = ((double)1/(2*g._weightEdges)) * (calculateEdgesBetweenCommunitiesMap(communityId,possibleCoClusterMateId)-node.getWeightEdgesToNeighborCommunity(possibleCoClusterMateId));
 			}
 			if(_alpha != 1.0)
 			{
@@ -152,7 +159,7 @@ double* biLouvainMethodMurataPN::murataModularityWithChanges(Graph &g,MetaNode &
 			{	
 				al = _communities[communityId].getDegreeCommunity() + node.getDegreeNode();
 				am = _communities[possibleCoClusterMateId].getDegreeCommunity();
-				elm = ((double)1/(2*g._weightEdges)) * (calculateEdgesBetweenCommunitiesMap(g,communityId,possibleCoClusterMateId)+node.getWeightEdgesToNeighborCommunity(possibleCoClusterMateId));
+				elm = ((double)1/(2*g._weightEdges)) * (calculateEdgesBetweenCommunitiesMap(communityId,possibleCoClusterMateId)+node.getWeightEdgesToNeighborCommunity(possibleCoClusterMateId));
 			}
 			if(_alpha != 1.0)
 			{
@@ -176,17 +183,17 @@ double* biLouvainMethodMurataPN::murataModularityWithChanges(Graph &g,MetaNode &
 				if(possibleCoClusterMateId == nodeCommunity)
 				{
 			    	    am = _communities[possibleCoClusterMateId].getDegreeCommunity() - node.getDegreeNode();
-				    elm = ((double)1/(2*g._weightEdges)) * (calculateEdgesBetweenCommunitiesMap(g,communityId,possibleCoClusterMateId)-node.getWeightEdgesToNeighborCommunity(communityId));
+				    elm = ((double)1/(2*g._weightEdges)) * (calculateEdgesBetweenCommunitiesMap(communityId,possibleCoClusterMateId)-node.getWeightEdgesToNeighborCommunity(communityId));
 				}
 				else if(possibleCoClusterMateId == newCommunityId)
 				{
 				    am = _communities[possibleCoClusterMateId].getDegreeCommunity() + node.getDegreeNode();
-				    elm = ((double)1/(2*g._weightEdges)) * (calculateEdgesBetweenCommunitiesMap(g,communityId,possibleCoClusterMateId)+node.getWeightEdgesToNeighborCommunity(communityId));
+				    elm = ((double)1/(2*g._weightEdges)) * (calculateEdgesBetweenCommunitiesMap(communityId,possibleCoClusterMateId)+node.getWeightEdgesToNeighborCommunity(communityId));
 				}
 				else
 				{
 					am = _communities[possibleCoClusterMateId].getDegreeCommunity();
-					elm = ((double)1/(2*g._weightEdges)) * (calculateEdgesBetweenCommunitiesMap(g,communityId,possibleCoClusterMateId));
+					elm = ((double)1/(2*g._weightEdges)) * (calculateEdgesBetweenCommunitiesMap(communityId,possibleCoClusterMateId));
 				}
 				break;
 			}
@@ -211,6 +218,58 @@ double* biLouvainMethodMurataPN::murataModularityWithChanges(Graph &g,MetaNode &
 }
 
 
+//Upper bound of the gain of the neighbor communities D of candidate Cj if node moves there (option 4). The new contribution
+//of D is its best murataModularityWithChanges over its mates, which is at most the heaviest edge weight from D to a single
+//community minus the smallest degree term, both taken from the cached community-to-community weights and degrees. This
+//avoids building the mates of D from the neighbors of all its members.
+double biLouvainMethodMurataPN::neighborCommunitiesGainBound(Graph &g,MetaNode &node,int candidateCommunityId,const std::vector<int> &neighborCommunities)
+{
+	//Absorbs the rounding of the bound against the exact calculation
+	const double slack = 1e-12;
+	int nodeCommunity = node.getCommunityId();
+	double bound = 0.0;
+	for(unsigned int k=0;k<neighborCommunities.size();k++)
+	{
+		Community &community = _communities[neighborCommunities[k]];
+		double nodeWeight = node.getWeightEdgesToNeighborCommunity(neighborCommunities[k]);
+		double maxElm = 0.0;
+		double minAm = std::numeric_limits<double>::max();
+		NeighborCommunityIdRange mates = community.getNeighborCommunitiesRange();
+		for(auto it=mates.begin();it!=mates.end();++it)
+		{
+			double elm = community.getWeightEdgesToNeighborCommunity(*it);
+			double am = _communities[*it].getDegreeCommunity();
+			if(*it == nodeCommunity)
+			{
+				elm -= nodeWeight;
+				am -= node.getDegreeNode();
+			}
+			else if(*it == candidateCommunityId)
+			{
+				elm += nodeWeight;
+				am += node.getDegreeNode();
+			}
+			maxElm = std::max(maxElm,elm);
+			minAm = std::min(minAm,am);
+		}
+		if(mates.empty())
+			minAm = 0.0;
+		double contribution = _alpha*((((double)1/(2*g._weightEdges)) * maxElm) - ((community.getDegreeCommunity()/(2*g._weightEdgesV1)) * (std::max(minAm,0.0)/(2*g._weightEdgesV2))));
+		if(_alpha != 1.0)
+		{
+			double sl = community.getSimilarity();
+			if(community.getDescription()=="V1")
+				sl = sl/(g._sumSimilarityV1);
+			else
+				sl = sl/(g._sumSimilarityV2);
+			contribution += (1-_alpha)*(community.getBetaFactor()-(sl*sl));
+		}
+		bound += contribution - community.getModularityContribution() + slack;
+	}
+	return bound;
+}
+
+
 newDataCommunityVector biLouvainMethodMurataPN::murataCalculationCoClusterMates(Graph &g,int communityId,const std::vector<int> &possibleCoClusterMates)
 {
 	double murataModularity = 0.0;
@@ -218,6 +277,7 @@ newDataCommunityVector biLouvainMethodMurataPN::murataCalculationCoClusterMates(
 	std::vector<int> coClusterMateCommunityId;
 	newDataCommunityVector result;
 
+	PROFILE_COUNT(_profiler,PROFILE_MURATA_EVALUATIONS,possibleCoClusterMates.size());
 	for(unsigned int j=0;j<possibleCoClusterMates.size();j++)
         {
 	        murataModularity = murataModularityArgMax(g,communityId,possibleCoClusterMates[j]);
@@ -247,27 +307,31 @@ newDataCommunityVector biLouvainMethodMurataPN::murataCalculationCoClusterMates(
 }
 
 
+//Every community only reads the graph and the other communities, so they are processed in parallel. The contribution
+//of each community is kept and they are added up in community order, which gives the same total as a sequential run.
 double biLouvainMethodMurataPN::CoClusterMateDefinitionAllCommunities(Graph &g, int start, int end)
 {
-	std::vector<int> possibleCoClusterMates;
-	std::vector<int> coClusterMateCommunityId;
 	double totalPartitioningModularityCalculated = 0.0;
-	double maxMurataModularity = 0.0;	
-	newDataCommunityVector communityModularity;
+	std::vector<double> modularityContributions(std::max(end-start,0),0.0);
 
+	#pragma omp parallel for schedule(dynamic,64) num_threads(_numberThreads) if(_numberThreads > 1)
 	for(int i=start;i<end;i++)
 	{
+		std::vector<int> possibleCoClusterMates;
+		std::vector<int> coClusterMateCommunityId;
+		double maxMurataModularity = 0.0;
+		newDataCommunityVector communityModularity;
 		if(_communities[i].getNumberNodes()>0)
 		{
 			//Part I: Find the possible cocluster mates
-			possibleCoClusterMates = findNeighborCommunitiesMap(g,_communities[i].getId());
+			possibleCoClusterMates = findNeighborCommunitiesMap(_communities[i].getId());
 			//Part II: Apply Murata+ calculation
 			communityModularity = murataCalculationCoClusterMates(g,_communities[i].getId(),possibleCoClusterMates);
 			coClusterMateCommunityId = communityModularity.coClusterMateCommunityId;
 			maxMurataModularity = communityModularity.newModularityContribution;
 			//printf("\n Comm: %d  Max Mod: %f \n",i,maxMurataModularity);
 			_communities[i].setModularityContribution(maxMurataModularity);
-			totalPartitioningModularityCalculated += maxMurataModularity;
+			modularityContributions[i-start] = maxMurataModularity;
 
 			//Part III: Assign the collection of possible cocluster mates to the community and add the contribution of each community to the total modularity
 			//-2 Empty community
@@ -279,17 +343,16 @@ double biLouvainMethodMurataPN::CoClusterMateDefinitionAllCommunities(Graph &g,
 				coClusterMateCommunityId.push_back(-1);
 				_communities[i].setCoClusterMateCommunityId(coClusterMateCommunityId);
 			}
-			possibleCoClusterMates.clear();
-			coClusterMateCommunityId.clear();
 		}
 		else
 		{
 			coClusterMateCommunityId.push_back(-2);
 			_communities[i].setCoClusterMateCommunityId(coClusterMateCommunityId);
 			_communities[i].setModularityContribution(0.0);
-			coClusterMateCommunityId.clear();
 		}
 	}
+	for(unsigned int i=0;i<modularityContributions.size();i++)
+		totalPartitioningModularityCalculated += modularityContributions[i];
 	return totalPartitioningModularityCalculated;
 }
 
@@ -332,7 +395,7 @@ void biLouvainMethodMurataPN::CoClusterMateDefinitionIDCommunity(Graph &g,int &c
 	if(_communities[communityId].getNumberNodes()>0)
 	{
 		//Part I: Find the possible cocluster mates
-		possibleCoClusterMates = findNeighborCommunitiesMap(g,communityId);
+		possibleCoClusterMates = findNeighborCommunitiesMap(communityId);
 
 		//Part II: Apply Murata+ calculation
 		communityModularity = murataCalculationCoClusterMates(g,communityId,possibleCoClusterMates);
@@ -373,9 +436,8 @@ newDataCommunity biLouvainMethodMurataPN::CoClusterMateDefinitionPrecalculation(
 	double betaF = 0.0;
 	double *resultMurata;
 	int first = 0;
-	std::stringstream changes;
 	newDataCommunity result;
-	struct timeval t1,t2,t3,t4,t5,t6,t7,t8;
+	result.communityId = communityId;
 
 	if(_alpha != 0.0)
 	{
@@ -384,53 +446,49 @@ newDataCommunity biLouvainMethodMurataPN::CoClusterMateDefinitionPrecalculation(
 			//Part I: Find possible cocluster mates
 			if(option==1)// For Ci community
 			{
-				gettimeofday(&t1,NULL);
+				PROFILE_START(precalculationStart);
 				possibleCoClusterMates = findNeighborCommunitiesWithoutNodeMap(g,communityId,node.getId());
-				gettimeofday(&t2,NULL);
-				precalculationCiTime += (t2.tv_sec - t1.tv_sec)*1000000 + (t2.tv_usec - t1.tv_usec);
+				PROFILE_STOP(_profiler,PROFILE_STAGE_PRECALCULATION_CI,precalculationStart);
 			}
 			else if(option==2)// For Cj community
 			{
-				gettimeofday(&t3,NULL);
-				possibleCoClusterMates = findNeighborCommunitiesMap(g,communityId);
-				std::vector<int> temp = node.getNeighborCommunities();
-				possibleCoClusterMates.insert(possibleCoClusterMates.end(),temp.begin(),temp.end());
-				sort(possibleCoClusterMates.begin(),possibleCoClusterMates.end());
-				possibleCoClusterMates.erase(unique(possibleCoClusterMates.begin(),possibleCoClusterMates.end()),possibleCoClusterMates.end());
-				gettimeofday(&t4,NULL);
-				precalculationCjTime += (t4.tv_sec - t3.tv_sec)*1000000 + (t4.tv_usec - t3.tv_usec);
+				PROFILE_START(precalculationStart);
+				std::vector<int> communityNeighbors = findNeighborCommunitiesMap(communityId);
+				CommunityIdRange temp = node.getNeighborCommunitiesRange();	//sorted by community id
+				possibleCoClusterMates.resize(communityNeighbors.size()+temp.size());
+				std::vector<int>::iterator it = set_union(communityNeighbors.begin(),communityNeighbors.end(),temp.begin(),temp.end(),possibleCoClusterMates.begin());
+				possibleCoClusterMates.resize(it-possibleCoClusterMates.begin());
+				PROFILE_STOP(_profiler,PROFILE_STAGE_PRECALCULATION_CJ,precalculationStart);
 			}
 			else if((option==3)||(option==4))// For Di community which is a cocluster of Ci
 			{
-				gettimeofday(&t5,NULL);
-				std::vector<int> temp;
-				for(int i=0;i<_communities[communityId].getNumberNodes();i++)
+				PROFILE_START(precalculationStart);
+				MemberIdRange members = _communities[communityId].getNodesRange();
+				for(auto it=members.begin();it!=members.end();++it)
 				{
-					for(int j=0;j<g._graph[_communities[communityId].getNodes()[i]].getNumberNeighbors();j++)
+					IdRange neighbors = g._graph[*it].getNeighborsRange();
+					for(auto j=neighbors.begin();j!=neighbors.end();++j)
 					{
-						if(g._graph[_communities[communityId].getNodes()[i]].getNeighbors()[j]==node.getId()) communityContainingNodeId = newCommunityId;
-						else communityContainingNodeId = g._graph[g._graph[_communities[communityId].getNodes()[i]].getNeighbors()[j]].getCommunityId();
-						std::vector<int>::iterator position = find(temp.begin(),temp.end(),communityContainingNodeId);
-						if (position == temp.end())
-							temp.push_back(communityContainingNodeId);
+						if(*j==node.getId()) communityContainingNodeId = newCommunityId;
+						else communityContainingNodeId = g._graph[*j].getCommunityId();
+						possibleCoClusterMates.push_back(communityContainingNodeId);
 					}
-					possibleCoClusterMates.insert(possibleCoClusterMates.end(),temp.begin(),temp.end());
-					temp.clear();
 				}
 				sort(possibleCoClusterMates.begin(),possibleCoClusterMates.end());
 				possibleCoClusterMates.erase(unique(possibleCoClusterMates.begin(),possibleCoClusterMates.end()),possibleCoClusterMates.end());
-				gettimeofday(&t6,NULL);
-				precalculationDTime += (t6.tv_sec - t5.tv_sec)*1000000 + (t6.tv_usec - t5.tv_usec);
+				PROFILE_STOP(_profiler,PROFILE_STAGE_PRECALCULATION_D,precalculationStart);
 			}
 
 			//Part II: Apply Murata+ calculation
-			gettimeofday(&t7,NULL);
+			PROFILE_START(murataStart);
+			PROFILE_COUNT(_profiler,PROFILE_MURATA_EVALUATIONS,possibleCoClusterMates.size());
 			for(unsigned int j=0;j<possibleCoClusterMates.size();j++)
         		{
 				first++;
 				resultMurata = murataModularityWithChanges(g,node,communityId,possibleCoClusterMates[j],newCommunityId,option);
 				murataModularity = resultMurata[0];
 				betaF = resultMurata[1];
+				delete[] resultMurata;
 	        	        //printf("Possible cocluster mate ID: %d  Murata Modularity: %f \n",possibleCoClusterMates[j],murataModularity);
         	        	//if(betaF >= lambda)
                                	//{
@@ -462,24 +520,19 @@ newDataCommunity biLouvainMethodMurataPN::CoClusterMateDefinitionPrecalculation(
 			//-1 Nodes inside the community don't have neighbors
 			if(coClusterMateCommunityId.size()==0)
 			{
-				if(_communities[communityId].getNodesWithoutNode(node.getId()).size()>0)
+				if(_communities[communityId].getNumberNodesWithoutNode(node.getId())>0)
 					coClusterMateCommunityId.push_back(-1);
 				else
 					coClusterMateCommunityId.push_back(-2);
 			}
-			gettimeofday(&t8,NULL);
-			premurataTime += (t8.tv_sec - t7.tv_sec)*1000000 + (t8.tv_usec - t7.tv_usec);
+			PROFILE_STOP(_profiler,PROFILE_STAGE_MURATA,murataStart);
 		}
 		else
 		{
 			coClusterMateCommunityId.push_back(-2);
 			betaFactor = 0.0;
 		}
-		changes << communityId << ":";
-                for(unsigned int i=0;i<coClusterMateCommunityId.size();i++)
-                        changes << coClusterMateCommunityId[i] << ",";
-		changes.str(changes.str().substr(0,changes.str().length()-1));
-                result.coClusterMateCommunityId = changes.str();
+                result.coClusterMateCommunityId.swap(coClusterMateCommunityId);
 	}
 	else
 	{
@@ -487,6 +540,7 @@ newDataCommunity biLouvainMethodMurataPN::CoClusterMateDefinitionPrecalculation(
 		resultMurata = murataModularityWithChanges(g,node,communityId,possibleCoClusterMates[0],newCommunityId,option);
                 murataModularity = resultMurata[0];
                 betaF = resultMurata[1];
+                delete[] resultMurata;
 	}
         result.newModularityContribution = maxMurataModularity;
         result.newBetaFactor = betaFactor;
@@ -56,6 +56,7 @@ class biLouvainMethodMurataPN : public biLouvainMethod
 		double IntraTypeDefinitionAllCommunities(Graph &g, int start, int end);
 		void CoClusterMateDefinitionIDCommunity(Graph &g,int &communityId);
 		newDataCommunity CoClusterMateDefinitionPrecalculation(Graph &g,MetaNode &node, int &communityId, int &newCommunityId,int &optio);
+		double neighborCommunitiesGainBound(Graph &g,MetaNode &node,int candidateCommunityId,const std::vector<int> &neighborCommunities);
 
 	public:
 		biLouvainMethodMurataPN();